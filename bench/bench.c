@@ -0,0 +1,235 @@
+// Microbenchmarks for the system call, scheduling, memory and file paths.
+// Booted as init by "make bench"; each result is written to /dev/kmsg as one line:
+//     bench <name> iterations=<n> cycles_per_op=<c>
+// and tools/bench.py collects them from the debug port.
+#include <fcntl.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_PATH "/usr/bin/tonix-bench"
+#define FSBENCH_PATH "/usr/bin/fsbench"
+#define VFSTEST_PATH "/usr/bin/vfstest"
+#define STAT_PATH "/etc/passwd"
+#define PAGE_SIZE 4096
+#define READ_SIZE 4096
+#define READ_TOTAL_SIZE (16 * 1024 * 1024)
+
+// Page frames are never given back to the kernel, so the fork, exec and mmap
+// counts are kept small enough for a 1G machine
+#define GETPID_ITERATIONS 100000
+#define YIELD_ITERATIONS 10000
+#define FORK_ITERATIONS 50
+#define EXEC_ITERATIONS 20
+#define OPEN_ITERATIONS 10000
+#define STAT_ITERATIONS 10000
+#define MMAP_ITERATIONS 64
+#define MMAP_PAGES 16
+#define PAGE_ALLOCATION_ITERATIONS 256
+
+static int kmsg = -1;
+
+static inline uint64_t ReadTimestampCounter()
+{
+    uint32_t low, high;
+    asm volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
+static void Report(const char* name, uint64_t iterations, uint64_t cycles)
+{
+    char line[128];
+    int length = snprintf(line, sizeof(line), "bench %s iterations=%lu cycles_per_op=%lu\n",
+                          name, (unsigned long)iterations, (unsigned long)(cycles / iterations));
+
+    printf("%s", line);
+    if (kmsg >= 0) write(kmsg, line, length);
+}
+
+static void Fail(const char* name)
+{
+    char line[128];
+    int length = snprintf(line, sizeof(line), "bench %s failed\n", name);
+
+    printf("%s", line);
+    if (kmsg >= 0) write(kmsg, line, length);
+}
+
+static void BenchmarkGetPid()
+{
+    uint64_t start = ReadTimestampCounter();
+    for (int i = 0; i < GETPID_ITERATIONS; ++i) getpid();
+    Report("getpid", GETPID_ITERATIONS, ReadTimestampCounter() - start);
+}
+
+// Two tasks yielding to each other, so every yield is one switch
+static void BenchmarkContextSwitch()
+{
+    pid_t child = fork();
+    if (child < 0) return Fail("context_switch");
+
+    if (child == 0)
+    {
+        for (int i = 0; i < YIELD_ITERATIONS; ++i) sched_yield();
+        _exit(0);
+    }
+
+    uint64_t start = ReadTimestampCounter();
+    for (int i = 0; i < YIELD_ITERATIONS; ++i) sched_yield();
+    waitpid(child, NULL, 0);
+    Report("context_switch", 2 * YIELD_ITERATIONS, ReadTimestampCounter() - start);
+}
+
+static void BenchmarkFork()
+{
+    uint64_t start = ReadTimestampCounter();
+    for (int i = 0; i < FORK_ITERATIONS; ++i)
+    {
+        pid_t child = fork();
+        if (child < 0) return Fail("fork_exit_wait");
+        if (child == 0) _exit(0);
+        waitpid(child, NULL, 0);
+    }
+    Report("fork_exit_wait", FORK_ITERATIONS, ReadTimestampCounter() - start);
+}
+
+static void BenchmarkExec()
+{
+    uint64_t start = ReadTimestampCounter();
+    for (int i = 0; i < EXEC_ITERATIONS; ++i)
+    {
+        pid_t child = fork();
+        if (child < 0) return Fail("fork_exec_wait");
+        if (child == 0)
+        {
+            char* const arguments[] = {BENCH_PATH, "--exit", NULL};
+            execv(BENCH_PATH, arguments);
+            _exit(1);
+        }
+        waitpid(child, NULL, 0);
+    }
+    Report("fork_exec_wait", EXEC_ITERATIONS, ReadTimestampCounter() - start);
+}
+
+static void BenchmarkOpen()
+{
+    uint64_t start = ReadTimestampCounter();
+    for (int i = 0; i < OPEN_ITERATIONS; ++i)
+    {
+        int fd = open(STAT_PATH, O_RDONLY);
+        if (fd < 0) return Fail("open_close");
+        close(fd);
+    }
+    Report("open_close", OPEN_ITERATIONS, ReadTimestampCounter() - start);
+}
+
+static void BenchmarkStat()
+{
+    struct stat buffer;
+    uint64_t start = ReadTimestampCounter();
+    for (int i = 0; i < STAT_ITERATIONS; ++i)
+    {
+        if (stat(STAT_PATH, &buffer) < 0) return Fail("stat");
+    }
+    Report("stat", STAT_ITERATIONS, ReadTimestampCounter() - start);
+}
+
+// There are no pipes, so this streams the benchmark binary from the ramdisk instead
+static void BenchmarkRead()
+{
+    static char buffer[READ_SIZE];
+    int fd = open(BENCH_PATH, O_RDONLY);
+    if (fd < 0) return Fail("read_4k");
+
+    uint64_t readCount = 0;
+    uint64_t start = ReadTimestampCounter();
+    for (uint64_t total = 0; total < READ_TOTAL_SIZE; total += READ_SIZE)
+    {
+        if (read(fd, buffer, READ_SIZE) < READ_SIZE) lseek(fd, 0, SEEK_SET);
+        readCount++;
+    }
+    Report("read_4k", readCount, ReadTimestampCounter() - start);
+    close(fd);
+}
+
+// Pages are mapped when mmap is called, so this covers mapping plus the first touch of every page
+static void BenchmarkMmapTouch()
+{
+    uint64_t start = ReadTimestampCounter();
+    for (int i = 0; i < MMAP_ITERATIONS; ++i)
+    {
+        char* pointer = mmap(NULL, MMAP_PAGES * PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pointer == MAP_FAILED) return Fail("mmap_touch_page");
+        for (int page = 0; page < MMAP_PAGES; ++page) pointer[page * PAGE_SIZE] = 1;
+    }
+    Report("mmap_touch_page", MMAP_ITERATIONS * MMAP_PAGES, ReadTimestampCounter() - start);
+}
+
+static void BenchmarkPageAllocation()
+{
+    uint64_t start = ReadTimestampCounter();
+    for (int i = 0; i < PAGE_ALLOCATION_ITERATIONS; ++i)
+    {
+        void* pointer = mmap(NULL, PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pointer == MAP_FAILED) return Fail("page_allocation");
+    }
+    Report("page_allocation", PAGE_ALLOCATION_ITERATIONS, ReadTimestampCounter() - start);
+}
+
+int main(int argc, char** argv)
+{
+    // Target of the exec benchmark
+    if (argc > 1 && strcmp(argv[1], "--exit") == 0) return 0;
+
+    kmsg = open("/dev/kmsg", O_WRONLY);
+
+    // The regression tests write their own results to /dev/kmsg
+    pid_t vfstest = fork();
+    if (vfstest == 0)
+    {
+        char* const arguments[] = {VFSTEST_PATH, NULL};
+        execv(VFSTEST_PATH, arguments);
+        _exit(1);
+    }
+    if (vfstest > 0) waitpid(vfstest, NULL, 0);
+
+    // Everything that forks runs before the mmap benchmarks grow the address space that gets copied
+    BenchmarkGetPid();
+    BenchmarkContextSwitch();
+    BenchmarkFork();
+    BenchmarkExec();
+    BenchmarkOpen();
+    BenchmarkStat();
+    BenchmarkRead();
+    BenchmarkMmapTouch();
+    BenchmarkPageAllocation();
+
+    // The file system benchmarks write their own results to /dev/kmsg
+    pid_t fsbench = fork();
+    if (fsbench == 0)
+    {
+        char* const arguments[] = {FSBENCH_PATH, "--kmsg", NULL};
+        execv(FSBENCH_PATH, arguments);
+        _exit(1);
+    }
+    if (fsbench > 0) waitpid(fsbench, NULL, 0);
+
+    // Kernels built with PGO=generate dump their arc counters to the debug port, for "make pgo"
+    int gcov = open("/dev/gcov", O_WRONLY);
+    if (gcov >= 0)
+    {
+        write(gcov, "1", 1);
+        close(gcov);
+    }
+
+    const char* done = "bench done\n";
+    printf("%s", done);
+    if (kmsg >= 0) write(kmsg, done, strlen(done));
+
+    return 0;
+}
@@ -0,0 +1,270 @@
+// File system benchmarks: sequential and random I/O at several block sizes, metadata operations and path
+// lookup by depth, all through the ordinary file system calls. Results use the same line format as bench.c,
+//     bench fs_<name> iterations=<n> cycles_per_op=<c> [bytes_per_op=<b>]
+// so tools/bench.py compares them against a baseline. Throughput is bytes_per_op over the time per op.
+//
+// Usage: fsbench [--kmsg] [directory]
+// Everything is created in a new directory under the given one (/root by default). --kmsg also writes
+// the results to /dev/kmsg, where make bench collects them.
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FILE_SIZE (4 * 1024 * 1024)
+#define RANDOM_OPERATIONS 1024
+#define METADATA_FILES 256
+#define READDIR_ITERATIONS 20
+#define LOOKUP_MAX_DEPTH 8
+#define LOOKUP_ITERATIONS 1000
+#define PATH_SIZE 512
+
+static const int blockSizes[] = {512, 4096, 65536};
+static char buffer[65536];
+static int kmsg = -1;
+
+static inline uint64_t ReadTimestampCounter()
+{
+    uint32_t low, high;
+    asm volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
+// xorshift64, seeded the same way on every run so that runs are comparable
+static uint64_t randomState = 0x2545f4914f6cdd1d;
+static uint64_t Random()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+    return randomState;
+}
+
+static void Output(const char* line, int length)
+{
+    printf("%s", line);
+    if (kmsg >= 0) write(kmsg, line, length);
+}
+
+static void Report(const char* name, int blockSize, uint64_t iterations, uint64_t cycles)
+{
+    char line[160];
+    int length;
+    if (blockSize > 0)
+    {
+        length = snprintf(line, sizeof(line), "bench fs_%s_%d iterations=%lu cycles_per_op=%lu bytes_per_op=%d\n",
+                          name, blockSize, (unsigned long)iterations, (unsigned long)(cycles / iterations), blockSize);
+    }
+    else
+    {
+        length = snprintf(line, sizeof(line), "bench fs_%s iterations=%lu cycles_per_op=%lu\n",
+                          name, (unsigned long)iterations, (unsigned long)(cycles / iterations));
+    }
+    Output(line, length);
+}
+
+static void Fail(const char* name, const char* reason)
+{
+    char line[160];
+    int length = snprintf(line, sizeof(line), "bench fs_%s failed: %s\n", name, reason);
+    Output(line, length);
+}
+
+static int SequentialWrite(const char* path, int blockSize)
+{
+    int fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (fd < 0) return -1;
+
+    uint64_t start = ReadTimestampCounter();
+    for (int offset = 0; offset < FILE_SIZE; offset += blockSize)
+    {
+        if (write(fd, buffer, blockSize) != blockSize)
+        {
+            close(fd);
+            return -1;
+        }
+    }
+    Report("seq_write", blockSize, FILE_SIZE / blockSize, ReadTimestampCounter() - start);
+
+    return close(fd);
+}
+
+static int SequentialRead(const char* path, int blockSize)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    uint64_t start = ReadTimestampCounter();
+    for (int offset = 0; offset < FILE_SIZE; offset += blockSize)
+    {
+        if (read(fd, buffer, blockSize) != blockSize)
+        {
+            close(fd);
+            return -1;
+        }
+    }
+    Report("seq_read", blockSize, FILE_SIZE / blockSize, ReadTimestampCounter() - start);
+
+    return close(fd);
+}
+
+// Block aligned offsets anywhere in the file
+static int RandomIO(const char* path, int blockSize, int writing)
+{
+    int fd = open(path, O_RDWR);
+    if (fd < 0) return -1;
+
+    uint64_t blockCount = FILE_SIZE / blockSize;
+    uint64_t start = ReadTimestampCounter();
+    for (int i = 0; i < RANDOM_OPERATIONS; ++i)
+    {
+        off_t offset = (off_t)(Random() % blockCount) * blockSize;
+        ssize_t count = -1;
+        if (lseek(fd, offset, SEEK_SET) == offset)
+        {
+            count = writing ? write(fd, buffer, blockSize) : read(fd, buffer, blockSize);
+        }
+
+        if (count != blockSize)
+        {
+            close(fd);
+            return -1;
+        }
+    }
+    Report(writing ? "rand_write" : "rand_read", blockSize, RANDOM_OPERATIONS, ReadTimestampCounter() - start);
+
+    return close(fd);
+}
+
+static void BenchmarkThroughput(const char* directory)
+{
+    char path[PATH_SIZE];
+    for (size_t i = 0; i < sizeof(blockSizes) / sizeof(blockSizes[0]); ++i)
+    {
+        int blockSize = blockSizes[i];
+        snprintf(path, sizeof(path), "%s/data-%d", directory, blockSize);
+
+        if (SequentialWrite(path, blockSize) < 0) return Fail("seq_write", strerror(errno));
+        if (SequentialRead(path, blockSize) < 0) return Fail("seq_read", strerror(errno));
+        if (RandomIO(path, blockSize, 0) < 0) return Fail("rand_read", strerror(errno));
+        if (RandomIO(path, blockSize, 1) < 0) return Fail("rand_write", strerror(errno));
+    }
+}
+
+static void BenchmarkMetadata(const char* directory)
+{
+    char path[PATH_SIZE];
+    snprintf(path, sizeof(path), "%s/metadata", directory);
+    if (mkdir(path, 0755) < 0) return Fail("create", strerror(errno));
+
+    uint64_t start = ReadTimestampCounter();
+    for (int i = 0; i < METADATA_FILES; ++i)
+    {
+        snprintf(path, sizeof(path), "%s/metadata/file-%d", directory, i);
+        int fd = open(path, O_CREAT | O_EXCL | O_WRONLY, 0644);
+        if (fd < 0) return Fail("create", strerror(errno));
+        close(fd);
+    }
+    Report("create", 0, METADATA_FILES, ReadTimestampCounter() - start);
+
+    struct stat statBuffer;
+    start = ReadTimestampCounter();
+    for (int i = 0; i < METADATA_FILES; ++i)
+    {
+        snprintf(path, sizeof(path), "%s/metadata/file-%d", directory, i);
+        if (stat(path, &statBuffer) < 0) return Fail("stat", strerror(errno));
+    }
+    Report("stat", 0, METADATA_FILES, ReadTimestampCounter() - start);
+
+    // One op is one directory entry
+    snprintf(path, sizeof(path), "%s/metadata", directory);
+    uint64_t entryCount = 0;
+    start = ReadTimestampCounter();
+    for (int i = 0; i < READDIR_ITERATIONS; ++i)
+    {
+        DIR* directoryStream = opendir(path);
+        if (directoryStream == NULL) return Fail("readdir", strerror(errno));
+        while (readdir(directoryStream) != NULL) entryCount++;
+        closedir(directoryStream);
+    }
+    Report("readdir", 0, entryCount, ReadTimestampCounter() - start);
+
+    // The kernel has no unlink yet, this starts measuring once it does
+    snprintf(path, sizeof(path), "%s/metadata/file-0", directory);
+    if (unlink(path) < 0)
+    {
+        if (errno != ENOSYS) return Fail("unlink", strerror(errno));
+
+        const char* skipped = "bench fs_unlink skipped: not supported\n";
+        return Output(skipped, strlen(skipped));
+    }
+
+    start = ReadTimestampCounter();
+    for (int i = 1; i < METADATA_FILES; ++i)
+    {
+        snprintf(path, sizeof(path), "%s/metadata/file-%d", directory, i);
+        if (unlink(path) < 0) return Fail("unlink", strerror(errno));
+    }
+    Report("unlink", 0, METADATA_FILES - 1, ReadTimestampCounter() - start);
+}
+
+// Stats a file at each depth of a chain of nested directories, depth counts from the benchmark directory
+static void BenchmarkLookup(const char* directory)
+{
+    char path[PATH_SIZE];
+    char filePath[PATH_SIZE];
+    snprintf(path, sizeof(path), "%s", directory);
+
+    for (int depth = 1; depth <= LOOKUP_MAX_DEPTH; ++depth)
+    {
+        size_t length = strlen(path);
+        snprintf(path + length, sizeof(path) - length, "/d");
+        if (mkdir(path, 0755) < 0) return Fail("lookup", strerror(errno));
+
+        snprintf(filePath, sizeof(filePath), "%s/file", path);
+        int fd = open(filePath, O_CREAT | O_WRONLY, 0644);
+        if (fd < 0) return Fail("lookup", strerror(errno));
+        close(fd);
+
+        struct stat statBuffer;
+        uint64_t start = ReadTimestampCounter();
+        for (int i = 0; i < LOOKUP_ITERATIONS; ++i)
+        {
+            if (stat(filePath, &statBuffer) < 0) return Fail("lookup", strerror(errno));
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "lookup_depth_%d", depth);
+        Report(name, 0, LOOKUP_ITERATIONS, ReadTimestampCounter() - start);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* base = "/root";
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--kmsg") == 0) kmsg = open("/dev/kmsg", O_WRONLY);
+        else base = argv[i];
+    }
+
+    // Files can't be removed yet, so every run gets a directory of its own. Leave room for the paths in it.
+    char directory[PATH_SIZE / 2];
+    snprintf(directory, sizeof(directory), "%s/fsbench-%d", base, (int)getpid());
+    if (mkdir(directory, 0755) < 0)
+    {
+        Fail("setup", strerror(errno));
+        return 1;
+    }
+
+    memset(buffer, 0xa5, sizeof(buffer));
+
+    BenchmarkThroughput(directory);
+    BenchmarkMetadata(directory);
+    BenchmarkLookup(directory);
+    return 0;
+}
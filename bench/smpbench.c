@@ -0,0 +1,192 @@
+// SMP scalability workloads, booted as init by "make smp-bench" once for every core count.
+// For each workload, one worker per core runs the same fixed amount of work and writes
+//     smp <workload> start=<tsc> end=<tsc> ops=<n>
+// to /dev/kmsg, tools/smpbench.py turns the span from the first start to the last end into throughput.
+// Kernels built with -DLOCK_STATISTICS also get the lock classes that the workload spun on:
+//     smp lockstat <workload> <class> acquisitions=<n> contentions=<n> spin=<cycles>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define SMPBENCH_PATH "/usr/bin/smpbench"
+#define PAGE_SIZE 4096
+#define READ_SIZE 4096
+#define LINE_SIZE 160
+
+// Page frames are never given back to the kernel, so the fork and fault counts stay small
+#define CPU_OPERATIONS 50000000
+#define SYSCALL_OPERATIONS 200000
+#define FORK_OPERATIONS 16
+#define READ_OPERATIONS 20000
+#define FAULT_OPERATIONS 256
+
+static int kmsg = -1;
+
+static inline uint64_t ReadTimestampCounter()
+{
+    uint32_t low, high;
+    asm volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
+static void Output(const char* line, int length)
+{
+    printf("%s", line);
+    if (kmsg >= 0) write(kmsg, line, length);
+}
+
+static void RunCpu()
+{
+    volatile uint64_t value = 0;
+    for (uint64_t i = 0; i < CPU_OPERATIONS; ++i) value = value * 31 + i;
+}
+
+static void RunSyscall()
+{
+    for (int i = 0; i < SYSCALL_OPERATIONS; ++i) getppid();
+}
+
+static void RunFork()
+{
+    for (int i = 0; i < FORK_OPERATIONS; ++i)
+    {
+        pid_t child = fork();
+        if (child == 0) _exit(0);
+        if (child > 0) waitpid(child, NULL, 0);
+    }
+}
+
+// Every worker streams the benchmark binary through its own descriptor
+static void RunRead()
+{
+    static char buffer[READ_SIZE];
+    int fd = open(SMPBENCH_PATH, O_RDONLY);
+    if (fd < 0) return;
+
+    for (int i = 0; i < READ_OPERATIONS; ++i)
+    {
+        if (read(fd, buffer, READ_SIZE) < READ_SIZE) lseek(fd, 0, SEEK_SET);
+    }
+    close(fd);
+}
+
+// mmap maps pages up front, so this is mapping plus the first touch rather than a demand fault
+static void RunFault()
+{
+    for (int i = 0; i < FAULT_OPERATIONS; ++i)
+    {
+        char* page = mmap(NULL, PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (page == MAP_FAILED) return;
+        page[0] = 1;
+    }
+}
+
+struct Workload
+{
+    const char* name;
+    void (*run)();
+    uint64_t operations;
+};
+
+static const struct Workload workloads[] = {
+    {"cpu", RunCpu, CPU_OPERATIONS},
+    {"syscall", RunSyscall, SYSCALL_OPERATIONS},
+    {"fork", RunFork, FORK_OPERATIONS},
+    {"read", RunRead, READ_OPERATIONS},
+    {"fault", RunFault, FAULT_OPERATIONS},
+};
+
+// One "cpuN" line per core in /proc/stat
+static int CountCores()
+{
+    FILE* stat = fopen("/proc/stat", "r");
+    if (stat == NULL) return 1;
+
+    int coreCount = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), stat) != NULL)
+    {
+        if (strncmp(line, "cpu", 3) == 0 && line[3] >= '0' && line[3] <= '9') coreCount++;
+    }
+    fclose(stat);
+
+    return coreCount > 0 ? coreCount : 1;
+}
+
+// Forwards the lock classes with contention, the report is empty unless the kernel collects lock statistics
+static void ReportLocks(const char* workload)
+{
+    FILE* lockstat = fopen("/dev/lockstat", "r");
+    if (lockstat == NULL) return;
+
+    char line[256];
+    while (fgets(line, sizeof(line), lockstat) != NULL)
+    {
+        char lockClass[32];
+        unsigned long acquisitions, contentions, spin;
+        if (sscanf(line, "%31s %lu %lu %lu", lockClass, &acquisitions, &contentions, &spin) != 4) continue;
+        if (contentions == 0) continue;
+
+        char output[LINE_SIZE];
+        int length = snprintf(output, sizeof(output), "smp lockstat %s %s acquisitions=%lu contentions=%lu spin=%lu\n",
+                              workload, lockClass, acquisitions, contentions, spin);
+        Output(output, length);
+    }
+    fclose(lockstat);
+}
+
+static void ClearLocks()
+{
+    int fd = open("/dev/lockstat", O_WRONLY);
+    if (fd < 0) return;
+    write(fd, "0", 1);
+    close(fd);
+}
+
+static void RunWorkload(const struct Workload* workload, int workerCount)
+{
+    ClearLocks();
+
+    for (int worker = 0; worker < workerCount; ++worker)
+    {
+        if (fork() != 0) continue;
+
+        uint64_t start = ReadTimestampCounter();
+        workload->run();
+        uint64_t end = ReadTimestampCounter();
+
+        char line[LINE_SIZE];
+        int length = snprintf(line, sizeof(line), "smp %s start=%lu end=%lu ops=%lu\n", workload->name,
+                              (unsigned long)start, (unsigned long)end, (unsigned long)workload->operations);
+        Output(line, length);
+        _exit(0);
+    }
+
+    while (wait(NULL) > 0) { }
+
+    ReportLocks(workload->name);
+}
+
+// Usage: smpbench [worker count], one worker per core by default
+int main(int argc, char** argv)
+{
+    kmsg = open("/dev/kmsg", O_WRONLY);
+
+    int workerCount = argc > 1 ? atoi(argv[1]) : CountCores();
+    if (workerCount < 1) workerCount = 1;
+
+    char line[LINE_SIZE];
+    int length = snprintf(line, sizeof(line), "smp workers=%d\n", workerCount);
+    Output(line, length);
+
+    for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); ++i) RunWorkload(&workloads[i], workerCount);
+
+    const char* done = "smp done\n";
+    Output(done, strlen(done));
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Regression tests for the VFS paths that only a booted kernel has, run by tonix-bench before its results.
+// Every test writes "test <name> passed" or "test <name> failed: <reason>" to /dev/kmsg,
+// tools/bench.py fails the run on the second.
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LINE_SIZE 160
+
+static const char* generatedFiles[] = {"/dev/lockstat", "/dev/allocstat", "/proc/stat", "/proc/self/status"};
+static const char* streamDevices[] = {"/dev/kbd", "/dev/kmsg", "/dev/trace", "/dev/systrace", "/dev/profile"};
+
+static int kmsg = -1;
+static int failureCount = 0;
+
+static void Output(const char* line, int length)
+{
+    printf("%s", line);
+    if (kmsg >= 0) write(kmsg, line, length);
+}
+
+static void Pass(const char* name, const char* path)
+{
+    char line[LINE_SIZE];
+    int length = snprintf(line, sizeof(line), "test %s %s passed\n", name, path);
+    Output(line, length);
+}
+
+static void Fail(const char* name, const char* path, const char* reason)
+{
+    char line[LINE_SIZE];
+    int length = snprintf(line, sizeof(line), "test %s %s failed: %s\n", name, path, reason);
+    Output(line, length);
+    failureCount++;
+}
+
+// Generated files have no size, so writing after a read or a seek must not try to fill the file up to the offset
+static void TestReadThenWrite(const char* path)
+{
+    char buffer[64];
+    int fd = open(path, O_RDWR);
+    if (fd < 0) return Fail("read_then_write", path, strerror(errno));
+
+    if (read(fd, buffer, sizeof(buffer)) <= 0) Fail("read_then_write", path, "nothing to read");
+    else if (write(fd, "0", 1) != 1) Fail("read_then_write", path, "write after read");
+    else if (lseek(fd, 4096, SEEK_SET) != 4096) Fail("read_then_write", path, "seek");
+    else if (write(fd, "0", 1) != 1) Fail("read_then_write", path, "write after seek");
+    else if (lseek(fd, 0, SEEK_SET) != 0 || read(fd, buffer, sizeof(buffer)) <= 0) Fail("read_then_write", path,
+                                                                                        "read after write");
+    else Pass("read_then_write", path);
+
+    close(fd);
+}
+
+static void TestStat(const char* path)
+{
+    struct stat statBuffer;
+    if (stat(path, &statBuffer) < 0) return Fail("stat", path, strerror(errno));
+    if (!S_ISREG(statBuffer.st_mode)) return Fail("stat", path, "not a regular file");
+    Pass("stat", path);
+}
+
+// The offset of a stream device is the reader's place in the stream, seeking it would leave reads stuck
+static void TestSeekStream(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return Fail("seek_stream", path, strerror(errno));
+
+    if (lseek(fd, 1 << 20, SEEK_SET) != -1) Fail("seek_stream", path, "seek succeeded");
+    else if (errno != ESPIPE) Fail("seek_stream", path, strerror(errno));
+    else Pass("seek_stream", path);
+
+    close(fd);
+}
+
+int main()
+{
+    kmsg = open("/dev/kmsg", O_WRONLY);
+
+    for (size_t i = 0; i < sizeof(generatedFiles) / sizeof(generatedFiles[0]); ++i)
+    {
+        TestReadThenWrite(generatedFiles[i]);
+        TestStat(generatedFiles[i]);
+    }
+
+    for (size_t i = 0; i < sizeof(streamDevices) / sizeof(streamDevices[0]); ++i)
+    {
+        TestSeekStream(streamDevices[i]);
+    }
+
+    return failureCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "Benchmark.h"
+
+// Registrations run before main, so they are linked into a list instead of allocating
+Benchmark* Benchmark::first = nullptr;
+
+constexpr uint64_t NANOSECONDS_PER_SECOND = 1000000000;
+constexpr uint64_t MINIMUM_RUN_TIME = NANOSECONDS_PER_SECOND / 2;
+constexpr uint64_t MAXIMUM_ITERATIONS = 1000000000;
+
+Benchmark::Benchmark(const char* name, BenchmarkFunction function) : name(name), function(function), next(nullptr)
+{
+    // Appended, so that benchmarks run in the order they are defined in
+    Benchmark** last = &first;
+    while (*last != nullptr) last = &(*last)->next;
+    *last = this;
+}
+
+uint64_t Benchmark::Time(BenchmarkFunction function, uint64_t iterations)
+{
+    timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    function(iterations);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start.tv_sec) * NANOSECONDS_PER_SECOND + end.tv_nsec - start.tv_nsec;
+}
+
+void Benchmark::RunAll(const char* filter, const char* excludedPrefix)
+{
+    printf("%-32s %14s %14s\n", "Benchmark", "Time", "Iterations");
+
+    for (Benchmark* benchmark = first; benchmark != nullptr; benchmark = benchmark->next)
+    {
+        if (filter != nullptr && strstr(benchmark->name, filter) == nullptr) continue;
+        if (excludedPrefix != nullptr && strncmp(benchmark->name, excludedPrefix, strlen(excludedPrefix)) == 0) continue;
+
+        // Grow the iteration count tenfold until a run takes a tenth of the minimum,
+        // then scale it to the minimum for the measured run
+        uint64_t iterations = 1;
+        uint64_t elapsed = Time(benchmark->function, iterations);
+        while (elapsed < MINIMUM_RUN_TIME / 10 && iterations < MAXIMUM_ITERATIONS)
+        {
+            iterations *= 10;
+            elapsed = Time(benchmark->function, iterations);
+        }
+
+        if (elapsed < MINIMUM_RUN_TIME)
+        {
+            uint64_t scaledIterations = iterations * MINIMUM_RUN_TIME / (elapsed > 0 ? elapsed : 1);
+            iterations = scaledIterations < MAXIMUM_ITERATIONS ? scaledIterations : MAXIMUM_ITERATIONS;
+            elapsed = Time(benchmark->function, iterations);
+        }
+
+        printf("%-32s %11.1f ns %14lu\n", benchmark->name, static_cast<double>(elapsed) / iterations, iterations);
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+// A small stand-in for Google Benchmark. A benchmark runs its body "iterations" times, and the runner keeps
+// growing the count until a run is long enough to time, then reports the time per iteration.
+typedef void (*BenchmarkFunction)(uint64_t iterations);
+
+class Benchmark
+{
+public:
+    // Runs every benchmark whose name contains filter (all of them if it is null),
+    // except those whose name starts with excludedPrefix
+    static void RunAll(const char* filter, const char* excludedPrefix);
+    Benchmark(const char* name, BenchmarkFunction function);
+
+private:
+    static uint64_t Time(BenchmarkFunction function, uint64_t iterations);
+
+    const char* name;
+    BenchmarkFunction function;
+    Benchmark* next;
+    static Benchmark* first;
+};
+
+// Keeps the compiler from optimizing away a value that is never used
+template <typename T>
+inline void KeepValue(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#define BENCHMARK(benchmarkName) \
+    static void benchmarkName(uint64_t iterations); \
+    static Benchmark benchmarkName##Registration(#benchmarkName, benchmarkName); \
+    static void benchmarkName(uint64_t iterations)
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include "Benchmark.h"
+#include "FileDisk.h"
+#include "Vector.h"
+#include "String.h"
+#include "Bitmap.h"
+#include "Ext2.h"
+#include "Heap.h"
+
+// The slabs only hold 5 pages each, so no benchmark may keep more than a few kilobytes allocated,
+// and every iteration has to free what it allocates
+constexpr uint64_t VECTOR_LENGTH = 256;
+constexpr uint64_t BITMAP_SIZE = 0x1000;
+constexpr uint64_t SLAB_BATCH_SIZE = 64;
+constexpr uint64_t FILE_READ_SIZE = 0x1000;
+
+const char* EXT2_DIRECTORY_NAME = "etc";
+const char* EXT2_FILE_NAME = "passwd";
+const char* EXT2_LARGE_FILE_PATH[] = {"fonts", "Uni2-Terminus20x10.psf"};
+
+Ext2* ext2 = nullptr;
+
+BENCHMARK(VectorPush)
+{
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        Vector<uint64_t> vector;
+        for (uint64_t j = 0; j < VECTOR_LENGTH; ++j) vector.Push(j);
+        KeepValue(vector.GetLast());
+    }
+}
+
+BENCHMARK(VectorCopy)
+{
+    Vector<uint64_t> original;
+    for (uint64_t j = 0; j < VECTOR_LENGTH; ++j) original.Push(j);
+
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        Vector<uint64_t> copy(original);
+        KeepValue(copy.GetLast());
+    }
+}
+
+BENCHMARK(VectorPopFront)
+{
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        Vector<uint64_t> vector;
+        for (uint64_t j = 0; j < VECTOR_LENGTH; ++j) vector.Push(j);
+        while (!vector.IsEmpty()) KeepValue(vector.Pop(0));
+    }
+}
+
+BENCHMARK(StringSplit)
+{
+    String path("/usr/share/terminfo/l/linux");
+    uint64_t componentCount = path.Count('/') + 1;
+
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        for (uint64_t j = 0; j < componentCount; ++j)
+        {
+            String component = path.Split('/', j);
+            KeepValue(component.GetLength());
+        }
+    }
+}
+
+BENCHMARK(StringEquals)
+{
+    String a("/usr/share/terminfo/l/linux");
+    String b("/usr/share/terminfo/l/linux");
+
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        KeepValue(a.Equals(b));
+    }
+}
+
+BENCHMARK(StringCopy)
+{
+    String original("/usr/share/terminfo/l/linux");
+
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        String copy(original);
+        KeepValue(copy.GetLength());
+    }
+}
+
+BENCHMARK(BitmapSetAndGet)
+{
+    auto buffer = new uint8_t[BITMAP_SIZE];
+    Bitmap bitmap(buffer, BITMAP_SIZE, false);
+
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        for (uint64_t bit = 0; bit < bitmap.TotalNumberOfBits(); ++bit) bitmap.SetBit(bit, bit % 3 == 0);
+        for (uint64_t bit = 0; bit < bitmap.TotalNumberOfBits(); ++bit) KeepValue(bitmap.GetBit(bit));
+    }
+
+    delete[] buffer;
+}
+
+BENCHMARK(SlabAllocateFree)
+{
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        void* pointer = operator new(64);
+        KeepValue(pointer);
+        operator delete(pointer);
+    }
+}
+
+BENCHMARK(SlabAllocateFreeBatch)
+{
+    void* pointers[SLAB_BATCH_SIZE];
+
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        for (auto& pointer : pointers) pointer = operator new(32);
+        KeepValue(pointers);
+        for (auto pointer : pointers) operator delete(pointer);
+    }
+}
+
+BENCHMARK(Ext2FindInDirectory)
+{
+    String directoryName(EXT2_DIRECTORY_NAME);
+    String fileName(EXT2_FILE_NAME);
+
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        VFS::Vnode* directory = ext2->FindInDirectory(ext2->fileSystemRoot, directoryName);
+        Assert(directory != nullptr);
+        KeepValue(ext2->FindInDirectory(directory, fileName));
+    }
+}
+
+BENCHMARK(Ext2ReadDirectory)
+{
+    VFS::Vnode* root = ext2->fileSystemRoot;
+
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        for (uint64_t position = 0; position < root->fileSize; )
+        {
+            VFS::DirectoryEntry entry = ext2->ReadDirectory(root, position);
+            KeepValue(entry.inodeNum);
+            position += entry.entrySize;
+        }
+    }
+}
+
+BENCHMARK(Ext2ReadFile)
+{
+    VFS::Vnode* file = ext2->fileSystemRoot;
+    for (auto name : EXT2_LARGE_FILE_PATH)
+    {
+        file = ext2->FindInDirectory(file, String(name));
+        Assert(file != nullptr);
+    }
+
+    auto buffer = new uint8_t[FILE_READ_SIZE];
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        for (uint64_t position = 0; position < file->fileSize; position += FILE_READ_SIZE)
+        {
+            KeepValue(ext2->Read(file, buffer, FILE_READ_SIZE, position));
+        }
+    }
+
+    delete[] buffer;
+}
+
+// Usage: kernel-bench [--ext2 image] [filter]
+// The Ext2 benchmarks need an image built from root-directory/, "make host-bench" creates one.
+int main(int argc, char** argv)
+{
+    InitializeKernelHeap();
+
+    const char* filter = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (String(argv[i]).Equals("--ext2") && i + 1 < argc) ext2 = new Ext2(new FileDisk(argv[++i]));
+        else filter = argv[i];
+    }
+
+    if (ext2 == nullptr) fprintf(stderr, "No ext2 image given, skipping the Ext2 benchmarks\n");
+
+    Benchmark::RunAll(filter, ext2 == nullptr ? "Ext2" : nullptr);
+    return 0;
+}
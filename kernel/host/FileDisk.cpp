@@ -0,0 +1,25 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include "FileDisk.h"
+#include "Assert.h"
+
+FileDisk::FileDisk(const char* path)
+{
+    fd = open(path, O_RDWR);
+    Assert(fd >= 0);
+}
+
+FileDisk::~FileDisk()
+{
+    close(fd);
+}
+
+void FileDisk::Read(uint64_t addr, void* buffer, uint64_t count)
+{
+    Assert(pread(fd, buffer, count, addr) == static_cast<ssize_t>(count));
+}
+
+void FileDisk::Write(uint64_t addr, const void* buffer, uint64_t count)
+{
+    Assert(pwrite(fd, buffer, count, addr) == static_cast<ssize_t>(count));
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Disk.h"
+
+// A disk backed by a file on the host, such as an ext2 image
+class FileDisk : public Disk
+{
+public:
+    void Read(uint64_t addr, void* buffer, uint64_t count) override;
+    void Write(uint64_t addr, const void* buffer, uint64_t count) override;
+    explicit FileDisk(const char* path);
+    ~FileDisk() override;
+private:
+    int fd;
+};
@@ -0,0 +1,107 @@
+// Stand-ins for the kernel code that the host build does not compile: the debug port, interrupts,
+// physical memory and the VFS vnode cache. Nothing here may include <string.h>, whose memcpy and memset
+// would clash with the kernel's own declarations in Memory/Memory.h.
+#include <stdio.h>
+#include <stdlib.h>
+#include "Assert.h"
+#include "Serial.h"
+#include "Spinlock.h"
+#include "VFS.h"
+#include "Heap.h"
+#include "Memory/Memory.h"
+#include "Memory/PageFrameAllocator.h"
+
+[[noreturn]] void KernelPanic(const char* assertion, const char* file, unsigned int line, const char* function)
+{
+    fprintf(stderr, "! KERNEL PANIC !\n%s\n%s: line: %u\nFunction: %s\n", assertion, file, line, function);
+    abort();
+}
+
+void KernelWarn(const char* message, const char* file, unsigned int line)
+{
+    fprintf(stderr, "[WARNING] %s:%u -> %s\n", file, line, message);
+}
+
+// Log messages would only add noise to the benchmark output
+void Serial::Log(const char* format, ...)
+{
+    (void)format;
+}
+
+// The host build is single threaded
+void Spinlock::Acquire() { }
+void Spinlock::Release() { }
+
+// Page frames come from the host heap and are identity mapped
+uintptr_t RequestPageFrames(uint64_t count, uintptr_t caller)
+{
+    void* pageFrames = aligned_alloc(0x1000, count * 0x1000);
+    Assert(pageFrames != nullptr);
+
+    (void)caller;
+    return reinterpret_cast<uintptr_t>(pageFrames);
+}
+
+uintptr_t RequestPageFrames(uint64_t count)
+{
+    return RequestPageFrames(count, 0);
+}
+
+uintptr_t RequestPageFrame()
+{
+    return RequestPageFrames(1, 0);
+}
+
+uintptr_t HigherHalf(uintptr_t physAddr)
+{
+    return physAddr;
+}
+
+uintptr_t LowerHalf(uintptr_t virtAddr)
+{
+    return virtAddr;
+}
+
+void* memset(void* ptr, uint8_t value, uint64_t num)
+{
+    return __builtin_memset(ptr, value, num);
+}
+
+void* memcpy(void* destination, const void* source, uint64_t num)
+{
+    return __builtin_memcpy(destination, source, num);
+}
+
+// The same singly linked cache as the kernel's, without the mount points
+VFS::Vnode* firstInCache = nullptr;
+VFS::Vnode* currentInCache = nullptr;
+
+void VFS::CacheVNode(VFS::Vnode* vnode)
+{
+    if (firstInCache == nullptr) firstInCache = vnode;
+    else currentInCache->nextInCache = vnode;
+    currentInCache = vnode;
+}
+
+VFS::Vnode* VFS::SearchInCache(uint32_t inodeNum, FileSystem* fileSystem)
+{
+    for (VFS::Vnode* current = firstInCache; current != nullptr; current = current->nextInCache)
+    {
+        if (current->inodeNum == inodeNum && current->fileSystem == fileSystem) return current;
+    }
+
+    return nullptr;
+}
+
+VFS::Vnode* VFS::ConstructVnode(uint32_t inodeNum, FileSystem* fileSystem, void* context, uint64_t fileSize, VnodeType type)
+{
+    auto vnode = new (Allocator::Permanent) VFS::Vnode();
+    vnode->inodeNum = inodeNum;
+    vnode->fileSystem = fileSystem;
+    vnode->context = context;
+    vnode->fileSize = fileSize;
+    vnode->type = type;
+    VFS::CacheVNode(vnode);
+
+    return vnode;
+}
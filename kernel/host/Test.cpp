@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <string.h>
+#include "Test.h"
+
+// Registrations run before main, so they are linked into a list instead of allocating
+Test* Test::first = nullptr;
+uint64_t Test::failedCheckCount = 0;
+
+Test::Test(const char* name, TestFunction function) : name(name), function(function), next(nullptr)
+{
+    // Appended, so that tests run in the order they are defined in
+    Test** last = &first;
+    while (*last != nullptr) last = &(*last)->next;
+    *last = this;
+}
+
+void Test::Fail(const char* condition, const char* file, unsigned int line)
+{
+    fprintf(stderr, "%s:%u: check failed: %s\n", file, line, condition);
+    failedCheckCount++;
+}
+
+uint64_t Test::RunAll(const char* filter, const char* excludedPrefix)
+{
+    uint64_t runCount = 0;
+    uint64_t failedCount = 0;
+
+    for (Test* test = first; test != nullptr; test = test->next)
+    {
+        if (filter != nullptr && strstr(test->name, filter) == nullptr) continue;
+        if (excludedPrefix != nullptr && strncmp(test->name, excludedPrefix, strlen(excludedPrefix)) == 0) continue;
+
+        uint64_t previousFailedCheckCount = failedCheckCount;
+        test->function();
+        runCount++;
+
+        bool passed = failedCheckCount == previousFailedCheckCount;
+        if (!passed) failedCount++;
+        printf("test %s %s\n", test->name, passed ? "passed" : "failed");
+    }
+
+    printf("%lu of %lu tests passed\n", runCount - failedCount, runCount);
+    return failedCount;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+// Unit tests register themselves like benchmarks do. A failed CHECK reports where it failed and lets the test
+// go on, so that one run lists every broken expectation. An Assert in the kernel code still aborts the run.
+typedef void (*TestFunction)();
+
+class Test
+{
+public:
+    // Runs every test whose name contains filter (all of them if it is null),
+    // except those whose name starts with excludedPrefix, and returns how many of them failed
+    static uint64_t RunAll(const char* filter, const char* excludedPrefix);
+    static void Fail(const char* condition, const char* file, unsigned int line);
+    Test(const char* name, TestFunction function);
+
+private:
+    const char* name;
+    TestFunction function;
+    Test* next;
+    static Test* first;
+    static uint64_t failedCheckCount;
+};
+
+#define CHECK(condition) \
+    do { if (!(condition)) Test::Fail(#condition, __FILE__, __LINE__); } while (false)
+
+#define TEST(testName) \
+    static void testName(); \
+    static Test testName##Registration(#testName, testName); \
+    static void testName()
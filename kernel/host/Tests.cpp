@@ -0,0 +1,353 @@
+#include <stdio.h>
+#include "Test.h"
+#include "FileDisk.h"
+#include "Vector.h"
+#include "String.h"
+#include "Bitmap.h"
+#include "Ext2.h"
+#include "Heap.h"
+
+// Like the benchmarks, tests have to free what they allocate, the slabs only hold 5 pages each
+constexpr uint64_t VECTOR_LENGTH = 100;
+constexpr uint64_t BITMAP_SIZE = 16;
+constexpr uint64_t SLAB_BATCH_SIZE = 64;
+constexpr uint64_t SLAB_SLOT_SIZE = 32;
+constexpr uint64_t EXT2_BLOCK_SIZE = 0x1000;
+constexpr uint64_t EXT2_WRITE_SIZE = 2 * EXT2_BLOCK_SIZE + 100;
+
+const char* EXT2_PASSWD = "root:x:0:0::/root:/bin/bash\n";
+const char* EXT2_ROOT_NAMES[] = {"etc", "fonts", "root"};
+const char* EXT2_CREATED_NAME = "created-by-test";
+
+Ext2* ext2 = nullptr;
+
+// Too large for a slab
+uint8_t ext2WriteBuffer[EXT2_WRITE_SIZE];
+uint8_t ext2ReadBuffer[EXT2_WRITE_SIZE];
+
+bool BytesEqual(const void* a, const void* b, uint64_t count)
+{
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        if (static_cast<const uint8_t*>(a)[i] != static_cast<const uint8_t*>(b)[i]) return false;
+    }
+
+    return true;
+}
+
+uint64_t RawLength(const char* string)
+{
+    uint64_t length = 0;
+    while (string[length] != '\0') length++;
+    return length;
+}
+
+TEST(VectorPushAndGet)
+{
+    Vector<uint64_t> vector;
+    CHECK(vector.IsEmpty());
+
+    for (uint64_t i = 0; i < VECTOR_LENGTH; ++i) CHECK(vector.Push(i * 3) == i);
+
+    CHECK(vector.GetLength() == VECTOR_LENGTH);
+    CHECK(vector.GetLast() == (VECTOR_LENGTH - 1) * 3);
+    for (uint64_t i = 0; i < VECTOR_LENGTH; ++i) CHECK(vector.Get(i) == i * 3);
+
+    uint64_t sum = 0;
+    for (auto value : vector) sum += value;
+    CHECK(sum == 3 * VECTOR_LENGTH * (VECTOR_LENGTH - 1) / 2);
+}
+
+TEST(VectorPop)
+{
+    Vector<uint64_t> vector;
+    for (uint64_t i = 0; i < 5; ++i) vector.Push(i);
+
+    CHECK(vector.Pop() == 4);
+    CHECK(vector.Pop(1) == 1);
+    CHECK(vector.GetLength() == 3);
+    CHECK(vector.Get(0) == 0);
+    CHECK(vector.Get(1) == 2);
+    CHECK(vector.Get(2) == 3);
+
+    while (!vector.IsEmpty()) vector.Pop(0);
+    CHECK(vector.GetLength() == 0);
+}
+
+TEST(VectorCopiesAreIndependent)
+{
+    Vector<String> original;
+    original.Push(String("usr"));
+    original.Push(String("bin"));
+
+    Vector<String> copy(original);
+    copy.Get(0) = String("etc");
+    copy.Push(String("bash"));
+
+    Vector<String> assigned;
+    assigned.Push(String("root"));
+    assigned = original;
+    original.Pop();
+
+    CHECK(original.GetLength() == 1);
+    CHECK(original.Get(0).Equals("usr"));
+    CHECK(copy.GetLength() == 3);
+    CHECK(copy.Get(0).Equals("etc"));
+    CHECK(copy.Get(1).Equals("bin"));
+    CHECK(assigned.GetLength() == 2);
+    CHECK(assigned.Get(0).Equals("usr"));
+    CHECK(assigned.Get(1).Equals("bin"));
+}
+
+TEST(StringSplitAndCount)
+{
+    String path("/usr/share/terminfo");
+    CHECK(path.GetLength() == 19);
+    CHECK(path.Count('/') == 3);
+    CHECK(path.Count('x') == 0);
+    CHECK(path.Split('/', 0).IsEmpty());
+    CHECK(path.Split('/', 1).Equals("usr"));
+    CHECK(path.Split('/', 3).Equals("terminfo"));
+}
+
+TEST(StringEquals)
+{
+    String a("passwd");
+    CHECK(a.Equals(String("passwd")));
+    CHECK(a.Equals("passwd"));
+    CHECK(!a.Equals("passwd2"));
+    CHECK(!a.Equals("pass"));
+    CHECK(String().Equals(""));
+    CHECK(String().IsEmpty());
+}
+
+TEST(StringEditing)
+{
+    String string("usr/bin");
+    CHECK(string.Substring(4, 3).Equals("bin"));
+    CHECK(string.Substring(0, 0).IsEmpty());
+
+    string.Insert(String("/root/"), 0);
+    CHECK(string.Equals("/root/usr/bin"));
+
+    string.Push('/');
+    CHECK(string.Equals("/root/usr/bin/"));
+    CHECK(string[string.GetLength() - 1] == '/');
+
+    String copy(string);
+    string = String("tmp");
+    CHECK(copy.Equals("/root/usr/bin/"));
+    CHECK(string.Equals("tmp"));
+    CHECK(String('x').Equals("x"));
+    CHECK(String("abcdef", 3).Equals("abc"));
+}
+
+TEST(StringNumbersAndBounds)
+{
+    String number("4096");
+    CHECK(number.ToUnsignedInt() == 4096);
+    CHECK(number.IsNumeric(0));
+    CHECK(number.Match(3, '6'));
+
+    // The bounds checked forms are what userspace input goes through, even in release builds
+    CHECK(!number.IsNumeric(4, true));
+    CHECK(!number.Match(4, '\0', true));
+    CHECK(!String("4a").IsNumeric(1, true));
+}
+
+TEST(BitmapSetAndClear)
+{
+    uint8_t buffer[BITMAP_SIZE] = {};
+    Bitmap bitmap(buffer, BITMAP_SIZE, false);
+    CHECK(bitmap.TotalNumberOfBits() == BITMAP_SIZE * 8);
+
+    for (uint64_t bit = 0; bit < bitmap.TotalNumberOfBits(); bit += 3) bitmap.SetBit(bit, true);
+    for (uint64_t bit = 0; bit < bitmap.TotalNumberOfBits(); ++bit) CHECK(bitmap.GetBit(bit) == (bit % 3 == 0));
+
+    bitmap.SetBit(9, true);
+    bitmap.SetBit(9, false);
+    CHECK(!bitmap.GetBit(9));
+    CHECK(bitmap.GetBit(12));
+}
+
+TEST(BitmapBitOrder)
+{
+    uint8_t buffer[2] = {};
+    Bitmap lowFirst(buffer, 1, false);
+    Bitmap highFirst(buffer + 1, 1, true);
+
+    lowFirst.SetBit(0, true);
+    lowFirst.SetBit(3, true);
+    highFirst.SetBit(0, true);
+    highFirst.SetBit(3, true);
+
+    CHECK(buffer[0] == 0x09);
+    CHECK(buffer[1] == 0x90);
+}
+
+TEST(SlabReusesFreedSlot)
+{
+    void* first = operator new(SLAB_SLOT_SIZE);
+    operator delete(first);
+    void* second = operator new(SLAB_SLOT_SIZE);
+    CHECK(first == second);
+    operator delete(second);
+}
+
+TEST(SlabSlotsDoNotOverlap)
+{
+    uint8_t* pointers[SLAB_BATCH_SIZE];
+    for (uint64_t i = 0; i < SLAB_BATCH_SIZE; ++i)
+    {
+        // Sizes that round up to the same slot size come from the same slab
+        pointers[i] = static_cast<uint8_t*>(operator new(SLAB_SLOT_SIZE - i % 8));
+        CHECK(reinterpret_cast<uintptr_t>(pointers[i]) % SLAB_SLOT_SIZE == 0);
+        for (uint64_t j = 0; j < SLAB_SLOT_SIZE; ++j) pointers[i][j] = i;
+    }
+
+    for (uint64_t i = 0; i < SLAB_BATCH_SIZE; ++i)
+    {
+        for (uint64_t j = 0; j < SLAB_SLOT_SIZE; ++j) CHECK(pointers[i][j] == i);
+        operator delete(pointers[i]);
+    }
+}
+
+TEST(SlabSizeClasses)
+{
+    void* small = operator new(1);
+    void* medium = operator new(SLAB_SLOT_SIZE + 1);
+    void* large = operator new(0x1000);
+
+    auto smallAddress = reinterpret_cast<uintptr_t>(small);
+    auto mediumAddress = reinterpret_cast<uintptr_t>(medium);
+    auto largeAddress = reinterpret_cast<uintptr_t>(large);
+    CHECK(smallAddress % 8 == 0);
+    CHECK(mediumAddress % (SLAB_SLOT_SIZE * 2) == 0);
+    CHECK(largeAddress % 0x1000 == 0);
+
+    // Slots of different sizes come from different slabs, which are 5 pages each
+    CHECK(smallAddress + 0x5000 <= mediumAddress || mediumAddress + 0x5000 <= smallAddress);
+    CHECK(mediumAddress + 0x5000 <= largeAddress || largeAddress + 0x5000 <= mediumAddress);
+
+    operator delete(small);
+    operator delete(medium);
+    operator delete(large);
+}
+
+TEST(Ext2FindsFiles)
+{
+    VFS::Vnode* root = ext2->fileSystemRoot;
+    CHECK(root->type == VFS::VnodeType::Directory);
+
+    VFS::Vnode* etc = ext2->FindInDirectory(root, String("etc"));
+    CHECK(etc != nullptr);
+    if (etc == nullptr) return;
+    CHECK(etc->type == VFS::VnodeType::Directory);
+    CHECK(ext2->FindInDirectory(etc, String("missing")) == nullptr);
+
+    VFS::Vnode* passwd = ext2->FindInDirectory(etc, String("passwd"));
+    CHECK(passwd != nullptr);
+    if (passwd == nullptr) return;
+    CHECK(passwd->type == VFS::VnodeType::RegularFile);
+    CHECK(passwd->fileSize == RawLength(EXT2_PASSWD));
+
+    char buffer[64] = {};
+    CHECK(ext2->Read(passwd, buffer, passwd->fileSize, 0) == passwd->fileSize);
+    CHECK(BytesEqual(buffer, EXT2_PASSWD, RawLength(EXT2_PASSWD)));
+
+    // Reads past the end get what is left
+    CHECK(ext2->Read(passwd, buffer, sizeof(buffer), 5) == passwd->fileSize - 5);
+    CHECK(BytesEqual(buffer, EXT2_PASSWD + 5, passwd->fileSize - 5));
+}
+
+TEST(Ext2ReadDirectory)
+{
+    VFS::Vnode* root = ext2->fileSystemRoot;
+
+    bool found[sizeof(EXT2_ROOT_NAMES) / sizeof(EXT2_ROOT_NAMES[0])] = {};
+    for (uint64_t position = 0; position < root->fileSize; )
+    {
+        VFS::DirectoryEntry entry = ext2->ReadDirectory(root, position);
+        CHECK(entry.entrySize > 0);
+        if (entry.entrySize == 0) break;
+        position += entry.entrySize;
+
+        for (uint64_t i = 0; i < sizeof(found) / sizeof(found[0]); ++i)
+        {
+            if (!entry.name.Equals(EXT2_ROOT_NAMES[i])) continue;
+
+            found[i] = true;
+            CHECK(entry.type == VFS::VnodeType::Directory);
+            CHECK(ext2->FindInDirectory(root, entry.name)->inodeNum == entry.inodeNum);
+        }
+    }
+
+    for (bool wasFound : found) CHECK(wasFound);
+}
+
+TEST(Ext2CreateWriteRead)
+{
+    VFS::Vnode* root = ext2->fileSystemRoot;
+    String name(EXT2_CREATED_NAME);
+    CHECK(ext2->FindInDirectory(root, name) == nullptr);
+
+    VFS::Vnode* file = ext2->Create(root, name, VFS::VnodeType::RegularFile);
+    CHECK(file != nullptr);
+    if (file == nullptr) return;
+    CHECK(file->fileSize == 0);
+    CHECK(ext2->FindInDirectory(root, name) == file);
+
+    // Spans three blocks, so that the block lookup and allocation is covered past the first one
+    for (uint64_t i = 0; i < EXT2_WRITE_SIZE; ++i) ext2WriteBuffer[i] = i * 7 + i / EXT2_BLOCK_SIZE;
+    CHECK(ext2->Write(file, ext2WriteBuffer, EXT2_WRITE_SIZE, 0) == EXT2_WRITE_SIZE);
+    CHECK(file->fileSize == EXT2_WRITE_SIZE);
+
+    CHECK(ext2->Read(file, ext2ReadBuffer, EXT2_WRITE_SIZE, 0) == EXT2_WRITE_SIZE);
+    CHECK(BytesEqual(ext2ReadBuffer, ext2WriteBuffer, EXT2_WRITE_SIZE));
+
+    // An unaligned overwrite across a block boundary
+    const char* patch = "patched";
+    uint64_t patchPosition = EXT2_BLOCK_SIZE - 3;
+    CHECK(ext2->Write(file, patch, RawLength(patch), patchPosition) == RawLength(patch));
+    CHECK(file->fileSize == EXT2_WRITE_SIZE);
+    for (uint64_t i = 0; i < RawLength(patch); ++i) ext2WriteBuffer[patchPosition + i] = patch[i];
+    CHECK(ext2->Read(file, ext2ReadBuffer, EXT2_WRITE_SIZE, 0) == EXT2_WRITE_SIZE);
+    CHECK(BytesEqual(ext2ReadBuffer, ext2WriteBuffer, EXT2_WRITE_SIZE));
+
+    ext2->Truncate(file);
+    CHECK(file->fileSize == 0);
+    CHECK(ext2->Read(file, ext2ReadBuffer, EXT2_WRITE_SIZE, 0) == 0);
+}
+
+TEST(Ext2CreateDirectory)
+{
+    VFS::Vnode* root = ext2->fileSystemRoot;
+    VFS::Vnode* directory = ext2->Create(root, String("directory-by-test"), VFS::VnodeType::Directory);
+    CHECK(directory != nullptr);
+    if (directory == nullptr) return;
+    CHECK(directory->type == VFS::VnodeType::Directory);
+
+    VFS::Vnode* self = ext2->FindInDirectory(directory, String("."));
+    VFS::Vnode* parent = ext2->FindInDirectory(directory, String(".."));
+    CHECK(self != nullptr && self->inodeNum == directory->inodeNum);
+    CHECK(parent != nullptr && parent->inodeNum == root->inodeNum);
+}
+
+// Usage: kernel-test [--ext2 image] [filter]
+// The Ext2 tests write to the image, "make host-test" builds a fresh one from root-directory/ for every run.
+int main(int argc, char** argv)
+{
+    InitializeKernelHeap();
+
+    const char* filter = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (String(argv[i]).Equals("--ext2") && i + 1 < argc) ext2 = new Ext2(new FileDisk(argv[++i]));
+        else filter = argv[i];
+    }
+
+    if (ext2 == nullptr) fprintf(stderr, "No ext2 image given, skipping the Ext2 tests\n");
+
+    uint64_t failedCount = Test::RunAll(filter, ext2 == nullptr ? "Ext2" : nullptr);
+    return failedCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include "Vector.h"
+
+struct ACPITableHeader
+{
+    char signature[4];
+    uint32_t length;
+    uint8_t revision;
+    uint8_t checksum;
+    char oemId[6];
+    char oemTableId[8];
+    uint32_t oemRevision;
+    uint32_t creatorId;
+    uint32_t creatorRevision;
+} __attribute__((packed));
+
+struct MADTIOAPIC
+{
+    uint8_t id;
+    uintptr_t address; // Physical
+    uint32_t gsiBase;
+};
+
+// Legacy ISA IRQs are identity mapped to global system interrupts unless the MADT overrides them
+struct MADTInterruptOverride
+{
+    uint8_t irq;
+    uint32_t gsi;
+    bool activeLow;
+    bool levelTriggered;
+};
+
+class ACPI
+{
+public:
+    static void Initialize();
+    static const ACPITableHeader* FindTable(const char* signature);
+    static const Vector<MADTIOAPIC>& GetIOAPICs();
+    static const Vector<MADTInterruptOverride>& GetInterruptOverrides();
+private:
+    static void ParseMADT(const ACPITableHeader* madt);
+};
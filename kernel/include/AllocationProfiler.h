@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+#include "TextWriter.h"
+
+enum class AllocationKind : uint8_t
+{
+    Slab, Permanent, PageFrame
+};
+
+// Kept by the slab and page frame allocators for each slot or page frame, site is 0 while it is free
+struct AllocationTag
+{
+    uint32_t pid;
+    uint32_t site;
+};
+
+// Only collected in kernels built with -DALLOCATION_PROFILING. Allocations are accounted to the code that
+// called the allocator, and to the task that was running.
+class AllocationProfiler
+{
+public:
+    static uint32_t RecordAllocation(AllocationKind kind, uintptr_t caller, uint64_t size);
+    static void RecordFree(uint32_t site, uint64_t size);
+    static void RegisterTags(const AllocationTag* tags, uint64_t count, uint64_t unitSize);
+    static uint32_t GetCurrentPid();
+    static void ReportTaskAllocations(uint64_t pid);
+    static void Report(TextWriter& writer);
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Device.h"
+
+// Reads return the allocation profile as text, writes are ignored
+class AllocationProfilerDevice : public Device
+{
+public:
+    uint64_t Read(void* buffer, uint64_t count, uint64_t position) override;
+    uint64_t Write(const void* buffer, uint64_t count, uint64_t position) override;
+    AllocationProfilerDevice(const String& name, uint32_t inodeNum);
+};
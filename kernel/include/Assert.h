@@ -3,6 +3,18 @@
 [[noreturn]] void KernelPanic(const char* assertion, const char* file, unsigned int line, const char* function);
 void KernelWarn(const char* message, const char* file, unsigned int line);
 
+// ASSERT_LEVEL 2, the default, checks everything. Release builds use 1, which keeps the invariants that Assert
+// checks and drops the DebugAssert bounds checks of hot accessors like Vector::Get.
+#ifndef ASSERT_LEVEL
+#define ASSERT_LEVEL 2
+#endif
+
 #define Panic() KernelPanic("None", __FILE__, __LINE__, __func__)
 #define Assert(assertion) if (!(assertion)) KernelPanic(#assertion, __FILE__, __LINE__, __func__)
+
+#if ASSERT_LEVEL >= 2
+#define DebugAssert(assertion) Assert(assertion)
+#else
+#define DebugAssert(assertion) if (false) (void)(assertion) // Still compiled, so it can't go stale
+#endif
 #define Warn(message) KernelWarn(message, __FILE__, __LINE__)
\ No newline at end of file
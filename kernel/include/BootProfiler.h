@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include "TextWriter.h"
+
+enum class BootPhase : uint8_t
+{
+    Firmware, // Everything before the kernel's entry, the TSC starts counting at reset
+    PageFrameAllocator,
+    Heap,
+    DescriptorTables,
+    InterruptControllers,
+    Framebuffer,
+    VFS,
+    Font,
+    InitTask,
+    StartCores,
+    TimerCalibration,
+    CoreWakeup, // From the BSP releasing an AP to the AP entering the kernel, only exact if their TSCs are in sync
+    CoreBringUp,
+    Total,
+    Count
+};
+
+// Records TSC timestamps of the phases of boot, in _start on the BSP and in InitializeCore on every AP.
+// Once the last core is up, the phases are logged as a table with the slowest one, /proc/boot has the same table.
+class BootProfiler
+{
+public:
+    static void Start(); // Called first thing in _start, phases are reported relative to it
+    static void Record(BootPhase phase, uint64_t startTimestamp); // The phase ends now, on the calling core
+    static void FinishCore(); // Logs the table once every core has called it
+    static void Report(TextWriter& writer);
+};
@@ -2,13 +2,23 @@
 
 #include "Scheduler.h"
 
+class WorkQueue;
+
 struct CPU
 {
     Scheduler* scheduler = nullptr;
+    WorkQueue* workQueue = nullptr;
     static uint32_t GetCoreID();
     static CPU GetStruct();
+    static CPU GetStruct(uint32_t coreId);
+    static uint64_t ReadTimestampCounter();
+    static uint64_t GetTimestampCounterFrequency();
+    static void SetTimestampCounterFrequency(uint64_t frequency);
+    static uint32_t GetCoreCount();
+    static bool IsCoreOnline(uint32_t coreId);
     static void InitializeCPUList(unsigned long cpuCount);
     static void InitializeCPUStruct(Scheduler* scheduler);
     static void EnableSSE();
+    static void InitializePAT();
     static void SetTCB(const void* tcbAddr);
 };
\ No newline at end of file
@@ -1,12 +1,19 @@
 #pragma once
 
 #include "String.h"
+#include "Error.h"
 
 class Device
 {
 public:
-    virtual uint64_t Read(void* buffer, uint64_t count, uint64_t position) = 0;
+    virtual uint64_t Read(void* buffer, uint64_t count, uint64_t position);
     virtual uint64_t Write(const void* buffer, uint64_t count, uint64_t position) = 0;
+    // Stream devices, such as /dev/kmsg, are read through here instead. The position is the reader's file offset,
+    // which the device moves past what it returns and which can't be changed with lseek.
+    virtual uint64_t ReadStream(void* buffer, uint64_t count, uint64_t& position, bool nonBlocking, Error& error);
+    virtual uint64_t GetStreamStart(); // The position of a reader that has just opened the device
+    virtual uint64_t Control(uint64_t request, void* argument, Error& error);
+    virtual void* Map(void* addr, uint64_t length, Error& error);
     Device(const String& name, uint32_t inodeNum) : name(name), inodeNum(inodeNum) {}
     [[nodiscard]] String GetName() const;
     [[nodiscard]] uint32_t GetInodeNumber() const;
@@ -14,6 +14,8 @@ public:
     String GetPathFromSymbolicLink(VFS::Vnode* symLinkVnode) override;
     VFS::Vnode* Create(VFS::Vnode* directory, const String& name, VFS::VnodeType vnodeType) override;
     void Truncate(VFS::Vnode* vnode) override;
+    uint64_t Control(VFS::Vnode* vnode, uint64_t request, void* argument, Error& error) override;
+    void* Map(VFS::Vnode* vnode, void* addr, uint64_t length, Error& error) override;
     explicit DeviceFS(Disk* disk);
 private:
     Vector<Device*> devices;
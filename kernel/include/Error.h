@@ -15,4 +15,5 @@ enum class Error : int64_t
     BadFileDescriptor = 1081,
     BadRange = 3,
     NoChildren = 1012,
+    WouldBlock = 1006,
 };
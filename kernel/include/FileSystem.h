@@ -15,6 +15,8 @@ public:
     virtual String GetPathFromSymbolicLink(VFS::Vnode* symLinkVnode) = 0;
     virtual VFS::Vnode* Create(VFS::Vnode* directory, const String& name, VFS::VnodeType vnodeType) = 0;
     virtual void Truncate(VFS::Vnode* vnode) = 0;
+    virtual uint64_t Control(VFS::Vnode* vnode, uint64_t request, void* argument, Error& error);
+    virtual void* Map(VFS::Vnode* vnode, void* addr, uint64_t length, Error& error);
     explicit FileSystem(Disk* disk);
     virtual ~FileSystem();
     FileSystem& operator=(const FileSystem&) = delete;
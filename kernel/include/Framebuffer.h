@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Colour.h"
+#include "FramebufferInfo.h"
 
 class Framebuffer
 {
@@ -10,11 +11,16 @@ public:
     static void Initialize();
     static long Width();
     static long Height();
+    static long Stride();
     static uint32_t* GetBuffer();
+    static uintptr_t GetPhysicalAddress();
+    static uint64_t GetSize();
+    static FramebufferInfo GetInfo();
 private:
     static uint32_t* virtAddr;
     static uint16_t width;
     static uint16_t height;
+    static uint16_t pitch;
     static uint8_t redShift;
     static uint8_t blueShift;
     static uint8_t greenShift;
@@ -2,10 +2,43 @@
 
 #include "Device.h"
 
+enum class FramebufferRequest : uint64_t
+{
+    GetInfo = 0x4600,
+    Blit = 0x4601
+};
+
+enum class PixelFormat : uint32_t
+{
+    XRGB8888 = 0,
+    XBGR8888 = 1,
+    RGB565 = 2
+};
+
+// Copies the rectangle (sourceX, sourceY, width, height) of a userspace buffer to (destinationX, destinationY)
+// in the framebuffer, repeating every pixel scale times in both directions
+struct FramebufferBlit
+{
+    const void* buffer;
+    uint32_t pitch; // Bytes per row of buffer
+    PixelFormat format;
+    uint32_t sourceX;
+    uint32_t sourceY;
+    uint32_t width;
+    uint32_t height;
+    uint32_t destinationX;
+    uint32_t destinationY;
+    uint32_t scale;
+} __attribute__((packed));
+
 class FramebufferDevice : public Device
 {
 public:
     uint64_t Read(void* buffer, uint64_t count, uint64_t position) override;
     uint64_t Write(const void* buffer, uint64_t count, uint64_t position) override;
+    uint64_t Control(uint64_t request, void* argument, Error& error) override;
+    void* Map(void* addr, uint64_t length, Error& error) override;
     FramebufferDevice(const String& name, uint32_t inodeNum);
-};
\ No newline at end of file
+private:
+    static void Blit(const FramebufferBlit& blit, Error& error);
+};
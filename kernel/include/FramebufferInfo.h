@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdint.h>
+
+struct FramebufferInfo
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch; // Bytes per row
+    uint32_t bitsPerPixel;
+    uint8_t redShift;
+    uint8_t greenShift;
+    uint8_t blueShift;
+} __attribute__((packed));
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "TextWriter.h"
+
+// Arc counters of kernels built with PGO=generate, which compiles with -fprofile-arcs -fprofile-info-section.
+// There is no libgcov in the kernel, so nothing writes .gcda files at exit. Instead, the counters are dumped to
+// the debug port on request and tools/gcov2gcda.py turns the dump into the .gcda files that PGO=use reads.
+class Gcov
+{
+public:
+    static bool IsEnabled();
+    static void DumpToDebugPort();
+    static void Report(TextWriter& writer);
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Device.h"
+
+// Reads say whether the kernel has arc counters, writing anything dumps them to the debug port
+class GcovDevice : public Device
+{
+public:
+    uint64_t Read(void* buffer, uint64_t count, uint64_t position) override;
+    uint64_t Write(const void* buffer, uint64_t count, uint64_t position) override;
+    GcovDevice(const String& name, uint32_t inodeNum);
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include "Vector.h"
+#include "Spinlock.h"
+
+class IOAPIC
+{
+public:
+    static void Initialize();
+    static void Route(uint32_t gsi, uint8_t vector, uint32_t destinationCore, bool activeLow, bool levelTriggered);
+    static void SetDestination(uint32_t gsi, uint32_t destinationCore);
+    static void Mask(uint32_t gsi);
+    static uint32_t GetLegacyIRQ(uint8_t irq, bool& activeLow, bool& levelTriggered);
+private:
+    static IOAPIC& GetIOAPIC(uint32_t gsi);
+    uint32_t ReadRegister(uint32_t index);
+    void WriteRegister(uint32_t index, uint32_t value);
+
+    uintptr_t registerBase;
+    uint32_t gsiBase;
+    uint32_t redirectionEntryCount;
+    Spinlock lock {LockClass::IOAPIC};
+
+    static Vector<IOAPIC*>* ioapics;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+// Legacy ISA IRQ n is delivered on vector IRQ_LEGACY_VECTOR_BASE + n,
+// MSI vectors are allocated from the dynamic range
+constexpr uint8_t IRQ_LEGACY_VECTOR_BASE = 32;
+constexpr uint8_t IRQ_FIRST_DYNAMIC_VECTOR = 64;
+constexpr uint8_t IRQ_LAST_DYNAMIC_VECTOR = 127;
+
+// Address and data a device writes to raise a message signalled interrupt
+struct MSIMessage
+{
+    uint64_t address;
+    uint32_t data;
+};
+
+class IRQ
+{
+public:
+    typedef void (*Handler)(uint64_t argument);
+
+    // Called with the message a device must use whenever the vector's destination core changes
+    typedef void (*MSIProgrammer)(MSIMessage message, uint64_t argument);
+
+    static void Initialize();
+    static uint8_t RouteLegacy(uint8_t irq, Handler handler, uint64_t argument);
+    static uint8_t AllocateMSI(Handler handler, MSIProgrammer programmer, uint64_t argument);
+    static void Free(uint8_t vector);
+    static void SetAffinity(uint8_t vector, uint32_t coreId);
+    static uint32_t GetAffinity(uint8_t vector);
+    static void Rebalance();
+    static void Dispatch(uint8_t vector);
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+#include "TextWriter.h"
+
+// Counts every interrupt vector per core, and keeps log2 histograms of the latency of the timer, keyboard,
+// system call and suspension paths. Each core only updates its own counters, with interrupts disabled,
+// so recording doesn't need atomics.
+class InterruptStatistics
+{
+public:
+    static void Record(uint8_t vector);
+    static void RecordLatency(uint8_t vector, uint64_t cycles); // Ignores vectors without a histogram
+    static uint64_t GetTotal();
+    static void Report(TextWriter& writer); // In the format of Linux's /proc/interrupts
+    static void ReportLatency(TextWriter& writer);
+};
@@ -5,5 +5,8 @@
 class Keyboard
 {
 public:
+    static void Initialize();
     static void SendKeyToTerminal(uint8_t scanCode);
+private:
+    static void InterruptHandler(uint64_t);
 };
\ No newline at end of file
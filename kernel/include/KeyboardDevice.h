@@ -1,12 +1,46 @@
 #pragma once
 
 #include "Device.h"
+#include "Vector.h"
+#include "Spinlock.h"
+
+struct KeyboardEvent
+{
+    uint64_t timestamp; // Milliseconds since boot
+    uint32_t scanCode; // Scan code set 1 without the release bit, codes prefixed by 0xe0 have 0x100 added
+    uint32_t value; // 0 when released, 1 when pressed, 2 when repeated by the keyboard
+};
+
+// An event with this scan code reports that value events were lost because the reader fell behind
+constexpr uint32_t KEYBOARD_EVENTS_DROPPED = 0;
 
 class KeyboardDevice : public Device
 {
 public:
-    uint64_t Read(void* buffer, uint64_t count, uint64_t position) override;
     uint64_t Write(const void* buffer, uint64_t count, uint64_t position) override;
+    uint64_t ReadStream(void* buffer, uint64_t count, uint64_t& nextEvent, bool nonBlocking, Error& error) override;
+    uint64_t GetStreamStart() override;
+    void KeyboardInput(uint8_t scanCode);
     KeyboardDevice(const String& name, uint32_t inodeNum);
     static KeyboardDevice* instance;
+private:
+    struct ReadRequest;
+
+    void WakeReaders();
+
+    // Events are kept in a ring buffer indexed by their sequence number, every reader has its own position
+    KeyboardEvent* events;
+    uint64_t eventCount = 0;
+
+    bool extendedPrefix = false;
+    bool pressedKeys[0x200] {};
+
+    Vector<ReadRequest> unblockQueue;
+    Spinlock lock {LockClass::Keyboard};
+};
+
+struct KeyboardDevice::ReadRequest
+{
+    uint64_t pid;
+    uint64_t suspensionId;
 };
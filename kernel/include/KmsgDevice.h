@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Device.h"
+
+enum class KmsgRequest
+{
+    SetLevel = 0x4b00 // Argument: pointer to a uint32_t LogLevel, messages below it are dropped
+};
+
+// Reads return one kernel log record at a time, the file offset is the sequence of the next record.
+// Writes add a message to the kernel log.
+class KmsgDevice : public Device
+{
+public:
+    uint64_t Write(const void* buffer, uint64_t count, uint64_t position) override;
+    uint64_t ReadStream(void* buffer, uint64_t count, uint64_t& sequence, bool nonBlocking, Error& error) override;
+    uint64_t Control(uint64_t request, void* argument, Error& error) override;
+    KmsgDevice(const String& name, uint32_t inodeNum);
+};
@@ -8,10 +8,14 @@ public:
     void SetTimeBetweenTimerFires(uint64_t milliseconds);
     uint64_t GetTimeRemainingMilliseconds() const;
     void SendEOI();
+    void SendIPI(uint32_t destinationCore, uint8_t vector);
     LAPIC();
 private:
     uint64_t apicRegisterBase;
     uint64_t lapicTimerBaseFrequency;
+    bool x2apic;
     uint64_t GetTimerBaseFrequency();
     uint64_t GetBaseMSR();
+    uint32_t ReadRegister(uint64_t offset) const;
+    void WriteRegister(uint64_t offset, uint32_t value);
 };
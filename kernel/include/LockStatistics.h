@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+#include "Spinlock.h"
+#include "TextWriter.h"
+
+// Only collected in kernels built with -DLOCK_STATISTICS. Counters are kept per core and only
+// updated while the lock is held, so that recording doesn't need atomics or bounce cache lines.
+class LockStatistics
+{
+public:
+    static void RecordAcquisition(LockClass lockClass, bool contended, uint64_t spinCycles, uintptr_t caller);
+    static void RecordRelease(LockClass lockClass, uint64_t holdCycles, uintptr_t caller);
+    static void Report(TextWriter& writer);
+    static void Clear();
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Device.h"
+
+// Reads return the lock statistics report as text, writing anything clears the statistics
+class LockStatisticsDevice : public Device
+{
+public:
+    uint64_t Read(void* buffer, uint64_t count, uint64_t position) override;
+    uint64_t Write(const void* buffer, uint64_t count, uint64_t position) override;
+    LockStatisticsDevice(const String& name, uint32_t inodeNum);
+};
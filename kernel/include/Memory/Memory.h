@@ -4,4 +4,5 @@
 
 void* memset(void* ptr, uint8_t value, uint64_t num);
 void* memcpy(void* destination, const void* source, uint64_t num);
-uintptr_t HigherHalf(uintptr_t physAddr);
\ No newline at end of file
+uintptr_t HigherHalf(uintptr_t physAddr);
+uintptr_t LowerHalf(uintptr_t virtAddr);
\ No newline at end of file
@@ -5,7 +5,10 @@
 void InitializePageFrameAllocator();
 uintptr_t RequestPageFrame();
 uintptr_t RequestPageFrames(uint64_t count);
+uintptr_t RequestPageFrames(uint64_t count, uintptr_t caller); // For allocators built on page frames, to account their callers
 void FreePageFrame(void* ptr);
 void FreePageFrames(void* ptr, uint64_t count);
 
 extern uint64_t pageFrameCount;
+extern uint64_t usablePageFrameCount; // Page frames the memory map reports as usable RAM
+extern uint64_t usedPageFrameCount;
@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include "Spinlock.h"
+#include "Vector.h"
 
 enum class PagingFlag : uint64_t
 {
@@ -11,29 +12,49 @@ enum class PagingFlag : uint64_t
     WriteThrough = 3,
     CacheDisable = 4,
     Accessed = 5,
+    PAT = 7, // Only valid in page table entries, selects PAT entry 4 (write-combining, see CPU::InitializePAT)
+    Device = 9, // Ignored by the CPU, marks page table entries that map device memory instead of a page frame
     NX = 63
 };
 
 class PagingManager
 {
 public:
+    // A run of contiguous user pages with the same permissions
+    struct Mapping
+    {
+        uintptr_t start;
+        uintptr_t end;
+        bool writable;
+        bool executable;
+    };
+
     void InitializePaging();
     void CopyUserspace(PagingManager& original);
     void SetCR3() const;
     void MapMemory(const void* virtAddr, const void* physAddr);
+    // Forked address spaces share device memory instead of copying it, and it doesn't count as the task's pages
+    void MapDeviceMemory(const void* virtAddr, const void* physAddr, bool writeCombining);
     unsigned int FlagMismatchLevel(const void* virtAddr, PagingFlag flag, bool enabled);
     unsigned int PageNotPresentLevel(const void* virtAddr);
+    void GetUserMappings(Vector<Mapping>& mappings);
+    uint64_t GetUserPageCount() const;
     static void SaveBootloaderAddressSpace();
+    static PagingManager kernelAddressSpace; // The bootloader's page tables, for tasks that never leave the kernel
     uintptr_t pml4PhysAddr {};
 private:
     struct PageTableEntry;
     PageTableEntry* pml4 {};
-    Spinlock lock;
+    uint64_t userPageCount = 0;
+    Spinlock lock {LockClass::PagingManager};
     static PageTableEntry* defaultPml4;
     static void GetPageTableIndexes(const void* virtAddr, uint16_t* pageIndexes);
     static void PopulatePagingStructureEntry(PageTableEntry& entry, uintptr_t physAddr);
     static PageTableEntry* AllocatePagingStructure(PageTableEntry& entry);
+    PageTableEntry& MapPage(const void* virtAddr, const void* physAddr);
     void CopyPages(const PageTableEntry* originalTable, PageTableEntry* table, uint64_t pageCount, unsigned int level);
+    static void AddUserMappings(const PageTableEntry* table, uintptr_t tableStart, unsigned int level, bool writable,
+                                bool executable, Vector<Mapping>& mappings);
 };
 
 struct PagingManager::PageTableEntry
@@ -6,6 +6,8 @@ class UserspaceAllocator
 {
 public:
     void* AllocatePages(uint64_t pageCount);
+    bool Reserve(uintptr_t addr, uint64_t pageCount);
 private:
-    uintptr_t currentAddr {0x1'0000'0000};
+    static constexpr uintptr_t START = 0x1'0000'0000;
+    uintptr_t currentAddr {START};
 };
\ No newline at end of file
@@ -2,6 +2,5 @@
 
 #include "IO.h"
 
+// Device interrupts are routed through the IOAPIC, the PIC is only remapped out of the way of the exceptions and masked
 void InitializePIC();
-void PICSendEIO(int irq);
-void ActivatePICKeyboardInterrupts();
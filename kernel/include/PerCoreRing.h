@@ -0,0 +1,156 @@
+#pragma once
+
+#include <stdint.h>
+#include "CPU.h"
+
+constexpr uint64_t PER_CORE_RING_MAX_CORES = 32;
+
+// Fixed-size records written into a ring owned by the writing core, and numbered by one global sequence.
+// A ring is only written by its own core with interrupts disabled, so writers never wait on each other.
+// Readers on any core look records up by sequence, through an index from the sequence to the slot holding it,
+// and check the sequence of a record again after copying it to detect that it was overwritten meanwhile.
+template <typename Record, uint64_t Size> class PerCoreRing
+{
+public:
+    enum class Status
+    {
+        Found, Pending, Lost
+    };
+
+    template <typename Fill> bool Push(Fill fill);
+    Status Find(uint64_t sequence, Record& record, uint64_t& nextAvailable) const;
+    uint64_t GetNextSequence() const;
+
+private:
+    // Marks a slot that is being written and must not be read yet
+    static constexpr uint64_t SEQUENCE_WRITING = UINT64_MAX;
+
+    // One entry per slot of all the rings, holding the writing core times Size plus the slot in its ring
+    static constexpr uint64_t INDEX_SIZE = PER_CORE_RING_MAX_CORES * Size;
+    static_assert(INDEX_SIZE <= UINT16_MAX + 1);
+
+    Status Scan(uint64_t sequence, Record& record, uint64_t& nextAvailable) const;
+
+    struct Slot
+    {
+        uint64_t sequence;
+        Record record;
+    };
+
+    struct Ring
+    {
+        Slot slots[Size];
+        uint64_t head; // Number of records ever written to the ring
+        bool writing;
+    };
+
+    Ring rings[PER_CORE_RING_MAX_CORES];
+    uint16_t index[INDEX_SIZE];
+    uint64_t nextSequence;
+};
+
+// Fills a new record on the current core's ring, returns false if the core has no ring
+template <typename Record, uint64_t Size>
+template <typename Fill>
+bool PerCoreRing<Record, Size>::Push(Fill fill)
+{
+    uint64_t flags;
+    asm volatile("pushfq; pop %0; cli" : "=r"(flags) : : "memory");
+
+    uint32_t coreId = CPU::GetCoreID();
+    bool pushed = coreId < PER_CORE_RING_MAX_CORES;
+
+    if (pushed)
+    {
+        Ring& ring = rings[coreId];
+        __atomic_store_n(&ring.writing, true, __ATOMIC_SEQ_CST);
+
+        Slot& slot = ring.slots[ring.head % Size];
+        __atomic_store_n(&slot.sequence, SEQUENCE_WRITING, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        uint64_t sequence = __atomic_fetch_add(&nextSequence, 1, __ATOMIC_SEQ_CST);
+        auto location = static_cast<uint16_t>(coreId * Size + ring.head % Size);
+        __atomic_store_n(&index[sequence % INDEX_SIZE], location, __ATOMIC_RELAXED);
+        fill(slot.record);
+
+        __atomic_store_n(&slot.sequence, sequence, __ATOMIC_RELEASE);
+        __atomic_store_n(&ring.head, ring.head + 1, __ATOMIC_RELEASE);
+        __atomic_store_n(&ring.writing, false, __ATOMIC_SEQ_CST);
+    }
+
+    // Bit 9: Interrupt flag
+    if (flags & (1 << 9)) asm volatile("sti" : : : "memory");
+
+    return pushed;
+}
+
+// When the record was overwritten, nextAvailable is set to the oldest sequence after it that can still be read.
+// Pending means that the record hasn't been written yet.
+template <typename Record, uint64_t Size>
+typename PerCoreRing<Record, Size>::Status PerCoreRing<Record, Size>::Find(uint64_t sequence, Record& record,
+                                                                          uint64_t& nextAvailable) const
+{
+    if (sequence >= GetNextSequence()) return Status::Pending;
+
+    // The index entry only leads to the record while the slot still holds it. When it doesn't,
+    // the rings are scanned, which is rare enough: once per run of lost records, or for a record
+    // that outlived INDEX_SIZE newer ones because the other cores wrote them.
+    uint16_t location = __atomic_load_n(&index[sequence % INDEX_SIZE], __ATOMIC_RELAXED);
+    const Slot& slot = rings[location / Size].slots[location % Size];
+    if (__atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE) == sequence)
+    {
+        record = slot.record;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot.sequence, __ATOMIC_RELAXED) == sequence) return Status::Found;
+    }
+
+    return Scan(sequence, record, nextAvailable);
+}
+
+template <typename Record, uint64_t Size>
+typename PerCoreRing<Record, Size>::Status PerCoreRing<Record, Size>::Scan(uint64_t sequence, Record& record,
+                                                                          uint64_t& nextAvailable) const
+{
+    uint64_t limit = GetNextSequence();
+
+    // A writer that took a sequence below the limit has its flag set until its record is published,
+    // so checking the flags before looking at the rings tells an unpublished record apart from a lost one
+    bool writing = false;
+    for (const Ring& ring : rings)
+    {
+        if (__atomic_load_n(&ring.writing, __ATOMIC_SEQ_CST)) writing = true;
+    }
+
+    nextAvailable = limit;
+    for (const Ring& ring : rings)
+    {
+        uint64_t head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+        uint64_t start = head > Size ? head - Size : 0;
+
+        for (uint64_t i = start; i < head; ++i)
+        {
+            const Slot& slot = ring.slots[i % Size];
+            uint64_t slotSequence = __atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE);
+
+            if (slotSequence == sequence)
+            {
+                record = slot.record;
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                if (__atomic_load_n(&slot.sequence, __ATOMIC_RELAXED) == sequence) return Status::Found;
+            }
+            else if (slotSequence > sequence && slotSequence < nextAvailable)
+            {
+                nextAvailable = slotSequence;
+            }
+        }
+    }
+
+    return writing ? Status::Pending : Status::Lost;
+}
+
+template <typename Record, uint64_t Size>
+uint64_t PerCoreRing<Record, Size>::GetNextSequence() const
+{
+    return __atomic_load_n(&nextSequence, __ATOMIC_SEQ_CST);
+}
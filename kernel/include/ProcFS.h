@@ -0,0 +1,30 @@
+#pragma once
+
+#include "VFS.h"
+#include "FileSystem.h"
+#include "Task.h"
+#include "TextWriter.h"
+
+// Generates text files describing the system and every task, in the formats of Linux's procfs
+// so that tools written for it can read them. Contents are generated on every read.
+class ProcFS : public FileSystem
+{
+public:
+    uint64_t Read(VFS::Vnode* vnode, void* buffer, uint64_t count, uint64_t readPos) override;
+    uint64_t Write(VFS::Vnode* vnode, const void* buffer, uint64_t count, uint64_t writePos) override;
+    VFS::Vnode* FindInDirectory(VFS::Vnode* directory, const String& name) override;
+    VFS::DirectoryEntry ReadDirectory(VFS::Vnode* directory, uint64_t readPos) override;
+    String GetPathFromSymbolicLink(VFS::Vnode* symLinkVnode) override;
+    VFS::Vnode* Create(VFS::Vnode* directory, const String& name, VFS::VnodeType vnodeType) override;
+    void Truncate(VFS::Vnode* vnode) override;
+    explicit ProcFS(Disk* disk);
+private:
+    VFS::Vnode* GetVnode(uint32_t inodeNum, VFS::VnodeType type);
+    static void WriteMemoryInformation(TextWriter& writer);
+    static void WriteStatistics(TextWriter& writer);
+    static void WriteLoadAverages(TextWriter& writer);
+    static void WriteUptime(TextWriter& writer);
+    static void WriteTaskStatistics(TextWriter& writer, const Task& task, uint64_t userPageCount);
+    static void WriteTaskStatus(TextWriter& writer, const Task& task, uint64_t userPageCount);
+    static void WriteTaskMappings(TextWriter& writer, uint64_t pid);
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include "Task.h"
+
+constexpr uint64_t PROFILE_STACK_DEPTH = 16;
+constexpr uint64_t PROFILE_MAX_FREQUENCY = 1000;
+
+struct ProfileSample
+{
+    uint64_t timestamp; // TSC ticks
+    uint64_t weight; // TSC ticks since the previous sample on the same core
+    uint64_t pid;
+    uint32_t coreId;
+    uint32_t depth; // Entries used in stack
+    uint64_t stack[PROFILE_STACK_DEPTH]; // The interrupted RIP, then the return addresses found by following RBP
+};
+
+// Samples are taken from the LAPIC timer interrupt, so code that runs with interrupts disabled is
+// attributed to where it enables them again.
+class Profiler
+{
+public:
+    static void Sample(const InterruptFrame* interruptFrame);
+    static uint64_t Read(ProfileSample* buffer, uint64_t maxCount, uint64_t& sequence);
+    static uint64_t GetNextSequence();
+    static void SetFrequency(uint64_t frequency);
+    static void SetStreaming(bool enabled);
+
+    // The longest the scheduler may let its timer run while profiling, 0 when the profiler is off
+    static uint64_t timerIntervalMilliseconds;
+private:
+    static void StreamThread(void*);
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Device.h"
+
+enum class ProfileRequest
+{
+    SetFrequency = 0x5403, // Argument: pointer to a uint64_t, samples per second on each core, 0 stops the profiler
+    SetStreaming = 0x5404 // Argument: pointer to a uint64_t, non-zero writes samples to the debug port as they are taken
+};
+
+// Reads return ProfileSamples, the file offset is the sequence of the next sample.
+// Writing a decimal frequency, like "echo 100 > /dev/profile", starts the profiler and streams to the debug port.
+class ProfilerDevice : public Device
+{
+public:
+    uint64_t Write(const void* buffer, uint64_t count, uint64_t position) override;
+    uint64_t ReadStream(void* buffer, uint64_t count, uint64_t& sequence, bool nonBlocking, Error& error) override;
+    uint64_t GetStreamStart() override;
+    uint64_t Control(uint64_t request, void* argument, Error& error) override;
+    ProfilerDevice(const String& name, uint32_t inodeNum);
+};
@@ -7,31 +7,67 @@
 #include "TimerEntry.h"
 #include "TSS.h"
 
+// Returned by SuspendSystemCall when the suspension timed out instead of being ended by Unsuspend
+constexpr uint64_t SUSPENSION_TIMED_OUT = UINT64_MAX;
+
+// Who GetResourceUsage reports on, the values of Linux's RUSAGE_SELF and RUSAGE_CHILDREN
+constexpr int64_t RESOURCE_USAGE_SELF = 0;
+constexpr int64_t RESOURCE_USAGE_CHILDREN = -1;
+
+// Load averages are fixed point with this many fractional bits, like Linux's
+constexpr uint64_t LOAD_AVERAGE_SHIFT = 11;
+
+struct SchedulerStatistics
+{
+    uint64_t loadAverages[3]; // Over 1, 5 and 15 minutes
+    uint64_t runnableCount;
+    uint64_t taskCount;
+    uint64_t createdCount; // Tasks created since boot
+};
+
 class Scheduler
 {
 public:
     void SwitchToNextTask(InterruptFrame* interruptFrame);
     void ExitCurrentTask(int status, InterruptFrame* interruptFrame);
     void ConfigureTimerClosestExpiry();
-    uint64_t SuspendSystemCall(TaskState newTaskState, uint64_t argument = 0);
+    uint64_t SuspendSystemCall(TaskState newTaskState, uint64_t argument = 0, uint64_t timeoutMilliseconds = 0);
     void SleepCurrentTask(uint64_t milliseconds);
+    void YieldCurrentTask();
     uint64_t ForkCurrentTask(InterruptFrame* interruptFrame);
     void Execute(const String& path, InterruptFrame* interruptFrame, const Vector<String>& arguments, const Vector<String>& environment, Error& error);
-    uint64_t WaitForChild(uint64_t pid, int& status, Error& error);
+    uint64_t WaitForChild(uint64_t pid, int& status, ResourceUsage* childUsage, Error& error);
+    void GetResourceUsage(int64_t who, ResourceUsage& resourceUsage, Error& error);
+    void AccountTime(uint64_t timestamp, bool userMode);
     static void InitializeQueue();
     static void StartCores(TSS* bspTss);
     static void CreateTaskFromELF(const String& path, const Vector<String>& arguments, const Vector<String>& environment);
+    static uint64_t CreateKernelThread(void (*entry)(void*), void* argument, int64_t pinnedCore = -1);
     static void Unsuspend(uint64_t pid, uint64_t returnValue);
+    static bool Unsuspend(uint64_t pid, uint64_t suspensionId, uint64_t returnValue);
+    static bool SetTraced(uint64_t pid, bool traced);
+    static bool CopyTask(uint64_t pid, Task& copy, uint64_t& userPageCount);
+    static void GetPids(Vector<uint64_t>& pids);
+    static bool GetTaskMappings(uint64_t pid, Vector<PagingManager::Mapping>& mappings);
+    static SchedulerStatistics GetStatistics();
     static uint64_t GetClock();
     static Scheduler* GetScheduler();
     explicit Scheduler(TSS* tss);
     Task currentTask;
     LAPIC* lapic;
 
+    // Time this core spent running tasks in user and kernel mode, and idling, in timestamp counter ticks
+    uint64_t userTime = 0;
+    uint64_t systemTime = 0;
+    uint64_t idleTime = 0;
+    uint64_t contextSwitchCount = 0;
+
 private:
     void UpdateTimerEntries();
     static uint64_t GeneratePID();
     static Task& GetTask(uint64_t pid);
+    static Task* FindTask(uint64_t pid);
+    static void UpdateLoadAverages(uint64_t timestamp);
     static void Unsuspend(Task& task, uint64_t returnValue);
 
     TSS* tss;
@@ -3,9 +3,35 @@
 #include <stdint.h>
 #include <stdarg.h>
 #include "String.h"
+#include "Error.h"
 
+enum class LogLevel : uint8_t
+{
+    Debug = 0, Info = 1, Warning = 2, Error = 3
+};
+
+// LogDebug messages are compiled out unless the kernel is built with -DLOG_COMPILE_LEVEL=0
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 1
+#endif
+
+#define LogDebug(...) do { if constexpr (LOG_COMPILE_LEVEL <= 0) Serial::Log(LogLevel::Debug, __VA_ARGS__); } while (false)
+
+// Messages are formatted into per-core rings without taking any lock,
+// and written to the debug port by a background thread once it has been started.
 class Serial
 {
 public:
-    static void Log(const char* string, ...);
-};
\ No newline at end of file
+    static void Log(const char* format, ...);
+    static void Log(LogLevel level, const char* format, ...);
+    static void SetLevel(LogLevel level);
+    static void StartDrainThread();
+    static void Flush();
+    static void LogSynchronously(const char* format, ...);
+    static void WriteSynchronously(const char* text, uint64_t length);
+    static void EnterPanicMode();
+    static uint64_t ReadRecord(char* buffer, uint64_t count, uint64_t& sequence, Error& error);
+private:
+    static void VLog(LogLevel level, const char* format, va_list args);
+    static void DrainThread(void*);
+};
@@ -2,12 +2,41 @@
 
 #include <stdint.h>
 
+// Locks of the same class share one entry in the lock statistics
+enum class LockClass : uint8_t
+{
+    Unclassified,
+    TaskQueue,
+    PageFrameBitmap,
+    Slab,
+    PermanentAllocator,
+    PagingManager,
+    IRQ,
+    IOAPIC,
+    WorkQueue,
+    Terminal,
+    TerminalOutput,
+    Keyboard,
+    LogDrain,
+    AllocationProfiler,
+    Count
+};
+
+// Interrupts are disabled on the local core while the lock is held,
+// so an interrupt handler can never spin on a lock that its own core holds
 class Spinlock
 {
 public:
     void Acquire();
     void Release();
+    explicit constexpr Spinlock(LockClass lockClass = LockClass::Unclassified) : lockClass(lockClass) {}
 private:
-    uint32_t nextTicket;
-    uint32_t servingTicket;
-};
\ No newline at end of file
+    uint32_t nextTicket = 0;
+    uint32_t servingTicket = 0;
+    uint64_t savedFlags = 0;
+    LockClass lockClass;
+#ifdef LOCK_STATISTICS
+    uint64_t acquiredTimestamp = 0;
+    uintptr_t acquiredCaller = 0;
+#endif
+};
@@ -29,6 +29,11 @@ enum class SystemCallType
     ReadDirectory = 21,
     GetFileDescriptorFlags = 22,
     CreateDirectory = 23,
+    SetTerminalReadPolicy = 24,
+    Control = 25,
+    DescriptorMap = 26,
+    GetResourceUsage = 27,
+    Yield = 28,
     Panic = 254,
     Log = 255
 };
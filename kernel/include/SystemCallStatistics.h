@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+#include "TextWriter.h"
+
+// Counts the system calls of every type per core. Like the interrupt counts, each core only updates its own
+// counters, with interrupts disabled.
+class SystemCallStatistics
+{
+public:
+    static void Record(uint64_t type);
+    static void Report(TextWriter& writer); // One line per type that was called, the total then a column per core
+};
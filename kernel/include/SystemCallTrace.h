@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+struct SystemCallTraceRecord
+{
+    uint64_t pid;
+    uint64_t type;
+    uint64_t arguments[3];
+    int64_t returnValue; // Negative error number when the call failed
+    uint64_t startTimestamp; // TSC ticks
+    uint64_t latency; // TSC ticks from entry to return, including any time spent blocked
+    uint32_t coreId; // Core the call returned on
+    uint32_t reserved;
+};
+
+// System calls of traced tasks are recorded into per-core rings, which are read through /dev/systrace
+class SystemCallTrace
+{
+public:
+    static void Record(const SystemCallTraceRecord& record);
+    static uint64_t Read(SystemCallTraceRecord* buffer, uint64_t maxCount, uint64_t& sequence);
+    static uint64_t GetNextSequence();
+};
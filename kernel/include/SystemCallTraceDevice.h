@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Device.h"
+
+enum class SystemCallTraceRequest
+{
+    SetTraced = 0x5400 // Argument: pointer to a SystemCallTraceControl
+};
+
+struct SystemCallTraceControl
+{
+    uint64_t pid;
+    uint64_t enabled;
+};
+
+// Reads return SystemCallTraceRecords, the file offset is the sequence of the next record
+class SystemCallTraceDevice : public Device
+{
+public:
+    uint64_t Write(const void* buffer, uint64_t count, uint64_t position) override;
+    uint64_t ReadStream(void* buffer, uint64_t count, uint64_t& sequence, bool nonBlocking, Error& error) override;
+    uint64_t GetStreamStart() override;
+    uint64_t Control(uint64_t request, void* argument, Error& error) override;
+    SystemCallTraceDevice(const String& name, uint32_t inodeNum);
+};
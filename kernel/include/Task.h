@@ -33,6 +33,40 @@ struct InterruptFrame
     uint64_t ss;
 } __attribute__((packed));
 
+constexpr uint64_t TASK_NAME_SIZE = 16;
+
+// What a task consumed, times are in timestamp counter ticks
+struct TaskUsage
+{
+    uint64_t userTime = 0;
+    uint64_t systemTime = 0;
+    uint64_t voluntarySwitchCount = 0; // Switched out because it blocked
+    uint64_t involuntarySwitchCount = 0; // Switched out because its time slice ended
+    uint64_t peakUserPageCount = 0;
+
+    // Like Linux's usage of children, sums everything but the peak, which is the largest one
+    void Add(const TaskUsage& other)
+    {
+        userTime += other.userTime;
+        systemTime += other.systemTime;
+        voluntarySwitchCount += other.voluntarySwitchCount;
+        involuntarySwitchCount += other.involuntarySwitchCount;
+        if (other.peakUserPageCount > peakUserPageCount) peakUserPageCount = other.peakUserPageCount;
+    }
+};
+
+// Layout shared with userspace, which turns it into a struct rusage
+struct ResourceUsage
+{
+    uint64_t userMicroseconds;
+    uint64_t systemMicroseconds;
+    uint64_t peakResidentKilobytes;
+    uint64_t minorFaultCount;
+    uint64_t majorFaultCount;
+    uint64_t voluntarySwitchCount;
+    uint64_t involuntarySwitchCount;
+};
+
 enum class TaskState
 {
     Normal, Blocked, Terminated, WaitingForChild
@@ -48,6 +82,17 @@ struct Task
     void* taskControlBlock = nullptr;
     void* syscallStackAddr = nullptr;
     uint64_t suspensionArg = 0;
+    uint64_t suspensionId = 0; // Incremented after every suspension so that stale wakeups can be ignored
+    int64_t pinnedCore = -1; // Core this task must run on, or -1 if it can run on any core
+    bool traced = false; // Whether system calls are recorded by SystemCallTrace
+    char name[TASK_NAME_SIZE] {}; // Basename of the executable, truncated like Linux's comm
+
+    // Accounting, timestamps are in timestamp counter ticks
+    uint64_t startTimestamp = 0;
+    uint64_t accountedTimestamp = 0; // Time up to which the task's time has been added to its usage
+    uint32_t lastCoreId = 0;
+    TaskUsage usage; // The peak page count only covers address spaces replaced by Execute
+    TaskUsage childrenUsage; // Of the children that were waited for, and their own children
 
     VFS* vfs = nullptr;
     PagingManager* pagingManager = nullptr;
@@ -57,6 +102,16 @@ struct Task
     TaskState state;
     int exitStatus = 0;
 
+    void SetName(const char* newName)
+    {
+        uint64_t i = 0;
+        for (; newName[i] != '\0' && i < TASK_NAME_SIZE - 1; ++i)
+        {
+            name[i] = newName[i];
+        }
+        name[i] = '\0';
+    }
+
     void FreeResources()
     {
         delete vfs;
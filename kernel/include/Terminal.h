@@ -2,6 +2,7 @@
 
 #include "Device.h"
 #include "PSF2.h"
+#include "Spinlock.h"
 #include "TextRenderer.h"
 #include "Vector.h"
 
@@ -24,6 +25,10 @@ private:
     void EraseRangeInclusive(long minX, long minY, long maxX, long maxY);
     void EraseScreenFrom(long x, long y);
 
+    // Keyboard echo comes from a work queue worker while processes write from other cores,
+    // and both move the cursor and parse escape sequences in the state below
+    Spinlock lock {LockClass::TerminalOutput};
+
     TextRenderer* textRenderer;
     Vector<uint64_t> unblockQueue;
 
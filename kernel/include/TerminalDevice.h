@@ -4,6 +4,7 @@
 #include "Device.h"
 #include "Vector.h"
 #include "Terminal.h"
+#include "Spinlock.h"
 
 class TerminalDevice : public Device
 {
@@ -11,21 +12,36 @@ public:
     uint64_t Read(void* buffer, uint64_t count, uint64_t position) override;
     uint64_t Write(const void* buffer, uint64_t count, uint64_t position) override;
     void KeyboardInput(char c);
+    void SetMode(bool newCanonical, bool newEcho);
+    void SetReadPolicy(uint8_t newMinimumReadCount, uint8_t newReadTimeout);
     TerminalDevice(const String& name, uint32_t inodeNum);
     WindowSize GetWindowSize();
     static TerminalDevice* instance;
-    bool canonical;
-    bool echo;
 private:
     struct ReadRequest;
-    Vector<Vector<char>> lines;
-    Vector<char> rawBuffer;
+
+    uint64_t CopyInput(char* buffer, uint64_t count);
+    void WakeReaders();
+
+    // Input is stored in a ring buffer indexed by ever-increasing positions:
+    // [readIndex, commitIndex) can be read, [commitIndex, editIndex) is the line being edited in canonical mode.
+    char* inputBuffer;
+    uint64_t readIndex = 0;
+    uint64_t commitIndex = 0;
+    uint64_t editIndex = 0;
+
+    bool canonical;
+    bool echo;
+    uint8_t minimumReadCount; // VMIN
+    uint8_t readTimeout; // VTIME, in tenths of a second
+
     Vector<ReadRequest> unblockQueue;
+    Spinlock lock {LockClass::Terminal};
     Terminal* terminal;
 };
 
 struct TerminalDevice::ReadRequest
 {
     uint64_t pid;
-    uint64_t requestedCount;
-};
\ No newline at end of file
+    uint64_t suspensionId;
+};
@@ -15,4 +15,5 @@ public:
     ~TextRenderer();
 private:
     PSF2* font;
+    bool IsOnScreen(long x, long y);
 };
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+
+// Writes the part of a generated text that falls in [position, position + count) into a read buffer,
+// so that files whose contents are generated on each read can be read in pieces.
+class TextWriter
+{
+public:
+    void Write(char c);
+    void Write(const char* string);
+    void WriteDecimal(uint64_t number, uint64_t width = 0);
+    void WriteHex(uint64_t number);
+    void Pad(uint64_t column); // Writes spaces up to the column, counted from the last newline
+    uint64_t GetWrittenCount() const;
+    TextWriter(char* buffer, uint64_t count, uint64_t position);
+private:
+    char* buffer;
+    uint64_t count;
+    uint64_t position;
+    uint64_t textLength = 0;
+    uint64_t lineStart = 0;
+};
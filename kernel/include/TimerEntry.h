@@ -8,4 +8,5 @@ struct TimerEntry
 
     bool unblockOnExpire = false;
     uint64_t pid = 0;
+    uint64_t suspensionId = 0;
 };
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include "CPU.h"
+
+// Keep in sync with EVENT_NAMES in tools/trace2json.py
+enum class TraceEvent : uint16_t
+{
+    TaskSwitch = 0, // Arguments: previous pid, next pid
+    TaskBlock = 1, // Arguments: task state, timeout in milliseconds
+    TaskWakeup = 2, // Arguments: pid, value returned to the task
+    PageMap = 3, // Arguments: virtual address, physical address
+    AddressSpaceCopy = 4, // Arguments: new PML4, original PML4 (physical). Has a duration.
+    PageFault = 5, // Arguments: faulting address, instruction pointer
+    FileOpen = 6, // Arguments: descriptor, inode
+    FileRead = 7, // Arguments: inode, byte count. Has a duration.
+    FileWrite = 8, // Arguments: inode, byte count. Has a duration.
+    Ext2Read = 9, // Arguments: block, byte count. Has a duration.
+    Ext2Write = 10 // Arguments: block, byte count. Has a duration.
+};
+
+struct TraceRecord
+{
+    uint64_t timestamp; // TSC ticks
+    uint64_t duration; // TSC ticks, 0 for events without a duration
+    uint64_t arguments[2];
+    uint32_t pid;
+    uint16_t event;
+    uint16_t coreId;
+};
+
+class Trace
+{
+public:
+    static void Record(TraceEvent event, uint64_t start, uint64_t argument0, uint64_t argument1);
+    static uint64_t Read(TraceRecord* buffer, uint64_t maxCount, uint64_t& sequence);
+    static void DumpToDebugPort();
+
+    // Bit n enables the event with value n, every event is disabled at boot
+    static uint64_t enabledEvents;
+};
+
+// A disabled tracepoint costs one load and one predicted branch. Build with -DTRACEPOINTS_DISABLED to remove them.
+#ifndef TRACEPOINTS_DISABLED
+#define TraceEnabled(event) __builtin_expect(Trace::enabledEvents & (1ull << static_cast<int>(TraceEvent::event)), 0)
+#define TracePoint(event, argument0, argument1) \
+    do { if (TraceEnabled(event)) Trace::Record(TraceEvent::event, 0, argument0, argument1); } while (false)
+
+// TraceBegin returns 0 when the event is disabled, TraceEnd then records nothing
+#define TraceBegin(event) (TraceEnabled(event) ? CPU::ReadTimestampCounter() : 0)
+#define TraceEnd(event, start, argument0, argument1) \
+    do { if (__builtin_expect((start) != 0, 0)) Trace::Record(TraceEvent::event, start, argument0, argument1); } while (false)
+#else
+#define TracePoint(event, argument0, argument1) do { (void)(argument0); (void)(argument1); } while (false)
+#define TraceBegin(event) 0
+#define TraceEnd(event, start, argument0, argument1) \
+    do { (void)(start); (void)(argument0); (void)(argument1); } while (false)
+#endif
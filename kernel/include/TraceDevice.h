@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Device.h"
+
+enum class TraceRequest
+{
+    SetEnabledEvents = 0x5401, // Argument: pointer to a uint64_t mask, bit n enables TraceEvent n
+    DumpToDebugPort = 0x5402 // Argument: none
+};
+
+// Reads return TraceRecords, the file offset is the sequence of the next record
+class TraceDevice : public Device
+{
+public:
+    uint64_t Write(const void* buffer, uint64_t count, uint64_t position) override;
+    uint64_t ReadStream(void* buffer, uint64_t count, uint64_t& sequence, bool nonBlocking, Error& error) override;
+    uint64_t Control(uint64_t request, void* argument, Error& error) override;
+    TraceDevice(const String& name, uint32_t inodeNum);
+};
@@ -31,6 +31,8 @@ public:
     uint64_t RepositionOffset(int descriptor, int64_t offset, SeekType seekType);
     void Close(int descriptor, Error& error);
     void Close(int descriptor);
+    uint64_t Control(int descriptor, uint64_t request, void* argument, Error& error);
+    void* Map(int descriptor, void* addr, uint64_t length, Error& error);
     void OnExecute();
 
     VnodeInfo GetVnodeInfo(int descriptor, Error& error);
@@ -38,6 +40,7 @@ public:
     FileDescriptorFlags GetFileDescriptorFlags(int descriptor, Error& error);
     void SetFileDescriptorFlags(int descriptor, const FileDescriptorFlags& flags, Error& error);
     void SetTerminalSettings(int descriptor, bool canonical, bool echo, Error& error);
+    void SetTerminalReadPolicy(int descriptor, uint8_t minimumCount, uint8_t timeout, Error& error);
     WindowSize GetTerminalWindowSize(int descriptor, Error& error);
     String GetWorkingDirectory();
     void SetWorkingDirectory(const String& newWorkingDirectory, Error& error);
@@ -78,6 +81,13 @@ enum class VFS::VnodeType
     SymbolicLink = 5,
     Keyboard = 6,
     Random = 7,
+    Kmsg = 8,
+    SystemCallTrace = 9,
+    Trace = 10,
+    Profile = 11,
+    // Text that is generated again on every read, like /proc and the statistics devices. It has no size,
+    // so writes neither fill up to nor move the offset. Userspace sees a regular file.
+    GeneratedFile = 12,
 };
 
 struct VFS::Vnode
@@ -107,6 +117,7 @@ struct VFS::FileDescriptorFlags
     bool readMode = false;
     bool writeMode = false;
     bool closeOnExecute = false;
+    bool nonBlocking = false;
 };
 
 struct VFS::FileHandle
@@ -136,6 +147,7 @@ enum VFS::OpenFlag : int
     WriteOnly = 0x5,
     ReadWrite = 0x3,
     DirectoryMode = 0x20,
+    NonBlocking = 0x400,
     CloseOnExecute = 0x4000,
 };
 
@@ -152,14 +152,14 @@ const T* Vector<T>::end() const
 template <typename T>
 T& Vector<T>::Get(uint64_t index)
 {
-    Assert(index < GetLength());
+    DebugAssert(index < GetLength());
     return buffer[index];
 }
 
 template <typename T>
 const T& Vector<T>::Get(uint64_t index) const
 {
-    Assert(index < GetLength());
+    DebugAssert(index < GetLength());
     return buffer[index];
 }
 
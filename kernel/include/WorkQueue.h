@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+#include "Vector.h"
+#include "Spinlock.h"
+
+// Pool of kernel threads that run queued work with interrupts enabled.
+// Every core has its own pool with a single pinned worker, used to defer work out of interrupt handlers,
+// and the unbound pool has workers that can run on any core for work that can be done in parallel.
+// Work queued to a full queue is dropped, since the interrupt handlers that queue it can't wait for room.
+class WorkQueue
+{
+public:
+    typedef void (*Function)(uint64_t argument);
+
+    void Queue(Function function, uint64_t argument);
+    static void QueueLocal(Function function, uint64_t argument);
+    static void QueueUnbound(Function function, uint64_t argument);
+    WorkQueue(uint64_t workerCount, int64_t pinnedCore);
+private:
+    struct Item
+    {
+        Function function;
+        uint64_t argument;
+    };
+
+    struct WaitingWorker
+    {
+        uint64_t pid;
+        uint64_t suspensionId;
+    };
+
+    static void RunWorker(void* workQueue);
+
+    Item* items;
+    uint64_t readIndex = 0;
+    uint64_t writeIndex = 0;
+    uint64_t droppedCount = 0;
+    Vector<WaitingWorker> waitingWorkers;
+    Spinlock lock {LockClass::WorkQueue};
+
+    static WorkQueue* unbound;
+};
@@ -0,0 +1,132 @@
+#include "ACPI.h"
+#include "Stivale2Interface.h"
+#include "Memory/Memory.h"
+#include "Serial.h"
+
+struct RSDP
+{
+    char signature[8];
+    uint8_t checksum;
+    char oemId[6];
+    uint8_t revision;
+    uint32_t rsdtAddress;
+
+    // Only present from revision 2
+    uint32_t length;
+    uint64_t xsdtAddress;
+    uint8_t extendedChecksum;
+    uint8_t reserved[3];
+} __attribute__((packed));
+
+struct MADTEntryHeader
+{
+    uint8_t type;
+    uint8_t length;
+} __attribute__((packed));
+
+struct MADTIOAPICEntry
+{
+    MADTEntryHeader header;
+    uint8_t id;
+    uint8_t reserved;
+    uint32_t address;
+    uint32_t gsiBase;
+} __attribute__((packed));
+
+struct MADTInterruptOverrideEntry
+{
+    MADTEntryHeader header;
+    uint8_t bus;
+    uint8_t source;
+    uint32_t gsi;
+    uint16_t flags;
+} __attribute__((packed));
+
+constexpr uint64_t MADT_ENTRIES_OFFSET = sizeof(ACPITableHeader) + 8;
+constexpr uint8_t MADT_IOAPIC = 1;
+constexpr uint8_t MADT_INTERRUPT_OVERRIDE = 2;
+
+const ACPITableHeader* rootTable;
+bool rootTableIsExtended;
+Vector<MADTIOAPIC>* ioapics;
+Vector<MADTInterruptOverride>* interruptOverrides;
+
+void ACPI::Initialize()
+{
+    auto rsdpTag = static_cast<stivale2_struct_tag_rsdp*>(GetStivale2Tag(STIVALE2_STRUCT_TAG_RSDP_ID));
+    Assert(rsdpTag != nullptr);
+
+    auto rsdp = reinterpret_cast<const RSDP*>(rsdpTag->rsdp);
+    rootTableIsExtended = rsdp->revision >= 2 && rsdp->xsdtAddress != 0;
+    uintptr_t rootTableAddress = rootTableIsExtended ? rsdp->xsdtAddress : rsdp->rsdtAddress;
+    rootTable = reinterpret_cast<const ACPITableHeader*>(HigherHalf(rootTableAddress));
+
+    ioapics = new Vector<MADTIOAPIC>();
+    interruptOverrides = new Vector<MADTInterruptOverride>();
+
+    const ACPITableHeader* madt = FindTable("APIC");
+    Assert(madt != nullptr);
+    ParseMADT(madt);
+
+    Serial::Log("ACPI: %d IOAPIC(s), %d interrupt override(s)", ioapics->GetLength(), interruptOverrides->GetLength());
+}
+
+const ACPITableHeader* ACPI::FindTable(const char* signature)
+{
+    // The XSDT holds 64-bit table addresses and the RSDT 32-bit ones, neither of which are aligned
+    uint64_t entrySize = rootTableIsExtended ? 8 : 4;
+    uint64_t entryCount = (rootTable->length - sizeof(ACPITableHeader)) / entrySize;
+    auto entries = reinterpret_cast<const uint8_t*>(rootTable) + sizeof(ACPITableHeader);
+
+    for (uint64_t i = 0; i < entryCount; ++i)
+    {
+        uint64_t address = 0;
+        memcpy(&address, entries + i * entrySize, entrySize);
+
+        auto table = reinterpret_cast<const ACPITableHeader*>(HigherHalf(address));
+        if (table->signature[0] == signature[0] && table->signature[1] == signature[1] &&
+            table->signature[2] == signature[2] && table->signature[3] == signature[3])
+        {
+            return table;
+        }
+    }
+
+    return nullptr;
+}
+
+const Vector<MADTIOAPIC>& ACPI::GetIOAPICs()
+{
+    return *ioapics;
+}
+
+const Vector<MADTInterruptOverride>& ACPI::GetInterruptOverrides()
+{
+    return *interruptOverrides;
+}
+
+void ACPI::ParseMADT(const ACPITableHeader* madt)
+{
+    auto madtBase = reinterpret_cast<const uint8_t*>(madt);
+    for (uint64_t offset = MADT_ENTRIES_OFFSET; offset < madt->length; )
+    {
+        auto header = reinterpret_cast<const MADTEntryHeader*>(madtBase + offset);
+        Assert(header->length != 0);
+
+        if (header->type == MADT_IOAPIC)
+        {
+            auto entry = reinterpret_cast<const MADTIOAPICEntry*>(header);
+            ioapics->Push({entry->id, entry->address, entry->gsiBase});
+        }
+        else if (header->type == MADT_INTERRUPT_OVERRIDE)
+        {
+            auto entry = reinterpret_cast<const MADTInterruptOverrideEntry*>(header);
+
+            // Bits 0..1: Polarity, 0b11 is active low. Bits 2..3: Trigger mode, 0b11 is level triggered.
+            bool activeLow = (entry->flags & 0b11) == 0b11;
+            bool levelTriggered = ((entry->flags >> 2) & 0b11) == 0b11;
+            interruptOverrides->Push({entry->source, entry->gsi, activeLow, levelTriggered});
+        }
+
+        offset += header->length;
+    }
+}
@@ -0,0 +1,178 @@
+#include "AllocationProfiler.h"
+#include "Spinlock.h"
+#include "Serial.h"
+#include "CPU.h"
+
+constexpr uint64_t ALLOCATION_SITE_COUNT = 1024;
+constexpr uint64_t ALLOCATION_TAG_ARRAY_COUNT = 16;
+constexpr uint64_t TASK_REPORT_SITE_COUNT = 10;
+
+struct AllocationSite
+{
+    uintptr_t caller;
+    AllocationKind kind;
+    uint64_t liveBytes;
+    uint64_t peakBytes;
+    uint64_t allocationCount;
+    uint64_t freeCount;
+};
+
+struct AllocationTagArray
+{
+    const AllocationTag* tags;
+    uint64_t count;
+    uint64_t unitSize;
+};
+
+const char* allocationKindNames[] = {"slab", "permanent", "page frame"};
+
+// Open addressing on the caller, index 0 is never used so that it can mean "no site" in tags
+AllocationSite allocationSites[ALLOCATION_SITE_COUNT];
+AllocationTagArray allocationTagArrays[ALLOCATION_TAG_ARRAY_COUNT];
+uint64_t allocationTagArrayCount = 0;
+
+// Only used while reporting on a task, under the lock
+uint64_t taskSiteBytes[ALLOCATION_SITE_COUNT];
+uint64_t taskSiteCounts[ALLOCATION_SITE_COUNT];
+
+Spinlock allocationProfilerLock {LockClass::AllocationProfiler};
+
+uint32_t AllocationProfiler::RecordAllocation(AllocationKind kind, uintptr_t caller, uint64_t size)
+{
+    allocationProfilerLock.Acquire();
+
+    uint64_t hash = (caller >> 2) ^ static_cast<uint64_t>(kind);
+    uint32_t site = 0;
+    for (uint64_t probe = 0; probe < ALLOCATION_SITE_COUNT - 1; ++probe)
+    {
+        uint32_t index = 1 + (hash + probe) % (ALLOCATION_SITE_COUNT - 1);
+        AllocationSite& candidate = allocationSites[index];
+
+        if (candidate.caller == 0)
+        {
+            candidate.caller = caller;
+            candidate.kind = kind;
+        }
+
+        if (candidate.caller == caller && candidate.kind == kind)
+        {
+            site = index;
+            break;
+        }
+    }
+
+    Assert(site != 0);
+
+    AllocationSite& allocationSite = allocationSites[site];
+    allocationSite.allocationCount++;
+    allocationSite.liveBytes += size;
+    if (allocationSite.liveBytes > allocationSite.peakBytes) allocationSite.peakBytes = allocationSite.liveBytes;
+
+    allocationProfilerLock.Release();
+    return site;
+}
+
+void AllocationProfiler::RecordFree(uint32_t site, uint64_t size)
+{
+    allocationProfilerLock.Acquire();
+
+    AllocationSite& allocationSite = allocationSites[site];
+    allocationSite.freeCount++;
+    allocationSite.liveBytes -= size;
+
+    allocationProfilerLock.Release();
+}
+
+void AllocationProfiler::RegisterTags(const AllocationTag* tags, uint64_t count, uint64_t unitSize)
+{
+    allocationProfilerLock.Acquire();
+
+    Assert(allocationTagArrayCount < ALLOCATION_TAG_ARRAY_COUNT);
+    allocationTagArrays[allocationTagArrayCount++] = {tags, count, unitSize};
+
+    allocationProfilerLock.Release();
+}
+
+uint32_t AllocationProfiler::GetCurrentPid()
+{
+    uint32_t coreId = CPU::GetCoreID();
+    return CPU::IsCoreOnline(coreId) ? CPU::GetStruct(coreId).scheduler->currentTask.pid : 0;
+}
+
+// Logs the call sites of the slab slots and page frames that the task allocated and that are still in use,
+// largest first. Page frames are never given back, so they always show up.
+void AllocationProfiler::ReportTaskAllocations(uint64_t pid)
+{
+#ifdef ALLOCATION_PROFILING
+    allocationProfilerLock.Acquire();
+
+    for (uint64_t site = 0; site < ALLOCATION_SITE_COUNT; ++site)
+    {
+        taskSiteBytes[site] = 0;
+        taskSiteCounts[site] = 0;
+    }
+
+    for (uint64_t i = 0; i < allocationTagArrayCount; ++i)
+    {
+        const AllocationTagArray& tagArray = allocationTagArrays[i];
+        for (uint64_t tagIndex = 0; tagIndex < tagArray.count; ++tagIndex)
+        {
+            const AllocationTag& tag = tagArray.tags[tagIndex];
+            if (tag.site == 0 || tag.pid != pid) continue;
+
+            taskSiteBytes[tag.site] += tagArray.unitSize;
+            taskSiteCounts[tag.site]++;
+        }
+    }
+
+    for (uint64_t reported = 0; reported < TASK_REPORT_SITE_COUNT; ++reported)
+    {
+        uint64_t largest = 0;
+        for (uint64_t site = 1; site < ALLOCATION_SITE_COUNT; ++site)
+        {
+            if (taskSiteBytes[site] > taskSiteBytes[largest]) largest = site;
+        }
+
+        if (taskSiteBytes[largest] == 0) break;
+
+        const AllocationSite& allocationSite = allocationSites[largest];
+        Serial::Log("Task %d still holds %d bytes in %d %s allocations from %x", pid, taskSiteBytes[largest],
+                    taskSiteCounts[largest], allocationKindNames[static_cast<uint64_t>(allocationSite.kind)], allocationSite.caller);
+        taskSiteBytes[largest] = 0;
+    }
+
+    allocationProfilerLock.Release();
+#else
+    (void)pid;
+#endif
+}
+
+// One line per call site, callers are return addresses into the code that called the allocator
+void AllocationProfiler::Report(TextWriter& writer)
+{
+#ifdef ALLOCATION_PROFILING
+    writer.Write("allocator");
+    writer.Pad(12);
+    writer.Write("caller");
+    writer.Pad(28);
+    writer.Write("      live bytes      peak bytes     allocations           frees\n");
+
+    for (uint64_t site = 1; site < ALLOCATION_SITE_COUNT; ++site)
+    {
+        const AllocationSite& allocationSite = allocationSites[site];
+        if (allocationSite.caller == 0) continue;
+
+        writer.Write(allocationKindNames[static_cast<uint64_t>(allocationSite.kind)]);
+        writer.Pad(12);
+        writer.WriteHex(allocationSite.caller);
+        writer.Pad(28);
+        writer.WriteDecimal(allocationSite.liveBytes, 16);
+        writer.WriteDecimal(allocationSite.peakBytes, 16);
+        writer.WriteDecimal(allocationSite.allocationCount, 16);
+        writer.WriteDecimal(allocationSite.freeCount, 16);
+        writer.Write('\n');
+    }
+#else
+    writer.Write("Allocations are not profiled, build the kernel with -DALLOCATION_PROFILING\n");
+#endif
+}
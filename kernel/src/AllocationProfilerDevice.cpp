@@ -0,0 +1,18 @@
+#include "AllocationProfilerDevice.h"
+#include "AllocationProfiler.h"
+
+uint64_t AllocationProfilerDevice::Read(void* buffer, uint64_t count, uint64_t position)
+{
+    TextWriter writer(static_cast<char*>(buffer), count, position);
+    AllocationProfiler::Report(writer);
+    return writer.GetWrittenCount();
+}
+
+uint64_t AllocationProfilerDevice::Write(const void* buffer, uint64_t count, uint64_t position)
+{
+    (void)buffer;
+    (void)position;
+    return count;
+}
+
+AllocationProfilerDevice::AllocationProfilerDevice(const String& name, uint32_t inodeNum) : Device(name, inodeNum) {}
@@ -1,19 +1,27 @@
 #include "Assert.h"
 #include "Serial.h"
+#include "Trace.h"
 
 [[noreturn]] void KernelPanic(const char* assertion, const char* file, unsigned int line, const char* function)
 {
     asm volatile("cli");
-    Serial::Log("! KERNEL PANIC !");
+    Serial::EnterPanicMode();
+    Serial::Log(LogLevel::Error, "! KERNEL PANIC !");
 
-    Serial::Log("%s", assertion);
-    Serial::Log("%s: line: %d", file, line);
-    Serial::Log("Function: %s", function);
+    Serial::Log(LogLevel::Error, "%s", assertion);
+    Serial::Log(LogLevel::Error, "%s: line: %d", file, line);
+    Serial::Log(LogLevel::Error, "Function: %s", function);
+    Serial::Flush();
+
+    // Whatever was being traced led up to the panic. Other cores stop recording so they don't overwrite
+    // the records while they are dumped, which goes around drainLock like the rest of the panic output.
+    uint64_t tracedEvents = __atomic_exchange_n(&Trace::enabledEvents, 0, __ATOMIC_ACQ_REL);
+    if (tracedEvents != 0) Trace::DumpToDebugPort();
 
     while (true) asm("hlt");
 }
 
 void KernelWarn(const char* message, const char* file, unsigned int line)
 {
-    Serial::Log("\033[93m[WARNING] %s:%d -> %s\033[39m", file, line, message);
+    Serial::Log(LogLevel::Warning, "\033[93m[WARNING] %s:%d -> %s\033[39m", file, line, message);
 }
\ No newline at end of file
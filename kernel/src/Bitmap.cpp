@@ -10,7 +10,7 @@ Bitmap::Bitmap(uint8_t* buffer, uint64_t size, bool leastSignificantFirst) :
 bool Bitmap::GetBit(uint64_t index) const
 {
     uint64_t byteIndex = index / 8;
-    Assert(byteIndex < size);
+    DebugAssert(byteIndex < size);
 
     uint8_t bitIndex = leastSignificantFirst ? 1 << (7 - (index % 8)) : 1 << (index % 8);
     return (buffer[byteIndex] & bitIndex);
@@ -19,7 +19,7 @@ bool Bitmap::GetBit(uint64_t index) const
 void Bitmap::SetBit(uint64_t index, bool value) const
 {
     uint64_t byteIndex = index / 8;
-    Assert(byteIndex < size);
+    DebugAssert(byteIndex < size);
 
     uint8_t bitIndex = leastSignificantFirst ? 1 << (7 - index % 8) : 1 << (index % 8);
     if (value)
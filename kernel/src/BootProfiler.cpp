@@ -0,0 +1,172 @@
+#include "BootProfiler.h"
+#include "CPU.h"
+#include "Serial.h"
+#include "PerCoreRing.h"
+
+// Every BSP phase once, and the AP phases once per core
+constexpr uint64_t MAX_RECORD_COUNT = static_cast<uint64_t>(BootPhase::Count) + 3 * PER_CORE_RING_MAX_CORES;
+constexpr uint64_t LINE_SIZE = 128;
+
+const char* bootPhaseNames[static_cast<uint64_t>(BootPhase::Count)] =
+{
+    "firmware",
+    "page_frame_allocator",
+    "heap",
+    "descriptor_tables",
+    "interrupt_controllers",
+    "framebuffer",
+    "vfs",
+    "font",
+    "init_task",
+    "start_cores",
+    "timer_calibration",
+    "core_wakeup",
+    "core_bring_up",
+    "total"
+};
+
+struct BootPhaseRecord
+{
+    BootPhase phase;
+    uint32_t coreId;
+    uint64_t startTimestamp;
+    uint64_t endTimestamp;
+};
+
+uint64_t kernelEntryTimestamp = 0;
+BootPhaseRecord bootPhaseRecords[MAX_RECORD_COUNT];
+uint64_t bootPhaseRecordCount = 0;
+uint32_t finishedCoreCount = 0;
+bool bootFinished = false; // Set once the records are sorted, nothing is recorded after it
+
+uint64_t CyclesToMicroseconds(uint64_t cycles)
+{
+    uint64_t frequency = CPU::GetTimestampCounterFrequency();
+    return frequency == 0 ? 0 : cycles * 1'000'000 / frequency;
+}
+
+uint64_t GetRecordCount()
+{
+    uint64_t count = __atomic_load_n(&bootPhaseRecordCount, __ATOMIC_ACQUIRE);
+    return count < MAX_RECORD_COUNT ? count : MAX_RECORD_COUNT;
+}
+
+// Sorts by core then start, so that a phase is followed by the phases nested in it
+void SortRecords(uint64_t count)
+{
+    for (uint64_t i = 1; i < count; ++i)
+    {
+        BootPhaseRecord record = bootPhaseRecords[i];
+        uint64_t j = i;
+        for (; j > 0; --j)
+        {
+            const BootPhaseRecord& previous = bootPhaseRecords[j - 1];
+            bool before = previous.coreId < record.coreId ||
+                          (previous.coreId == record.coreId && previous.startTimestamp <= record.startTimestamp);
+            if (before) break;
+            bootPhaseRecords[j] = previous;
+        }
+        bootPhaseRecords[j] = record;
+    }
+}
+
+// A phase nested in an earlier one on the same core is indented under it
+void WriteRecord(TextWriter& writer, uint64_t index)
+{
+    const BootPhaseRecord& record = bootPhaseRecords[index];
+
+    writer.Write("boot ");
+    for (uint64_t i = 0; i < index; ++i)
+    {
+        const BootPhaseRecord& outer = bootPhaseRecords[i];
+        if (outer.coreId == record.coreId && outer.endTimestamp >= record.endTimestamp && outer.phase != BootPhase::Total)
+        {
+            writer.Write("  ");
+        }
+    }
+    writer.Write(bootPhaseNames[static_cast<uint64_t>(record.phase)]);
+    writer.Pad(32);
+    writer.Write("core=");
+    writer.WriteDecimal(record.coreId, 2);
+    writer.Write(" start_us=");
+    writer.WriteDecimal(CyclesToMicroseconds(record.startTimestamp), 9);
+    writer.Write(" us=");
+    writer.WriteDecimal(CyclesToMicroseconds(record.endTimestamp - record.startTimestamp), 9);
+    writer.Write(" cycles=");
+    writer.WriteDecimal(record.endTimestamp - record.startTimestamp);
+}
+
+void BootProfiler::Start()
+{
+    kernelEntryTimestamp = CPU::ReadTimestampCounter();
+    Record(BootPhase::Firmware, 0);
+}
+
+void BootProfiler::Record(BootPhase phase, uint64_t startTimestamp)
+{
+    uint64_t endTimestamp = CPU::ReadTimestampCounter();
+    if (__atomic_load_n(&bootFinished, __ATOMIC_ACQUIRE)) return;
+
+    // A start taken on another core's TSC can be ahead of this one's if they aren't synchronized
+    if (startTimestamp > endTimestamp) startTimestamp = endTimestamp;
+
+    // The cores record concurrently while they come up, and once the table is full the rest is dropped
+    uint64_t index = __atomic_fetch_add(&bootPhaseRecordCount, 1, __ATOMIC_RELAXED);
+    if (index >= MAX_RECORD_COUNT) return;
+
+    bootPhaseRecords[index] = {phase, CPU::GetCoreID(), startTimestamp, endTimestamp};
+}
+
+void BootProfiler::FinishCore()
+{
+    if (__atomic_add_fetch(&finishedCoreCount, 1, __ATOMIC_ACQ_REL) != CPU::GetCoreCount()) return;
+
+    Record(BootPhase::Total, kernelEntryTimestamp);
+
+    // Every core is past its last phase, so nothing writes the records anymore
+    uint64_t count = GetRecordCount();
+    SortRecords(count);
+    __atomic_store_n(&bootFinished, true, __ATOMIC_RELEASE);
+
+    // Written out directly, the table can be longer than a core's log ring
+    Serial::LogSynchronously("Boot phases, starts are microseconds since the TSC was reset:");
+    Serial::LogSynchronously("(core_wakeup starts on the BSP's TSC, so it assumes the cores' TSCs are synchronized)");
+    const BootPhaseRecord* slowest = nullptr;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        char line[LINE_SIZE];
+        TextWriter writer(line, LINE_SIZE - 1, 0);
+        WriteRecord(writer, i);
+        line[writer.GetWrittenCount()] = '\0';
+        Serial::LogSynchronously("%s", line);
+
+        // Firmware isn't the kernel's doing, and the total contains everything else
+        const BootPhaseRecord& record = bootPhaseRecords[i];
+        if (record.phase == BootPhase::Firmware || record.phase == BootPhase::Total) continue;
+        if (slowest == nullptr ||
+            record.endTimestamp - record.startTimestamp > slowest->endTimestamp - slowest->startTimestamp)
+        {
+            slowest = &record;
+        }
+    }
+
+    if (slowest != nullptr)
+    {
+        Serial::LogSynchronously("Slowest boot phase: %s on core %d, %d us",
+                                 bootPhaseNames[static_cast<uint64_t>(slowest->phase)], slowest->coreId,
+                                 CyclesToMicroseconds(slowest->endTimestamp - slowest->startTimestamp));
+    }
+}
+
+// Empty until every core is up
+void BootProfiler::Report(TextWriter& writer)
+{
+    if (!__atomic_load_n(&bootFinished, __ATOMIC_ACQUIRE)) return;
+
+    uint64_t count = GetRecordCount();
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        WriteRecord(writer, i);
+        writer.Write('\n');
+    }
+}
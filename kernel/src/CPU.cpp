@@ -1,6 +1,8 @@
 #include "CPU.h"
+#include "WorkQueue.h"
 
 Vector<CPU>* cpuList;
+uint64_t timestampCounterFrequency = 0;
 
 uint32_t CPU::GetCoreID()
 {
@@ -15,6 +17,40 @@ CPU CPU::GetStruct()
     return cpuList->Get(GetCoreID());
 }
 
+CPU CPU::GetStruct(uint32_t coreId)
+{
+    return cpuList->Get(coreId);
+}
+
+uint64_t CPU::ReadTimestampCounter()
+{
+    uint32_t low;
+    uint32_t high;
+    asm volatile("rdtsc" : "=a"(low), "=d"(high));
+    return static_cast<uint64_t>(high) << 32 | low;
+}
+
+uint64_t CPU::GetTimestampCounterFrequency()
+{
+    return timestampCounterFrequency;
+}
+
+void CPU::SetTimestampCounterFrequency(uint64_t frequency)
+{
+    timestampCounterFrequency = frequency;
+}
+
+uint32_t CPU::GetCoreCount()
+{
+    return cpuList->GetLength();
+}
+
+// The allocators ask this while the list is being built
+bool CPU::IsCoreOnline(uint32_t coreId)
+{
+    return cpuList != nullptr && coreId < cpuList->GetLength() && cpuList->Get(coreId).scheduler != nullptr;
+}
+
 void CPU::EnableSSE()
 {
     uint64_t cr4;
@@ -28,6 +64,14 @@ void CPU::EnableSSE()
     asm volatile("mov %0, %%cr4" : : "r" (cr4));
 }
 
+void CPU::InitializePAT()
+{
+    // Keep the power-on default for entries 0-3 so that existing mappings are unaffected,
+    // and make entry 4 (PAT bit set, PCD and PWT clear) write-combining for framebuffer mappings
+    uint64_t pat = 0x0007'0401'0007'0406;
+    asm volatile("wrmsr" : : "c"(0x277), "a"(pat & 0xffffffff), "d"(pat >> 32));
+}
+
 void CPU::InitializeCPUList(unsigned long cpuCount)
 {
     Assert(cpuList == nullptr);
@@ -35,7 +79,7 @@ void CPU::InitializeCPUList(unsigned long cpuCount)
     cpuList = new Vector<CPU>();
     for (uint64_t i = 0; i < cpuCount; ++i)
     {
-        cpuList->Push({nullptr});
+        cpuList->Push({nullptr, nullptr});
     }
 }
 
@@ -44,6 +88,7 @@ void CPU::InitializeCPUStruct(Scheduler* scheduler)
     uint32_t coreId = GetCoreID();
     Assert(cpuList->Get(coreId).scheduler == nullptr);
     cpuList->Get(coreId).scheduler = scheduler;
+    cpuList->Get(coreId).workQueue = new WorkQueue(1, coreId);
 }
 
 void CPU::SetTCB(const void* tcbAddr)
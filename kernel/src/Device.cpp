@@ -8,4 +8,47 @@ String Device::GetName() const
 uint32_t Device::GetInodeNumber() const
 {
     return inodeNum;
-}
\ No newline at end of file
+}
+
+uint64_t Device::Read(void* buffer, uint64_t count, uint64_t position)
+{
+    return 0;
+
+    (void)buffer;
+    (void)count;
+    (void)position;
+}
+
+uint64_t Device::ReadStream(void* buffer, uint64_t count, uint64_t& position, bool nonBlocking, Error& error)
+{
+    error = Error::InvalidArgument;
+    return 0;
+
+    (void)buffer;
+    (void)count;
+    (void)position;
+    (void)nonBlocking;
+}
+
+uint64_t Device::GetStreamStart()
+{
+    return 0;
+}
+
+uint64_t Device::Control(uint64_t request, void* argument, Error& error)
+{
+    error = Error::NotTerminal;
+    return 0;
+
+    (void)request;
+    (void)argument;
+}
+
+void* Device::Map(void* addr, uint64_t length, Error& error)
+{
+    error = Error::InvalidArgument;
+    return nullptr;
+
+    (void)addr;
+    (void)length;
+}
@@ -4,6 +4,13 @@
 #include "FramebufferDevice.h"
 #include "KeyboardDevice.h"
 #include "RandomDevice.h"
+#include "KmsgDevice.h"
+#include "SystemCallTraceDevice.h"
+#include "TraceDevice.h"
+#include "ProfilerDevice.h"
+#include "LockStatisticsDevice.h"
+#include "AllocationProfilerDevice.h"
+#include "GcovDevice.h"
 #include "Serial.h"
 #include "Heap.h"
 
@@ -26,6 +33,34 @@ DeviceFS::DeviceFS(Disk* disk) : FileSystem(disk)
     Device* random = new RandomDevice(String("urandom"), currentInodeNum++);
     devices.Push(random);
     VFS::ConstructVnode(random->GetInodeNumber(), this, random, 0, VFS::VnodeType::Random);
+
+    Device* kmsg = new KmsgDevice(String("kmsg"), currentInodeNum++);
+    devices.Push(kmsg);
+    VFS::ConstructVnode(kmsg->GetInodeNumber(), this, kmsg, 0, VFS::VnodeType::Kmsg);
+
+    Device* systemCallTrace = new SystemCallTraceDevice(String("systrace"), currentInodeNum++);
+    devices.Push(systemCallTrace);
+    VFS::ConstructVnode(systemCallTrace->GetInodeNumber(), this, systemCallTrace, 0, VFS::VnodeType::SystemCallTrace);
+
+    Device* trace = new TraceDevice(String("trace"), currentInodeNum++);
+    devices.Push(trace);
+    VFS::ConstructVnode(trace->GetInodeNumber(), this, trace, 0, VFS::VnodeType::Trace);
+
+    Device* profile = new ProfilerDevice(String("profile"), currentInodeNum++);
+    devices.Push(profile);
+    VFS::ConstructVnode(profile->GetInodeNumber(), this, profile, 0, VFS::VnodeType::Profile);
+
+    Device* lockStatistics = new LockStatisticsDevice(String("lockstat"), currentInodeNum++);
+    devices.Push(lockStatistics);
+    VFS::ConstructVnode(lockStatistics->GetInodeNumber(), this, lockStatistics, 0, VFS::VnodeType::GeneratedFile);
+
+    Device* allocationProfile = new AllocationProfilerDevice(String("allocstat"), currentInodeNum++);
+    devices.Push(allocationProfile);
+    VFS::ConstructVnode(allocationProfile->GetInodeNumber(), this, allocationProfile, 0, VFS::VnodeType::GeneratedFile);
+
+    Device* gcov = new GcovDevice(String("gcov"), currentInodeNum++);
+    devices.Push(gcov);
+    VFS::ConstructVnode(gcov->GetInodeNumber(), this, gcov, 0, VFS::VnodeType::GeneratedFile);
 }
 
 uint64_t DeviceFS::Read(VFS::Vnode* vnode, void* buffer, uint64_t count, uint64_t readPos)
@@ -40,13 +75,25 @@ uint64_t DeviceFS::Write(VFS::Vnode* vnode, const void* buffer, uint64_t count,
     return device->Write(buffer, count, writePos);
 }
 
+uint64_t DeviceFS::Control(VFS::Vnode* vnode, uint64_t request, void* argument, Error& error)
+{
+    auto device = reinterpret_cast<Device*>(vnode->context);
+    return device->Control(request, argument, error);
+}
+
+void* DeviceFS::Map(VFS::Vnode* vnode, void* addr, uint64_t length, Error& error)
+{
+    auto device = reinterpret_cast<Device*>(vnode->context);
+    return device->Map(addr, length, error);
+}
+
 VFS::Vnode* DeviceFS::FindInDirectory(VFS::Vnode* directory, const String& name)
 {
     Assert(directory == fileSystemRoot);
 
     for (Device* device : devices)
     {
-        Serial::Log("[/dev]------------- Found: %s", device->GetName().ToRawString());
+        LogDebug("[/dev]------------- Found: %s", device->GetName().ToRawString());
 
         if (device->GetName().Equals(name))
         {
@@ -85,9 +132,8 @@ VFS::Vnode* DeviceFS::Create(VFS::Vnode* directory, const String& name, VFS::Vno
     (void)vnodeType;
 }
 
+// Devices that look like regular files generate their contents, there is nothing to truncate
 void DeviceFS::Truncate(VFS::Vnode* vnode)
 {
-    Panic();
-
     (void)vnode;
 }
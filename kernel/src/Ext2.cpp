@@ -7,6 +7,7 @@
 #include "Heap.h"
 #include "Memory/Memory.h"
 #include "Math.h"
+#include "Trace.h"
 
 enum InodeTypePermissions : uint16_t
 {
@@ -122,7 +123,7 @@ VFS::Vnode* Ext2::FindInDirectory(VFS::Vnode* directory, const String& name)
         parsedLength += directoryEntry.entrySize;
     }
 
-    Serial::Log("[ext2]------------- Failed to find %s", name.ToRawString());
+    LogDebug("[ext2]------------- Failed to find %s", name.ToRawString());
 
     return nullptr;
 }
@@ -132,7 +133,7 @@ VFS::DirectoryEntry Ext2::ReadDirectory(VFS::Vnode* directory, uint64_t readPos)
     Ext2::DirectoryEntry ext2DirectoryEntry {};
     Read(directory, &ext2DirectoryEntry, sizeof(ext2DirectoryEntry), readPos);
 
-    char nameBuffer[ext2DirectoryEntry.nameLength];
+    char nameBuffer[ext2DirectoryEntry.nameLength + 1];
     Read(directory, nameBuffer, ext2DirectoryEntry.nameLength, readPos + sizeof(ext2DirectoryEntry));
     nameBuffer[ext2DirectoryEntry.nameLength] = 0;
 
@@ -212,11 +213,19 @@ uint64_t Ext2::DiskOperation(IOType ioType, VFS::Vnode* vnode, void* buffer, uin
         switch (ioType)
         {
             case IOType::Read:
+            {
+                uint64_t traceStart = TraceBegin(Ext2Read);
                 disk->Read(diskAddr, reinterpret_cast<void*>(bufferAddr), ioSize);
+                TraceEnd(Ext2Read, traceStart, block, ioSize);
                 break;
+            }
             case IOType::Write:
+            {
+                uint64_t traceStart = TraceBegin(Ext2Write);
                 disk->Write(diskAddr, reinterpret_cast<const void*>(bufferAddr), ioSize);
+                TraceEnd(Ext2Write, traceStart, block, ioSize);
                 break;
+            }
             default: Panic();
         }
 
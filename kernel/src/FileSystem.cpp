@@ -5,4 +5,24 @@ FileSystem::FileSystem(Disk* disk) : disk(disk) { }
 FileSystem::~FileSystem()
 {
     delete disk;
-}
\ No newline at end of file
+}
+
+uint64_t FileSystem::Control(VFS::Vnode* vnode, uint64_t request, void* argument, Error& error)
+{
+    error = Error::NotTerminal;
+    return 0;
+
+    (void)vnode;
+    (void)request;
+    (void)argument;
+}
+
+void* FileSystem::Map(VFS::Vnode* vnode, void* addr, uint64_t length, Error& error)
+{
+    error = Error::InvalidArgument;
+    return nullptr;
+
+    (void)vnode;
+    (void)addr;
+    (void)length;
+}
@@ -7,6 +7,7 @@
 uint32_t* Framebuffer::virtAddr = nullptr;
 uint16_t Framebuffer::width = 0;
 uint16_t Framebuffer::height = 0;
+uint16_t Framebuffer::pitch = 0;
 uint8_t Framebuffer::redShift = 0;
 uint8_t Framebuffer::blueShift = 0;
 uint8_t Framebuffer::greenShift = 0;
@@ -25,18 +26,19 @@ void Framebuffer::Initialize()
     virtAddr = (uint32_t*)framebufferStruct->framebuffer_addr;
     width = framebufferStruct->framebuffer_width;
     height = framebufferStruct->framebuffer_height;
+    pitch = framebufferStruct->framebuffer_pitch;
     redShift = framebufferStruct->red_mask_shift;
     greenShift = framebufferStruct->green_mask_shift;
     blueShift = framebufferStruct->blue_mask_shift;
 
-    memset(virtAddr, 0, width * height * sizeof(uint32_t));
+    memset(virtAddr, 0, GetSize());
 }
 
 void Framebuffer::PlotPixel(unsigned int x, unsigned int y, Colour colour)
 {
-    Assert(x < width);
-    Assert(y < height);
-    uint32_t* addr = virtAddr + (y * width) + x;
+    DebugAssert(x < width);
+    DebugAssert(y < height);
+    uint32_t* addr = virtAddr + (y * Stride()) + x;
     uint32_t rgb = colour.red << redShift | colour.green << greenShift | colour.blue << blueShift;
     *addr = rgb;
 }
@@ -45,15 +47,15 @@ void Framebuffer::TranslateVertical(long deltaY, const Colour& fillColour)
 {
     Assert(deltaY > 0);
 
-    long deltaPixels = deltaY * width;
+    long deltaPixels = deltaY * Stride();
     uint32_t* source = virtAddr + deltaPixels;
     uint32_t* destination = virtAddr;
-    for (long i = 0; i < width * height - deltaPixels; ++i)
+    for (long i = 0; i < Stride() * height - deltaPixels; ++i)
     {
         destination[i] = source[i];
     }
 
-    uint32_t* fillStart = virtAddr + width * height - deltaPixels - 1;
+    uint32_t* fillStart = virtAddr + Stride() * height - deltaPixels - 1;
     for (long i = 0; i < deltaPixels; ++i)
     {
         fillStart[i] = fillColour.red << redShift | fillColour.green << greenShift | fillColour.blue << blueShift;
@@ -70,7 +72,28 @@ long Framebuffer::Height()
     return height;
 }
 
+// Distance between the start of two rows, in pixels
+long Framebuffer::Stride()
+{
+    return pitch / sizeof(uint32_t);
+}
+
 uint32_t* Framebuffer::GetBuffer()
 {
     return virtAddr;
 }
+
+uintptr_t Framebuffer::GetPhysicalAddress()
+{
+    return LowerHalf(reinterpret_cast<uintptr_t>(virtAddr));
+}
+
+uint64_t Framebuffer::GetSize()
+{
+    return static_cast<uint64_t>(pitch) * height;
+}
+
+FramebufferInfo Framebuffer::GetInfo()
+{
+    return {width, height, pitch, 32, redShift, greenShift, blueShift};
+}
@@ -1,7 +1,23 @@
 #include "FramebufferDevice.h"
 #include "Framebuffer.h"
+#include "Scheduler.h"
+#include "Math.h"
 #include "Memory/Memory.h"
 
+constexpr uintptr_t USERSPACE_END = 0x0000'8000'0000'0000;
+
+// Whether every page of the range is user memory that nothing is mapped at yet
+bool IsRangeFree(PagingManager* pagingManager, uintptr_t start, uint64_t pageCount)
+{
+    if (start >= USERSPACE_END || pageCount > (USERSPACE_END - start) / 0x1000) return false;
+
+    for (uint64_t pageIndex = 0; pageIndex < pageCount; ++pageIndex)
+    {
+        if (pagingManager->PageNotPresentLevel(reinterpret_cast<void*>(start + pageIndex * 0x1000)) == 0) return false;
+    }
+    return true;
+}
+
 uint64_t FramebufferDevice::Read(void* buffer, uint64_t count, uint64_t position)
 {
     Panic();
@@ -14,8 +30,141 @@ uint64_t FramebufferDevice::Write(const void* buffer, uint64_t count, uint64_t p
 {
     Assert(count % 4 == 0);
     Assert(position % 4 == 0);
-    memcpy(Framebuffer::GetBuffer() + (position / 4), buffer, count);
-    return count;
+
+    // Positions address a tightly packed width * height image, each row is then placed according to the pitch
+    auto source = static_cast<const uint32_t*>(buffer);
+    uint64_t pixel = position / 4;
+    uint64_t remainingCount = count / 4;
+    auto width = static_cast<uint64_t>(Framebuffer::Width());
+
+    while (remainingCount > 0 && pixel / width < static_cast<uint64_t>(Framebuffer::Height()))
+    {
+        uint64_t x = pixel % width;
+        uint64_t y = pixel / width;
+        uint64_t rowCount = Min(remainingCount, width - x);
+
+        memcpy(Framebuffer::GetBuffer() + y * Framebuffer::Stride() + x, source, rowCount * 4);
+
+        source += rowCount;
+        pixel += rowCount;
+        remainingCount -= rowCount;
+    }
+
+    return count - remainingCount * 4;
+}
+
+uint64_t FramebufferDevice::Control(uint64_t request, void* argument, Error& error)
+{
+    switch (static_cast<FramebufferRequest>(request))
+    {
+        case FramebufferRequest::GetInfo:
+            *static_cast<FramebufferInfo*>(argument) = Framebuffer::GetInfo();
+            return 0;
+        case FramebufferRequest::Blit:
+            Blit(*static_cast<const FramebufferBlit*>(argument), error);
+            return 0;
+        default:
+            return Device::Control(request, argument, error);
+    }
+}
+
+void* FramebufferDevice::Map(void* addr, uint64_t length, Error& error)
+{
+    if (length == 0 || length > Framebuffer::GetSize() || reinterpret_cast<uintptr_t>(addr) % 0x1000 != 0)
+    {
+        error = Error::InvalidArgument;
+        return nullptr;
+    }
+
+    Task& task = Scheduler::GetScheduler()->currentTask;
+
+    // Never more than the pages the framebuffer covers. The rest of its last page is still video memory,
+    // since the PCI BAR it lives in is page aligned.
+    uint64_t framebufferPageCount = (Framebuffer::GetSize() - 1) / 0x1000 + 1;
+    uint64_t pageCount = Min((length - 1) / 0x1000 + 1, framebufferPageCount);
+
+    // As for mmap without MAP_FIXED, the address is only a hint, taken if the range is free user memory
+    auto hint = reinterpret_cast<uintptr_t>(addr);
+    if (addr == nullptr || !IsRangeFree(task.pagingManager, hint, pageCount) ||
+        !task.userspaceAllocator->Reserve(hint, pageCount))
+    {
+        addr = task.userspaceAllocator->AllocatePages(pageCount);
+    }
+
+    // The pages are mapped straight onto the framebuffer, write-combining lets the CPU batch the stores.
+    // Children forked after this keep drawing to the screen, instead of to a copy of it.
+    uintptr_t physAddr = Framebuffer::GetPhysicalAddress();
+    Assert(physAddr % 0x1000 == 0);
+    for (uint64_t pageIndex = 0; pageIndex < pageCount; ++pageIndex)
+    {
+        auto virtAddr = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(addr) + pageIndex * 0x1000);
+        task.pagingManager->MapDeviceMemory(virtAddr, reinterpret_cast<void*>(physAddr + pageIndex * 0x1000), true);
+    }
+
+    return addr;
+}
+
+void FramebufferDevice::Blit(const FramebufferBlit& blit, Error& error)
+{
+    uint64_t bytesPerPixel = blit.format == PixelFormat::RGB565 ? 2 : 4;
+    if (blit.scale == 0 || blit.format > PixelFormat::RGB565 ||
+        (static_cast<uint64_t>(blit.sourceX) + blit.width) * bytesPerPixel > blit.pitch ||
+        blit.destinationX + static_cast<uint64_t>(blit.width) * blit.scale > static_cast<uint64_t>(Framebuffer::Width()) ||
+        blit.destinationY + static_cast<uint64_t>(blit.height) * blit.scale > static_cast<uint64_t>(Framebuffer::Height()))
+    {
+        error = Error::InvalidArgument;
+        return;
+    }
+
+    FramebufferInfo info = Framebuffer::GetInfo();
+    auto sourceRow = static_cast<const uint8_t*>(blit.buffer) + blit.sourceY * static_cast<uint64_t>(blit.pitch) + blit.sourceX * bytesPerPixel;
+    uint32_t* destinationRow = Framebuffer::GetBuffer() + blit.destinationY * Framebuffer::Stride() + blit.destinationX;
+
+    // SSE state is not preserved across kernel code, so pixels are stored two at a time through 64-bit writes instead.
+    // Every source pixel is converted once per destination row, which keeps all framebuffer accesses write-only.
+    for (uint32_t y = 0; y < blit.height; ++y)
+    {
+        for (uint32_t repeat = 0; repeat < blit.scale; ++repeat)
+        {
+            uint32_t* destination = destinationRow;
+            for (uint32_t x = 0; x < blit.width; ++x)
+            {
+                uint32_t red, green, blue;
+                if (blit.format == PixelFormat::RGB565)
+                {
+                    uint16_t pixel = reinterpret_cast<const uint16_t*>(sourceRow)[x];
+                    red = (pixel >> 11) << 3;
+                    green = ((pixel >> 5) & 0x3f) << 2;
+                    blue = (pixel & 0x1f) << 3;
+                }
+                else
+                {
+                    uint32_t pixel = reinterpret_cast<const uint32_t*>(sourceRow)[x];
+                    red = (pixel >> (blit.format == PixelFormat::XRGB8888 ? 16 : 0)) & 0xff;
+                    green = (pixel >> 8) & 0xff;
+                    blue = (pixel >> (blit.format == PixelFormat::XRGB8888 ? 0 : 16)) & 0xff;
+                }
+
+                uint32_t converted = red << info.redShift | green << info.greenShift | blue << info.blueShift;
+
+                uint32_t remaining = blit.scale;
+                if (remaining > 1 && reinterpret_cast<uintptr_t>(destination) % 8 == 0)
+                {
+                    uint64_t pair = static_cast<uint64_t>(converted) << 32 | converted;
+                    for (; remaining > 1; remaining -= 2)
+                    {
+                        *reinterpret_cast<uint64_t*>(destination) = pair;
+                        destination += 2;
+                    }
+                }
+                while (remaining-- > 0) *destination++ = converted;
+            }
+
+            destinationRow += Framebuffer::Stride();
+        }
+
+        sourceRow += blit.pitch;
+    }
 }
 
 FramebufferDevice::FramebufferDevice(const String& name, uint32_t inodeNum) : Device(name, inodeNum) {}
@@ -22,18 +22,23 @@ void GDT::LoadGDTR()
     asm volatile("lgdt %0" : : "m"(gdtr));
 }
 
+// Every core gets its own copy of the GDT, so that the cores can load their TSSs at the same time.
+// Loading a TSS marks its descriptor busy, so a descriptor can't be shared anyway.
 void GDT::LoadTSS(TSS* tss)
 {
+    auto coreGdt = new GDT(gdt);
     auto tssAddr = reinterpret_cast<uintptr_t>(tss);
 
-    gdt.entries[3].base0 = tssAddr;
-    gdt.entries[3].base1 = tssAddr >> 16;
-    gdt.entries[3].base2 = tssAddr >> 24;
-    gdt.entries[3].limit0 = sizeof(TSS) - 1;
-    gdt.entries[3].limit1Attributes = (sizeof(TSS) - 1) >> 16;
-    gdt.entries[3].typeAttributes = TSS_TYPE_ATTRIBUTES;
-    *(uint64_t*)&gdt.entries[4] = tssAddr >> 32;
+    coreGdt->entries[3].base0 = tssAddr;
+    coreGdt->entries[3].base1 = tssAddr >> 16;
+    coreGdt->entries[3].base2 = tssAddr >> 24;
+    coreGdt->entries[3].limit0 = sizeof(TSS) - 1;
+    coreGdt->entries[3].limit1Attributes = (sizeof(TSS) - 1) >> 16;
+    coreGdt->entries[3].typeAttributes = TSS_TYPE_ATTRIBUTES;
+    *(uint64_t*)&coreGdt->entries[4] = tssAddr >> 32;
 
+    GDTR coreGdtr {sizeof(GDT) - 1, reinterpret_cast<uintptr_t>(coreGdt)};
+    asm volatile("lgdt %0" : : "m"(coreGdtr));
     asm volatile("ltr %0" : : "r"((uint16_t)0b11'000));
 }
 
@@ -0,0 +1,163 @@
+#include "Gcov.h"
+#include "Serial.h"
+
+// Structures that GCC emits for every instrumented object file, as in GCC 12's libgcc/libgcov.h.
+// -fprofile-info-section puts a pointer to each GcovInfo into .gcov_info instead of registering it
+// from a constructor, linker.ld collects those pointers between __gcov_info_start and __gcov_info_end.
+constexpr uint64_t GCOV_COUNTER_KINDS = 8;
+constexpr uint64_t GCOV_LINE_SIZE = 512;
+constexpr uint64_t GCOV_VALUES_PER_LINE = 8;
+
+struct GcovCounters
+{
+    uint32_t count;
+    int64_t* values;
+};
+
+struct GcovInfo;
+
+struct GcovFunction
+{
+    const GcovInfo* key; // Inline functions are emitted into several objects, only the one it points to counts
+    uint32_t ident;
+    uint32_t linenoChecksum;
+    uint32_t cfgChecksum;
+    GcovCounters counters[]; // One for every counter kind that has a merge function
+};
+
+struct GcovInfo
+{
+    uint32_t version;
+    GcovInfo* next;
+    uint32_t stamp;
+    uint32_t checksum;
+    const char* filename; // Where the .gcda file goes, next to the object file
+    void (*merge[GCOV_COUNTER_KINDS])(int64_t* counters, uint32_t count);
+    uint32_t functionCount;
+    const GcovFunction* const* functions;
+};
+
+extern "C" const GcovInfo* const __gcov_info_start[];
+extern "C" const GcovInfo* const __gcov_info_end[];
+
+// Arc counters point their merge function here, only libgcov calls it when merging with an existing .gcda file
+extern "C" void __gcov_merge_add(int64_t* counters, uint32_t count)
+{
+    (void)counters;
+    (void)count;
+}
+
+// The version spells the GCC release, "B22*" is 12.2. Releases before 12 have no checksum field.
+bool IsLayoutSupported(const GcovInfo* info)
+{
+    char tens = info->version >> 24;
+    char units = (info->version >> 16) & 0xff;
+    return tens > 'B' || (tens == 'B' && units >= '2');
+}
+
+bool Gcov::IsEnabled()
+{
+    return __gcov_info_end - __gcov_info_start > 0 && IsLayoutSupported(__gcov_info_start[0]);
+}
+
+void WriteLine(const char* line, TextWriter& writer)
+{
+    Serial::WriteSynchronously(line, writer.GetWrittenCount());
+}
+
+void DumpCounters(uint64_t kind, const GcovCounters& counters)
+{
+    char line[GCOV_LINE_SIZE];
+    TextWriter header(line, sizeof(line), 0);
+    header.Write("gcov-counters ");
+    header.WriteHex(kind);
+    header.Write(' ');
+    header.WriteHex(counters.count);
+    WriteLine(line, header);
+
+    for (uint32_t first = 0; first < counters.count; first += GCOV_VALUES_PER_LINE)
+    {
+        TextWriter writer(line, sizeof(line), 0);
+        writer.Write("gcov-values");
+        for (uint32_t i = first; i < counters.count && i < first + GCOV_VALUES_PER_LINE; ++i)
+        {
+            writer.Write(' ');
+            writer.WriteHex(__atomic_load_n(&counters.values[i], __ATOMIC_RELAXED));
+        }
+        WriteLine(line, writer);
+    }
+}
+
+// Writes every object file as
+//     gcov-file <version> <stamp> <checksum> <filename>
+//     gcov-function <ident> <lineno checksum> <cfg checksum>
+//     gcov-counters <kind> <count>
+//     gcov-values <value>...
+// in hex, and "gcov-done" at the end. Counters keep running while they are dumped.
+void Gcov::DumpToDebugPort()
+{
+    if (!IsEnabled())
+    {
+        Serial::LogSynchronously("gcov-done");
+        return;
+    }
+
+    char line[GCOV_LINE_SIZE];
+    for (const GcovInfo* const* info = __gcov_info_start; info < __gcov_info_end; ++info)
+    {
+        TextWriter file(line, sizeof(line), 0);
+        file.Write("gcov-file ");
+        file.WriteHex((*info)->version);
+        file.Write(' ');
+        file.WriteHex((*info)->stamp);
+        file.Write(' ');
+        file.WriteHex((*info)->checksum);
+        file.Write(' ');
+        file.Write((*info)->filename);
+        WriteLine(line, file);
+
+        for (uint32_t i = 0; i < (*info)->functionCount; ++i)
+        {
+            const GcovFunction* function = (*info)->functions[i];
+            if (function == nullptr || function->key != *info) continue;
+
+            TextWriter writer(line, sizeof(line), 0);
+            writer.Write("gcov-function ");
+            writer.WriteHex(function->ident);
+            writer.Write(' ');
+            writer.WriteHex(function->linenoChecksum);
+            writer.Write(' ');
+            writer.WriteHex(function->cfgChecksum);
+            WriteLine(line, writer);
+
+            const GcovCounters* counters = function->counters;
+            for (uint64_t kind = 0; kind < GCOV_COUNTER_KINDS; ++kind)
+            {
+                if ((*info)->merge[kind] != nullptr) DumpCounters(kind, *counters++);
+            }
+        }
+    }
+
+    Serial::LogSynchronously("gcov-done");
+}
+
+void Gcov::Report(TextWriter& writer)
+{
+    if (!IsEnabled())
+    {
+        writer.Write("No arc counters, build the kernel with BUILD=release PGO=generate\n");
+        return;
+    }
+
+    uint64_t functionCount = 0;
+    for (const GcovInfo* const* info = __gcov_info_start; info < __gcov_info_end; ++info)
+    {
+        functionCount += (*info)->functionCount;
+    }
+
+    writer.Write("Object files: ");
+    writer.WriteDecimal(__gcov_info_end - __gcov_info_start);
+    writer.Write("\nFunctions: ");
+    writer.WriteDecimal(functionCount);
+    writer.Write("\nWrite anything to dump the counters to the debug port\n");
+}
@@ -0,0 +1,20 @@
+#include "GcovDevice.h"
+#include "Gcov.h"
+
+uint64_t GcovDevice::Read(void* buffer, uint64_t count, uint64_t position)
+{
+    TextWriter writer(static_cast<char*>(buffer), count, position);
+    Gcov::Report(writer);
+    return writer.GetWrittenCount();
+}
+
+uint64_t GcovDevice::Write(const void* buffer, uint64_t count, uint64_t position)
+{
+    Gcov::DumpToDebugPort();
+
+    (void)buffer;
+    (void)position;
+    return count;
+}
+
+GcovDevice::GcovDevice(const String& name, uint32_t inodeNum) : Device(name, inodeNum) {}
@@ -5,6 +5,7 @@
 #include "Math.h"
 #include "Assert.h"
 #include "Spinlock.h"
+#include "AllocationProfiler.h"
 
 struct FreeSlot
 {
@@ -16,13 +17,14 @@ class Slab
 private:
     uint64_t slotSize;
     FreeSlot* head;
-    Spinlock lock;
+    Spinlock lock {LockClass::Slab};
+    AllocationTag* tags {};
 
 public:
     uint64_t slabBase;
     uint64_t slabSize;
     void InitializeSlab(uint64_t _slotSize, uint64_t _slabSize);
-    void* Alloc();
+    void* Alloc(uintptr_t caller);
     void Free(void* ptr);
 
     Slab() = default;
@@ -32,10 +34,7 @@ public:
 constexpr uint64_t SLABS_COUNT = 10;
 Slab slabs[SLABS_COUNT];
 
-uint64_t allocTableIndex = 0;
-constexpr uint64_t ALLOC_TABLE_SIZE = 8192;
-uint64_t allocTable[ALLOC_TABLE_SIZE];
-constexpr bool DEBUG_DOUBLE_FREE = false;
+#define CALLER_ADDRESS reinterpret_cast<uintptr_t>(__builtin_return_address(0))
 
 void Slab::InitializeSlab(uint64_t _slotSize, uint64_t _slabSize)
 {
@@ -55,9 +54,17 @@ void Slab::InitializeSlab(uint64_t _slotSize, uint64_t _slabSize)
     }
 
     head = previous;
+
+#ifdef ALLOCATION_PROFILING
+    uint64_t slotCount = slabSize / slotSize;
+    uint64_t tagsSize = slotCount * sizeof(AllocationTag);
+    tags = reinterpret_cast<AllocationTag*>(HigherHalf(RequestPageFrames((tagsSize + 0xfff) / 0x1000)));
+    memset(tags, 0, tagsSize);
+    AllocationProfiler::RegisterTags(tags, slotCount, slotSize);
+#endif
 }
 
-void* Slab::Alloc()
+void* Slab::Alloc(uintptr_t caller)
 {
     lock.Acquire();
 
@@ -65,11 +72,13 @@ void* Slab::Alloc()
     Assert(addr != nullptr);
     head = head->next;
 
-    if (DEBUG_DOUBLE_FREE)
-    {
-        Assert(allocTableIndex < ALLOC_TABLE_SIZE);
-        allocTable[allocTableIndex++] = reinterpret_cast<uintptr_t>(addr);
-    }
+#ifdef ALLOCATION_PROFILING
+    AllocationTag& tag = tags[(reinterpret_cast<uintptr_t>(addr) - slabBase) / slotSize];
+    tag.site = AllocationProfiler::RecordAllocation(AllocationKind::Slab, caller, slotSize);
+    tag.pid = AllocationProfiler::GetCurrentPid();
+#else
+    (void)caller;
+#endif
 
     lock.Release();
     return addr;
@@ -79,46 +88,40 @@ void Slab::Free(void* ptr)
 {
     lock.Acquire();
 
+#ifdef ALLOCATION_PROFILING
+    AllocationTag& tag = tags[(reinterpret_cast<uintptr_t>(ptr) - slabBase) / slotSize];
+    if (tag.site == 0)
+    {
+        Serial::Log("Double free!");
+        Serial::Log("DF addr: %x", (uint64_t) ptr);
+        Serial::Log("DF Slot size: %d", (uint64_t) slotSize);
+        Panic();
+    }
+
+    AllocationProfiler::RecordFree(tag.site, slotSize);
+    tag = {};
+#endif
+
     FreeSlot* previousHead = head;
     head = static_cast<FreeSlot*>(ptr);
     head->next = previousHead;
 
-    if (DEBUG_DOUBLE_FREE)
-    {
-        bool foundAddr = false;
-        for (uint64_t i = 0; i < allocTableIndex + 1; ++i)
-        {
-            if (allocTable[i] == (uint64_t)ptr)
-            {
-                allocTable[i] = 0;
-                foundAddr = true;
-                break;
-            }
-        }
-        if (!foundAddr)
-        {
-            Serial::Log("Double free!");
-            Serial::Log("DF addr: %x", (uint64_t) ptr);
-            Serial::Log("DF Slot size: %d", (uint64_t) slotSize);
-            Panic();
-        }
-    }
-
     lock.Release();
 }
 
-void* LargeKMalloc(uint64_t size)
+// The allocators take the address they are called from, so that operator new can pass on its own caller
+void* LargeKMalloc(uint64_t size, uintptr_t caller)
 {
     uint64_t pageCount = size / 0x1000;
-    return reinterpret_cast<void*>(HigherHalf(RequestPageFrames(pageCount)));
+    return reinterpret_cast<void*>(HigherHalf(RequestPageFrames(pageCount, caller)));
 }
 
-void* KMalloc(uint64_t size)
+void* KMalloc(uint64_t size, uintptr_t caller)
 {
     if (size < 8) size = 8;
     uint64_t slabIndex = CeilLog2(size) - 3;
     Assert(slabIndex < SLABS_COUNT);
-    return slabs[slabIndex].Alloc();
+    return slabs[slabIndex].Alloc(caller);
 }
 
 void KFree(void* ptr)
@@ -146,16 +149,16 @@ void InitializeKernelHeap()
     }
 }
 
-Spinlock permanentAllocatorLock;
+Spinlock permanentAllocatorLock {LockClass::PermanentAllocator};
 uintptr_t currentPageAddr;
 uint64_t currentOffset = 0x1000;
-void* PermanentAlloc(uint64_t size)
+void* PermanentAlloc(uint64_t size, uintptr_t caller)
 {
     void* ptr;
 
     if (size > 0x1000)
     {
-        ptr = LargeKMalloc(size);
+        ptr = LargeKMalloc(size, caller);
     }
     else if (currentOffset + size <= 0x1000)
     {
@@ -175,13 +178,18 @@ void* PermanentAlloc(uint64_t size)
     }
 
     Assert(ptr != nullptr);
+
+#ifdef ALLOCATION_PROFILING
+    if (size <= 0x1000) AllocationProfiler::RecordAllocation(AllocationKind::Permanent, caller, size);
+#endif
+
     return ptr;
 }
 
 void* operator new(uint64_t, void* ptr) { return ptr; }
 void* operator new[](uint64_t, void* ptr) { return ptr; }
-void* operator new(uint64_t size) { return KMalloc(size); }
-void* operator new[](uint64_t size) { return KMalloc(size); }
+void* operator new(uint64_t size) { return KMalloc(size, CALLER_ADDRESS); }
+void* operator new[](uint64_t size) { return KMalloc(size, CALLER_ADDRESS); }
 void operator delete(void* ptr) { KFree(ptr); }
 void operator delete(void* ptr, uint64_t) { KFree(ptr); }
 void operator delete[](void* ptr) { KFree(ptr); }
@@ -191,8 +199,8 @@ void* operator new(uint64_t size, Allocator type)
 {
     switch (type)
     {
-        case Allocator::Permanent: return PermanentAlloc(size);
-        case Allocator::Slab: return KMalloc(size);
+        case Allocator::Permanent: return PermanentAlloc(size, CALLER_ADDRESS);
+        case Allocator::Slab: return KMalloc(size, CALLER_ADDRESS);
         default: Panic();
     }
 }
@@ -201,8 +209,8 @@ void* operator new[](uint64_t size, Allocator type)
 {
     switch (type)
     {
-        case Allocator::Permanent: return PermanentAlloc(size);
-        case Allocator::Slab: return KMalloc(size);
+        case Allocator::Permanent: return PermanentAlloc(size, CALLER_ADDRESS);
+        case Allocator::Slab: return KMalloc(size, CALLER_ADDRESS);
         default: Panic();
     }
 }
@@ -126,10 +126,31 @@ ISRWrapperNoErrorCode 45
 ISRWrapperNoErrorCode 46
 ISRWrapperNoErrorCode 47
 
+; Dynamically allocated device IRQs (IRQ_FIRST_DYNAMIC_VECTOR to IRQ_LAST_DYNAMIC_VECTOR in IRQ.h)
+%assign vector 64
+%rep 64
+    global ISRWrapper %+ vector
+ISRWrapper %+ vector:
+    push 0
+    push vector
+    ISRWrapperContents
+%assign vector vector + 1
+%endrep
+
 ; Local APIC IRQs
 ISRWrapperNoErrorCode 48  ; Timer
 ISRWrapperNoErrorCode 255 ; Spurious Interrupt Vector
 
 ; Miscellaneous
 ISRWrapperNoErrorCode 128 ; System Call
-ISRWrapperNoErrorCode 129 ; Suspend System Call
\ No newline at end of file
+ISRWrapperNoErrorCode 129 ; Suspend System Call
+
+section .rodata
+
+global DynamicISRWrappers
+DynamicISRWrappers:
+%assign vector 64
+%rep 64
+    dq ISRWrapper %+ vector
+%assign vector vector + 1
+%endrep
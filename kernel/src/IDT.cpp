@@ -1,4 +1,5 @@
 #include "IDT.h"
+#include "IRQ.h"
 
 // Exceptions
 extern "C" void ISRWrapper0();
@@ -44,6 +45,9 @@ extern "C" void ISRWrapper45();
 extern "C" void ISRWrapper46();
 extern "C" void ISRWrapper47();
 
+// Dynamically allocated device IRQs, from IRQ_FIRST_DYNAMIC_VECTOR to IRQ_LAST_DYNAMIC_VECTOR
+extern "C" const uint64_t DynamicISRWrappers[];
+
 // Local LAPIC IRQs
 extern "C" void ISRWrapper48();
 extern "C" void ISRWrapper255();
@@ -118,6 +122,12 @@ void IDT::InitializeInterruptHandlers()
     SetInterruptHandler(46, reinterpret_cast<uint64_t>(ISRWrapper46));
     SetInterruptHandler(47, reinterpret_cast<uint64_t>(ISRWrapper47));
 
+    // Dynamically allocated device IRQs
+    for (int vector = IRQ_FIRST_DYNAMIC_VECTOR; vector <= IRQ_LAST_DYNAMIC_VECTOR; ++vector)
+    {
+        SetInterruptHandler(vector, DynamicISRWrappers[vector - IRQ_FIRST_DYNAMIC_VECTOR]);
+    }
+
     // Local LAPIC IRQs
     SetInterruptHandler(48, reinterpret_cast<uint64_t>(ISRWrapper48), 3, 5); // Timer Interrupt
     SetInterruptHandler(255, reinterpret_cast<uint64_t>(ISRWrapper255));
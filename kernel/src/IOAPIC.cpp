@@ -0,0 +1,123 @@
+#include "IOAPIC.h"
+#include "ACPI.h"
+#include "Memory/Memory.h"
+
+constexpr uint64_t IOAPIC_REGISTER_SELECT = 0x00;
+constexpr uint64_t IOAPIC_REGISTER_WINDOW = 0x10;
+constexpr uint32_t IOAPIC_VERSION = 0x01;
+constexpr uint32_t IOAPIC_REDIRECTION_TABLE = 0x10;
+
+constexpr uint32_t REDIRECTION_ACTIVE_LOW = 1 << 13;
+constexpr uint32_t REDIRECTION_LEVEL_TRIGGERED = 1 << 15;
+constexpr uint32_t REDIRECTION_MASKED = 1 << 16;
+
+Vector<IOAPIC*>* IOAPIC::ioapics;
+
+void IOAPIC::Initialize()
+{
+    Assert(ioapics == nullptr);
+    ioapics = new Vector<IOAPIC*>();
+
+    for (const MADTIOAPIC& entry : ACPI::GetIOAPICs())
+    {
+        auto ioapic = new IOAPIC();
+        ioapic->registerBase = HigherHalf(entry.address);
+        ioapic->gsiBase = entry.gsiBase;
+
+        // Bits 16..23 of the version register hold the index of the last redirection entry
+        ioapic->redirectionEntryCount = ((ioapic->ReadRegister(IOAPIC_VERSION) >> 16) & 0xff) + 1;
+
+        // Nothing is routed until a driver asks for it
+        for (uint32_t i = 0; i < ioapic->redirectionEntryCount; ++i)
+        {
+            ioapic->WriteRegister(IOAPIC_REDIRECTION_TABLE + i * 2, REDIRECTION_MASKED);
+            ioapic->WriteRegister(IOAPIC_REDIRECTION_TABLE + i * 2 + 1, 0);
+        }
+
+        ioapics->Push(ioapic);
+    }
+
+    Assert(!ioapics->IsEmpty());
+}
+
+// Core IDs are the LAPIC IDs of the cores (see InitializeCore), so they can be used directly as destinations
+void IOAPIC::Route(uint32_t gsi, uint8_t vector, uint32_t destinationCore, bool activeLow, bool levelTriggered)
+{
+    IOAPIC& ioapic = GetIOAPIC(gsi);
+    uint32_t index = IOAPIC_REDIRECTION_TABLE + (gsi - ioapic.gsiBase) * 2;
+
+    // Fixed delivery mode, physical destination mode
+    uint32_t low = vector;
+    if (activeLow) low |= REDIRECTION_ACTIVE_LOW;
+    if (levelTriggered) low |= REDIRECTION_LEVEL_TRIGGERED;
+
+    ioapic.lock.Acquire();
+    ioapic.WriteRegister(index, REDIRECTION_MASKED);
+    ioapic.WriteRegister(index + 1, destinationCore << 24);
+    ioapic.WriteRegister(index, low);
+    ioapic.lock.Release();
+}
+
+void IOAPIC::SetDestination(uint32_t gsi, uint32_t destinationCore)
+{
+    IOAPIC& ioapic = GetIOAPIC(gsi);
+    uint32_t index = IOAPIC_REDIRECTION_TABLE + (gsi - ioapic.gsiBase) * 2;
+
+    ioapic.lock.Acquire();
+    ioapic.WriteRegister(index + 1, destinationCore << 24);
+    ioapic.lock.Release();
+}
+
+void IOAPIC::Mask(uint32_t gsi)
+{
+    IOAPIC& ioapic = GetIOAPIC(gsi);
+    uint32_t index = IOAPIC_REDIRECTION_TABLE + (gsi - ioapic.gsiBase) * 2;
+
+    ioapic.lock.Acquire();
+    ioapic.WriteRegister(index, ioapic.ReadRegister(index) | REDIRECTION_MASKED);
+    ioapic.lock.Release();
+}
+
+uint32_t IOAPIC::GetLegacyIRQ(uint8_t irq, bool& activeLow, bool& levelTriggered)
+{
+    // ISA interrupts are active high and edge triggered unless overridden
+    activeLow = false;
+    levelTriggered = false;
+
+    for (const MADTInterruptOverride& interruptOverride : ACPI::GetInterruptOverrides())
+    {
+        if (interruptOverride.irq == irq)
+        {
+            activeLow = interruptOverride.activeLow;
+            levelTriggered = interruptOverride.levelTriggered;
+            return interruptOverride.gsi;
+        }
+    }
+
+    return irq;
+}
+
+IOAPIC& IOAPIC::GetIOAPIC(uint32_t gsi)
+{
+    for (IOAPIC* ioapic : *ioapics)
+    {
+        if (gsi >= ioapic->gsiBase && gsi < ioapic->gsiBase + ioapic->redirectionEntryCount)
+        {
+            return *ioapic;
+        }
+    }
+
+    Panic();
+}
+
+uint32_t IOAPIC::ReadRegister(uint32_t index)
+{
+    *reinterpret_cast<volatile uint32_t*>(registerBase + IOAPIC_REGISTER_SELECT) = index;
+    return *reinterpret_cast<volatile uint32_t*>(registerBase + IOAPIC_REGISTER_WINDOW);
+}
+
+void IOAPIC::WriteRegister(uint32_t index, uint32_t value)
+{
+    *reinterpret_cast<volatile uint32_t*>(registerBase + IOAPIC_REGISTER_SELECT) = index;
+    *reinterpret_cast<volatile uint32_t*>(registerBase + IOAPIC_REGISTER_WINDOW) = value;
+}
@@ -0,0 +1,196 @@
+#include "IRQ.h"
+#include "ACPI.h"
+#include "IOAPIC.h"
+#include "CPU.h"
+#include "Spinlock.h"
+#include "Serial.h"
+
+constexpr uint64_t MSI_ADDRESS_BASE = 0xfee0'0000;
+
+enum class IRQType
+{
+    Free, Legacy, MSI
+};
+
+struct IRQEntry
+{
+    IRQType type = IRQType::Free;
+    IRQ::Handler handler = nullptr;
+    IRQ::MSIProgrammer programmer = nullptr;
+    uint64_t argument = 0;
+    uint32_t gsi = 0;
+    uint32_t coreId = 0;
+    bool pinned = false; // Set once the affinity was chosen explicitly, so that Rebalance leaves it alone
+};
+
+IRQEntry irqEntries[IRQ_LAST_DYNAMIC_VECTOR + 1];
+Spinlock irqLock {LockClass::IRQ};
+
+MSIMessage GetMSIMessage(uint8_t vector, uint32_t coreId)
+{
+    // Physical destination mode, fixed delivery mode, edge triggered
+    return {MSI_ADDRESS_BASE | coreId << 12, vector};
+}
+
+void ApplyAffinity(uint8_t vector)
+{
+    IRQEntry& entry = irqEntries[vector];
+    if (entry.type == IRQType::Legacy)
+    {
+        IOAPIC::SetDestination(entry.gsi, entry.coreId);
+    }
+    else if (entry.type == IRQType::MSI)
+    {
+        entry.programmer(GetMSIMessage(vector, entry.coreId), entry.argument);
+    }
+}
+
+// The excluded vector isn't counted, so that a vector being moved doesn't weigh on its current core
+uint32_t LeastLoadedCore(uint8_t excludedVector = 0)
+{
+    uint32_t bestCore = CPU::GetCoreID();
+    uint64_t bestLoad = UINT64_MAX;
+
+    for (uint32_t coreId = 0; coreId < CPU::GetCoreCount(); ++coreId)
+    {
+        if (!CPU::IsCoreOnline(coreId)) continue;
+
+        uint64_t load = 0;
+        for (uint64_t vector = 0; vector <= IRQ_LAST_DYNAMIC_VECTOR; ++vector)
+        {
+            const IRQEntry& entry = irqEntries[vector];
+            if (vector != excludedVector && entry.type != IRQType::Free && entry.coreId == coreId) load++;
+        }
+
+        if (load < bestLoad)
+        {
+            bestCore = coreId;
+            bestLoad = load;
+        }
+    }
+
+    return bestCore;
+}
+
+void IRQ::Initialize()
+{
+    ACPI::Initialize();
+    IOAPIC::Initialize();
+}
+
+uint8_t IRQ::RouteLegacy(uint8_t irq, Handler handler, uint64_t argument)
+{
+    Assert(irq < 16);
+    uint8_t vector = IRQ_LEGACY_VECTOR_BASE + irq;
+
+    bool activeLow;
+    bool levelTriggered;
+    uint32_t gsi = IOAPIC::GetLegacyIRQ(irq, activeLow, levelTriggered);
+
+    irqLock.Acquire();
+
+    IRQEntry& entry = irqEntries[vector];
+    Assert(entry.type == IRQType::Free);
+    entry = {IRQType::Legacy, handler, nullptr, argument, gsi, CPU::GetCoreID(), false};
+    IOAPIC::Route(gsi, vector, entry.coreId, activeLow, levelTriggered);
+
+    irqLock.Release();
+
+    return vector;
+}
+
+uint8_t IRQ::AllocateMSI(Handler handler, MSIProgrammer programmer, uint64_t argument)
+{
+    irqLock.Acquire();
+
+    for (uint8_t vector = IRQ_FIRST_DYNAMIC_VECTOR; vector <= IRQ_LAST_DYNAMIC_VECTOR; ++vector)
+    {
+        IRQEntry& entry = irqEntries[vector];
+        if (entry.type != IRQType::Free) continue;
+
+        entry = {IRQType::MSI, handler, programmer, argument, 0, CPU::GetCoreID(), false};
+        ApplyAffinity(vector);
+
+        irqLock.Release();
+        return vector;
+    }
+
+    irqLock.Release();
+
+    Warn("Out of MSI vectors");
+    return 0;
+}
+
+void IRQ::Free(uint8_t vector)
+{
+    irqLock.Acquire();
+
+    IRQEntry& entry = irqEntries[vector];
+    Assert(entry.type != IRQType::Free);
+    if (entry.type == IRQType::Legacy) IOAPIC::Mask(entry.gsi);
+    entry = {};
+
+    irqLock.Release();
+}
+
+void IRQ::SetAffinity(uint8_t vector, uint32_t coreId)
+{
+    Assert(coreId < CPU::GetCoreCount());
+
+    irqLock.Acquire();
+
+    IRQEntry& entry = irqEntries[vector];
+    Assert(entry.type != IRQType::Free);
+    entry.coreId = coreId;
+    entry.pinned = true;
+    ApplyAffinity(vector);
+
+    irqLock.Release();
+}
+
+uint32_t IRQ::GetAffinity(uint8_t vector)
+{
+    irqLock.Acquire();
+    uint32_t coreId = irqEntries[vector].coreId;
+    irqLock.Release();
+
+    return coreId;
+}
+
+// Vectors start out on the core that set them up, this spreads the ones that weren't given
+// an explicit affinity evenly over the cores that are online
+void IRQ::Rebalance()
+{
+    irqLock.Acquire();
+
+    for (uint64_t vector = 0; vector <= IRQ_LAST_DYNAMIC_VECTOR; ++vector)
+    {
+        IRQEntry& entry = irqEntries[vector];
+        if (entry.type == IRQType::Free || entry.pinned) continue;
+
+        uint32_t coreId = LeastLoadedCore(vector);
+        if (coreId != entry.coreId)
+        {
+            entry.coreId = coreId;
+            ApplyAffinity(vector);
+        }
+    }
+
+    irqLock.Release();
+}
+
+void IRQ::Dispatch(uint8_t vector)
+{
+    const IRQEntry& entry = irqEntries[vector];
+
+    if (entry.type == IRQType::Free)
+    {
+        Serial::Log("Unexpected interrupt on vector %x", vector);
+    }
+    else
+    {
+        entry.handler(entry.argument);
+    }
+
+    Scheduler::GetScheduler()->lapic->SendEOI();
+}
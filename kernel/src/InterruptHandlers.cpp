@@ -1,20 +1,24 @@
 #include "Scheduler.h"
 #include "Serial.h"
 #include "LAPIC.h"
-#include "PIC.h"
 #include "SystemCall.h"
 #include "CPU.h"
-#include "Keyboard.h"
-#include "KeyboardDevice.h"
-#include "IO.h"
+#include "IRQ.h"
+#include "SystemCallTrace.h"
+#include "Trace.h"
+#include "Profiler.h"
+#include "InterruptStatistics.h"
+#include "SystemCallStatistics.h"
 
-void PageFaultHandler()
+void PageFaultHandler(const InterruptFrame* interruptFrame)
 {
     Serial::Log("Page fault occurred.");
 
     uint64_t cr2;
     asm volatile("mov %%cr2, %0" : "=r"(cr2));
     Serial::Log("CR2: %x", cr2);
+
+    TracePoint(PageFault, cr2, interruptFrame->rip);
 }
 
 [[noreturn]] void ExceptionHandler(InterruptFrame* interruptFrame)
@@ -26,23 +30,15 @@ void PageFaultHandler()
     Serial::Log("PID: %d", Scheduler::GetScheduler()->currentTask.pid);
     Serial::Log("Core: %d", CPU::GetCoreID());
 
-    if (interruptFrame->interruptNumber == 0xe) PageFaultHandler();
+    if (interruptFrame->interruptNumber == 0xe) PageFaultHandler(interruptFrame);
 
     Panic();
 }
 
-void KeyboardInterruptHandler()
-{
-    uint8_t scanCode = inb(0x60);
-    Assert(scanCode != 0);
-    Keyboard::SendKeyToTerminal(scanCode);
-    KeyboardDevice::instance->Write(&scanCode, 1, 0);
-    PICSendEIO(1);
-}
-
 void LAPICTimerInterrupt(InterruptFrame* interruptFrame)
 {
-    outb(0xe9, '0' + CPU::GetCoreID());
+    if (Profiler::timerIntervalMilliseconds != 0) Profiler::Sample(interruptFrame);
+
     Scheduler* scheduler = Scheduler::GetScheduler();
     scheduler->SwitchToNextTask(interruptFrame);
     scheduler->lapic->SendEOI();
@@ -51,6 +47,21 @@ void LAPICTimerInterrupt(InterruptFrame* interruptFrame)
 void SystemCallHandler(InterruptFrame* interruptFrame)
 {
     Error error = Error::None;
+    SystemCallStatistics::Record(interruptFrame->rax);
+
+    // The task may be switched out by the call, so everything about it is read beforehand
+    const Task& task = Scheduler::GetScheduler()->currentTask;
+    bool traced = task.traced;
+    SystemCallTraceRecord traceRecord;
+    if (traced)
+    {
+        traceRecord.pid = task.pid;
+        traceRecord.type = interruptFrame->rax;
+        traceRecord.arguments[0] = interruptFrame->rdi;
+        traceRecord.arguments[1] = interruptFrame->rsi;
+        traceRecord.arguments[2] = interruptFrame->rdx;
+        traceRecord.startTimestamp = CPU::ReadTimestampCounter();
+    }
 
     interruptFrame->rax = SystemCall((SystemCallType)interruptFrame->rax, interruptFrame->rdi,
                                      interruptFrame->rsi, interruptFrame->rdx, interruptFrame, error);
@@ -59,17 +70,45 @@ void SystemCallHandler(InterruptFrame* interruptFrame)
     {
         interruptFrame->rax = -static_cast<int64_t>(error);
     }
+
+    if (traced)
+    {
+        traceRecord.returnValue = static_cast<int64_t>(interruptFrame->rax);
+        traceRecord.latency = CPU::ReadTimestampCounter() - traceRecord.startTimestamp;
+        traceRecord.coreId = CPU::GetCoreID();
+        traceRecord.reserved = 0;
+        SystemCallTrace::Record(traceRecord);
+    }
 }
 
 extern "C" void ISRHandler(InterruptFrame* interruptFrame)
 {
-    switch (interruptFrame->interruptNumber)
+    // The frame is replaced when the handler switches tasks
+    uint8_t vector = interruptFrame->interruptNumber;
+    InterruptStatistics::Record(vector);
+
+    // Exceptions are fatal and can happen before the scheduler exists, so only other entries are accounted
+    bool accounted = vector >= 32;
+    uint64_t entryTimestamp = CPU::ReadTimestampCounter();
+    uint64_t entryPid = 0;
+    uint64_t entrySystemTime = 0;
+    if (accounted)
+    {
+        Scheduler* scheduler = Scheduler::GetScheduler();
+        bool fromUserMode = (interruptFrame->cs & 3) == 3;
+        scheduler->AccountTime(entryTimestamp, fromUserMode);
+        entryPid = scheduler->currentTask.pid;
+        entrySystemTime = scheduler->currentTask.usage.systemTime;
+    }
+
+    switch (vector)
     {
         case 48:
             LAPICTimerInterrupt(interruptFrame);
             break;
-        case 32 + 1:
-            KeyboardInterruptHandler();
+        case IRQ_LEGACY_VECTOR_BASE ... IRQ_LEGACY_VECTOR_BASE + 15:
+        case IRQ_FIRST_DYNAMIC_VECTOR ... IRQ_LAST_DYNAMIC_VECTOR:
+            IRQ::Dispatch(vector);
             break;
         case 0x80:
             SystemCallHandler(interruptFrame);
@@ -80,7 +119,25 @@ extern "C" void ISRHandler(InterruptFrame* interruptFrame)
         case 0 ... 31:
             ExceptionHandler(interruptFrame);
         default:
-            Serial::Log("Could not find ISR for interrupt %x.", interruptFrame->interruptNumber);
+            Serial::Log("Could not find ISR for interrupt %x.", vector);
             Panic();
     }
+
+    if (!accounted) return;
+
+    // Charged to the task that is about to be returned to, which may not be the one that was interrupted
+    uint64_t exitTimestamp = CPU::ReadTimestampCounter();
+    Scheduler* scheduler = Scheduler::GetScheduler();
+    scheduler->AccountTime(exitTimestamp, false);
+
+    // System calls can block, so their latency is the time the task spent in the kernel for them.
+    // There is none to measure for a task that exited.
+    uint64_t latency = exitTimestamp - entryTimestamp;
+    if (vector == 0x80)
+    {
+        const Task& task = scheduler->currentTask;
+        if (task.pid != entryPid) return;
+        latency = task.usage.systemTime - entrySystemTime;
+    }
+    InterruptStatistics::RecordLatency(vector, latency);
 }
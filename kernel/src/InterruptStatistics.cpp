@@ -0,0 +1,184 @@
+#include "InterruptStatistics.h"
+#include "PerCoreRing.h"
+#include "IRQ.h"
+
+constexpr uint64_t VECTOR_COUNT = 256;
+constexpr uint8_t KEYBOARD_VECTOR = IRQ_LEGACY_VECTOR_BASE + 1;
+
+// Bucket n counts latencies of [2^n, 2^(n+1)) TSC cycles, the last one also counts everything longer
+constexpr uint64_t LATENCY_BUCKET_COUNT = 32;
+
+// Page faults are fatal, so their path has no latency to measure
+enum class LatencyPath
+{
+    Timer, Keyboard, SystemCall, Suspension, Count
+};
+constexpr uint64_t LATENCY_PATH_COUNT = static_cast<uint64_t>(LatencyPath::Count);
+
+const char* latencyPathNames[LATENCY_PATH_COUNT] =
+{
+    "LAPIC timer",
+    "Keyboard",
+    "System call (time in the kernel)",
+    "Task suspension"
+};
+
+uint64_t interruptCounts[PER_CORE_RING_MAX_CORES][VECTOR_COUNT];
+uint64_t latencyHistograms[PER_CORE_RING_MAX_CORES][LATENCY_PATH_COUNT][LATENCY_BUCKET_COUNT];
+
+const char* GetVectorName(uint64_t vector)
+{
+    switch (vector)
+    {
+        case 48:
+            return "LAPIC timer";
+        case IRQ_LEGACY_VECTOR_BASE ... IRQ_LEGACY_VECTOR_BASE + 15:
+            return "IO-APIC";
+        case IRQ_FIRST_DYNAMIC_VECTOR ... IRQ_LAST_DYNAMIC_VECTOR:
+            return "PCI-MSI";
+        case 0x80:
+            return "System call";
+        case 0x81:
+            return "Task suspension";
+        case 0xe:
+            return "Page fault";
+        case 0 ... 0xd:
+        case 0xf ... 31:
+            return "Exception";
+        default:
+            return "Unknown";
+    }
+}
+
+void InterruptStatistics::Record(uint8_t vector)
+{
+    uint32_t coreId = CPU::GetCoreID();
+    if (coreId >= PER_CORE_RING_MAX_CORES) return;
+
+    interruptCounts[coreId][vector]++;
+}
+
+void InterruptStatistics::RecordLatency(uint8_t vector, uint64_t cycles)
+{
+    LatencyPath path;
+    switch (vector)
+    {
+        case 48:
+            path = LatencyPath::Timer;
+            break;
+        case KEYBOARD_VECTOR:
+            path = LatencyPath::Keyboard;
+            break;
+        case 0x80:
+            path = LatencyPath::SystemCall;
+            break;
+        case 0x81:
+            path = LatencyPath::Suspension;
+            break;
+        default:
+            return;
+    }
+
+    uint32_t coreId = CPU::GetCoreID();
+    if (coreId >= PER_CORE_RING_MAX_CORES) return;
+
+    uint64_t bucket = cycles == 0 ? 0 : 63 - __builtin_clzll(cycles);
+    if (bucket >= LATENCY_BUCKET_COUNT) bucket = LATENCY_BUCKET_COUNT - 1;
+    latencyHistograms[coreId][static_cast<uint64_t>(path)][bucket]++;
+}
+
+uint64_t InterruptStatistics::GetTotal()
+{
+    uint64_t total = 0;
+    for (uint32_t coreId = 0; coreId < PER_CORE_RING_MAX_CORES; ++coreId)
+    {
+        for (uint64_t vector = 0; vector < VECTOR_COUNT; ++vector)
+        {
+            total += interruptCounts[coreId][vector];
+        }
+    }
+    return total;
+}
+
+void InterruptStatistics::Report(TextWriter& writer)
+{
+    uint32_t coreCount = CPU::GetCoreCount();
+    if (coreCount > PER_CORE_RING_MAX_CORES) coreCount = PER_CORE_RING_MAX_CORES;
+
+    // Same columns as Linux, so that tools parsing it work unchanged
+    for (uint32_t coreId = 0; coreId < coreCount; ++coreId)
+    {
+        writer.Pad(11 + 11 * coreId);
+        writer.Write("CPU");
+        writer.WriteDecimal(coreId);
+    }
+    writer.Write('\n');
+
+    for (uint64_t vector = 0; vector < VECTOR_COUNT; ++vector)
+    {
+        bool used = false;
+        for (uint32_t coreId = 0; coreId < coreCount; ++coreId)
+        {
+            if (interruptCounts[coreId][vector] != 0) used = true;
+        }
+        if (!used) continue;
+
+        writer.WriteDecimal(vector, 3);
+        writer.Write(": ");
+        for (uint32_t coreId = 0; coreId < coreCount; ++coreId)
+        {
+            writer.WriteDecimal(interruptCounts[coreId][vector], 10);
+            writer.Write(' ');
+        }
+        writer.Write("  ");
+        writer.Write(GetVectorName(vector));
+        if (vector >= IRQ_LEGACY_VECTOR_BASE && vector < IRQ_LEGACY_VECTOR_BASE + 16)
+        {
+            writer.Write(' ');
+            writer.WriteDecimal(vector - IRQ_LEGACY_VECTOR_BASE);
+        }
+        writer.Write('\n');
+    }
+}
+
+void InterruptStatistics::ReportLatency(TextWriter& writer)
+{
+    uint32_t coreCount = CPU::GetCoreCount();
+    if (coreCount > PER_CORE_RING_MAX_CORES) coreCount = PER_CORE_RING_MAX_CORES;
+
+    // Measured from the entry to the kernel to the end of the handler, which sent the EOI if there was one
+    for (uint64_t path = 0; path < LATENCY_PATH_COUNT; ++path)
+    {
+        if (path != 0) writer.Write('\n');
+        writer.Write("Latency of ");
+        writer.Write(latencyPathNames[path]);
+        writer.Write(" in TSC cycles\n");
+        for (uint32_t coreId = 0; coreId < coreCount; ++coreId)
+        {
+            writer.Pad(21 + 11 * coreId);
+            writer.Write("CPU");
+            writer.WriteDecimal(coreId);
+        }
+        writer.Write('\n');
+
+        for (uint64_t bucket = 0; bucket < LATENCY_BUCKET_COUNT; ++bucket)
+        {
+            bool used = false;
+            for (uint32_t coreId = 0; coreId < coreCount; ++coreId)
+            {
+                if (latencyHistograms[coreId][path][bucket] != 0) used = true;
+            }
+            if (!used) continue;
+
+            writer.Write(">=");
+            writer.WriteDecimal(1ull << bucket, 11);
+            writer.Write(": ");
+            for (uint32_t coreId = 0; coreId < coreCount; ++coreId)
+            {
+                writer.WriteDecimal(latencyHistograms[coreId][path][bucket], 10);
+                writer.Write(' ');
+            }
+            writer.Write('\n');
+        }
+    }
+}
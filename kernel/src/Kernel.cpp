@@ -2,6 +2,8 @@
 #include "Stivale2Interface.h"
 #include "IDT.h"
 #include "PIC.h"
+#include "IRQ.h"
+#include "Keyboard.h"
 #include "Ext2.h"
 #include "Serial.h"
 #include "Heap.h"
@@ -9,30 +11,68 @@
 #include "Scheduler.h"
 #include "Device.h"
 #include "Framebuffer.h"
+#include "BootProfiler.h"
+#include "CPU.h"
 
 constexpr const char* SHELL_PATH = "/bin/bash";
+constexpr const char* INIT_ARGUMENT = "init=";
+
+// The shell can be replaced with another first program by passing "init=<path>" on the kernel command line
+String GetInitPath()
+{
+    auto commandLineStruct = static_cast<stivale2_struct_tag_cmdline*>(GetStivale2Tag(STIVALE2_STRUCT_TAG_CMDLINE_ID));
+    if (commandLineStruct == nullptr) return String(SHELL_PATH);
+
+    String commandLine(reinterpret_cast<const char*>(commandLineStruct->cmdline));
+    uint64_t prefixLength = String(INIT_ARGUMENT).GetLength();
+    for (uint64_t i = 0; i <= commandLine.Count(' '); ++i)
+    {
+        String argument = commandLine.Split(' ', i);
+        if (argument.GetLength() > prefixLength && argument.Substring(0, prefixLength).Equals(INIT_ARGUMENT))
+        {
+            return argument.Substring(prefixLength, argument.GetLength() - prefixLength);
+        }
+    }
+
+    return String(SHELL_PATH);
+}
 
 extern "C" void _start(stivale2_struct* stivale2Struct)
 {
+    BootProfiler::Start();
     InitializeStivale2Interface(stivale2Struct);
 
     Serial::Log("Kernel ELF successfully loaded");
 
+    uint64_t phaseStart = CPU::ReadTimestampCounter();
     InitializePageFrameAllocator();
+    BootProfiler::Record(BootPhase::PageFrameAllocator, phaseStart);
+
+    phaseStart = CPU::ReadTimestampCounter();
     InitializeKernelHeap();
     PagingManager::SaveBootloaderAddressSpace();
+    BootProfiler::Record(BootPhase::Heap, phaseStart);
 
+    phaseStart = CPU::ReadTimestampCounter();
     GDT::Initialize();
     TSS* tss = TSS::Initialize();
     GDT::LoadGDTR();
     GDT::LoadTSS(tss);
     IDT::Initialize();
     IDT::Load();
+    BootProfiler::Record(BootPhase::DescriptorTables, phaseStart);
 
+    phaseStart = CPU::ReadTimestampCounter();
     InitializePIC();
-    ActivatePICKeyboardInterrupts();
+    IRQ::Initialize();
+    Keyboard::Initialize();
+    BootProfiler::Record(BootPhase::InterruptControllers, phaseStart);
+
+    phaseStart = CPU::ReadTimestampCounter();
     Framebuffer::Initialize();
+    BootProfiler::Record(BootPhase::Framebuffer, phaseStart);
 
+    phaseStart = CPU::ReadTimestampCounter();
     auto modulesStruct = (stivale2_struct_tag_modules*)GetStivale2Tag(STIVALE2_STRUCT_TAG_MODULES_ID);
     Serial::Log("Module Count: %d", modulesStruct->module_count);
     for (uint64_t i = 0; i < modulesStruct->module_count; ++i)
@@ -44,21 +84,28 @@ extern "C" void _start(stivale2_struct* stivale2Struct)
             VFS::Initialize((void*)module.begin);
         }
     }
+    BootProfiler::Record(BootPhase::VFS, phaseStart);
 
+    phaseStart = CPU::ReadTimestampCounter();
     Scheduler::InitializeQueue();
+    Serial::StartDrainThread();
 
     {
-        Vector<String> shellArguments;
-        shellArguments.Push(String(SHELL_PATH));
-        shellArguments.Push(String("--login"));
+        String initPath = GetInitPath();
+        Serial::Log("Starting %s", initPath.ToRawString());
+
+        Vector<String> initArguments;
+        initArguments.Push(initPath);
+        if (initPath.Equals(SHELL_PATH)) initArguments.Push(String("--login"));
 
-        Vector<String> shellEnvironment;
-        shellEnvironment.Push(String("PATH=/usr/bin"));
-        shellEnvironment.Push(String("HOME=/root"));
-        shellEnvironment.Push(String("TERM=linux"));
+        Vector<String> initEnvironment;
+        initEnvironment.Push(String("PATH=/usr/bin"));
+        initEnvironment.Push(String("HOME=/root"));
+        initEnvironment.Push(String("TERM=linux"));
 
-        Scheduler::CreateTaskFromELF(String(SHELL_PATH), shellArguments, shellEnvironment);
+        Scheduler::CreateTaskFromELF(initPath, initArguments, initEnvironment);
     }
+    BootProfiler::Record(BootPhase::InitTask, phaseStart);
 
     Scheduler::StartCores(tss);
 
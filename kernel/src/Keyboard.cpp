@@ -1,11 +1,31 @@
 #include "Keyboard.h"
 #include "TerminalDevice.h"
+#include "KeyboardDevice.h"
+#include "WorkQueue.h"
+#include "IRQ.h"
+#include "IO.h"
 
 bool leftShifting = false;
 bool rightShifting = false;
 const char chars[] = "\e\e1234567890-=\b\tqwertyuiop[]\n\easdfghjkl;\'`\e\\zxcvbnm,./\e*\e ";
 const char shiftChars[] = "\e\e!@#$%^&*()_+\b\tQWERTYUIOP{}\n\eASDFGHJKL:\"~\e|ZXCVBNM<>?\e*\e ";
 
+void Keyboard::Initialize()
+{
+    IRQ::RouteLegacy(1, InterruptHandler, 0);
+}
+
+void Keyboard::InterruptHandler(uint64_t)
+{
+    uint8_t scanCode = inb(0x60);
+    Assert(scanCode != 0);
+
+    // The event is recorded right away so that its timestamp is accurate,
+    // but echoing to the terminal can take a while and is left to this core's work queue
+    KeyboardDevice::instance->KeyboardInput(scanCode);
+    WorkQueue::QueueLocal([](uint64_t argument) { SendKeyToTerminal(argument); }, scanCode);
+}
+
 void Keyboard::SendKeyToTerminal(uint8_t scanCode)
 {
     if (scanCode == 0x2a) leftShifting = true;
@@ -1,68 +1,118 @@
 #include "KeyboardDevice.h"
+#include "Scheduler.h"
+#include "Heap.h"
 
-KeyboardDevice* KeyboardDevice::instance = nullptr;
+constexpr uint64_t EVENT_BUFFER_SIZE = 256;
 
-constexpr uint64_t BUFFER_SIZE = 64;
-uint8_t ringBuffer[BUFFER_SIZE];
-uint64_t readIndex = 0;
-uint64_t writeIndex = 0;
+KeyboardDevice* KeyboardDevice::instance = nullptr;
 
-uint8_t GetFromBuffer()
+// The position is the sequence of the next event
+uint64_t KeyboardDevice::ReadStream(void* buffer, uint64_t count, uint64_t& nextEvent, bool nonBlocking, Error& error)
 {
-    if (readIndex >= writeIndex)
+    auto readEvents = static_cast<KeyboardEvent*>(buffer);
+    uint64_t maxCount = count / sizeof(KeyboardEvent);
+    if (maxCount == 0)
     {
-        Assert(readIndex == writeIndex);
+        error = Error::InvalidArgument;
         return 0;
     }
 
-    uint8_t item = ringBuffer[readIndex % BUFFER_SIZE];
-    readIndex++;
-    return item;
-}
+    lock.Acquire();
 
-void PushToBuffer(uint8_t scanCode)
-{
-    ringBuffer[writeIndex % BUFFER_SIZE] = scanCode;
-    writeIndex++;
-}
-
-uint64_t KeyboardDevice::Read(void* buffer, uint64_t count, uint64_t position)
-{
-    // Temporarily solution for DOOM to work
-    static bool flushed = false;
-    if (!flushed)
+    while (nextEvent == eventCount)
     {
-        readIndex = 0;
-        writeIndex = 0;
-        flushed = true;
+        if (nonBlocking)
+        {
+            lock.Release();
+            error = Error::WouldBlock;
+            return 0;
+        }
+
+        Scheduler* scheduler = Scheduler::GetScheduler();
+        unblockQueue.Push({scheduler->currentTask.pid, scheduler->currentTask.suspensionId});
+        lock.Release();
+
+        scheduler->SuspendSystemCall(TaskState::Blocked);
+
+        lock.Acquire();
     }
 
-    Assert(count == 1);
-    Assert(position == 0);
+    uint64_t readCount = 0;
+    if (eventCount - nextEvent > EVENT_BUFFER_SIZE)
+    {
+        uint64_t oldestEvent = eventCount - EVENT_BUFFER_SIZE;
+        readEvents[readCount++] = {Scheduler::GetClock(), KEYBOARD_EVENTS_DROPPED, static_cast<uint32_t>(oldestEvent - nextEvent)};
+        nextEvent = oldestEvent;
+    }
 
-    uint8_t scanCode = GetFromBuffer();
-    if (scanCode != 0)
+    while (readCount < maxCount && nextEvent < eventCount)
     {
-        *static_cast<uint8_t*>(buffer) = scanCode;
-        return count;
+        readEvents[readCount++] = events[nextEvent++ % EVENT_BUFFER_SIZE];
     }
 
-    return 0;
+    lock.Release();
+    return readCount * sizeof(KeyboardEvent);
+}
+
+// Readers only see the events that happen after they open the keyboard
+uint64_t KeyboardDevice::GetStreamStart()
+{
+    lock.Acquire();
+    uint64_t count = eventCount;
+    lock.Release();
+    return count;
 }
 
 uint64_t KeyboardDevice::Write(const void* buffer, uint64_t count, uint64_t position)
 {
-    Assert(count == 1);
     Assert(position == 0);
 
-    uint8_t scanCode = *static_cast<const uint8_t*>(buffer);
-    PushToBuffer(scanCode);
+    // Written scan codes are handled as if they came from the keyboard
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        KeyboardInput(static_cast<const uint8_t*>(buffer)[i]);
+    }
 
     return count;
 }
 
+void KeyboardDevice::KeyboardInput(uint8_t scanCode)
+{
+    lock.Acquire();
+
+    if (scanCode == 0xe0)
+    {
+        extendedPrefix = true;
+        lock.Release();
+        return;
+    }
+
+    uint32_t code = (scanCode & 0x7f) | (extendedPrefix ? 0x100 : 0);
+    bool pressed = (scanCode & 0x80) == 0;
+    extendedPrefix = false;
+
+    uint32_t value = pressed ? (pressedKeys[code] ? 2 : 1) : 0;
+    pressedKeys[code] = pressed;
+
+    events[eventCount++ % EVENT_BUFFER_SIZE] = {Scheduler::GetClock(), code, value};
+    WakeReaders();
+
+    lock.Release();
+}
+
+void KeyboardDevice::WakeReaders()
+{
+    while (!unblockQueue.IsEmpty())
+    {
+        ReadRequest request = unblockQueue.Pop();
+        Scheduler::Unsuspend(request.pid, request.suspensionId, 0);
+    }
+}
+
 KeyboardDevice::KeyboardDevice(const String& name, uint32_t inodeNum) : Device(name, inodeNum)
 {
     Assert(instance == nullptr);
     instance = this;
+
+    events = new (Allocator::Permanent) KeyboardEvent[EVENT_BUFFER_SIZE];
 }
@@ -0,0 +1,49 @@
+#include "KmsgDevice.h"
+#include "Serial.h"
+
+constexpr uint64_t KMSG_MAX_WRITE_SIZE = 160;
+
+uint64_t KmsgDevice::ReadStream(void* buffer, uint64_t count, uint64_t& sequence, bool nonBlocking, Error& error)
+{
+    (void)nonBlocking;
+    return Serial::ReadRecord(static_cast<char*>(buffer), count, sequence, error);
+}
+
+uint64_t KmsgDevice::Write(const void* buffer, uint64_t count, uint64_t position)
+{
+    auto data = static_cast<const char*>(buffer);
+
+    char message[KMSG_MAX_WRITE_SIZE + 1];
+    uint64_t length = 0;
+    for (uint64_t i = 0; i < count && length < KMSG_MAX_WRITE_SIZE; ++i)
+    {
+        if (data[i] != '\n') message[length++] = data[i];
+    }
+    message[length] = 0;
+
+    Serial::Log("%s", message);
+
+    (void)position;
+    return count;
+}
+
+uint64_t KmsgDevice::Control(uint64_t request, void* argument, Error& error)
+{
+    if (request != static_cast<uint64_t>(KmsgRequest::SetLevel))
+    {
+        error = Error::InvalidArgument;
+        return 0;
+    }
+
+    uint32_t level = *static_cast<uint32_t*>(argument);
+    if (level > static_cast<uint32_t>(LogLevel::Error))
+    {
+        error = Error::InvalidArgument;
+        return 0;
+    }
+
+    Serial::SetLevel(static_cast<LogLevel>(level));
+    return 0;
+}
+
+KmsgDevice::KmsgDevice(const String& name, uint32_t inodeNum) : Device(name, inodeNum) {}
@@ -1,36 +1,92 @@
 #include "LAPIC.h"
 #include "PIT.h"
+#include "CPU.h"
+#include "Serial.h"
 #include "Memory/Memory.h"
 #include "Assert.h"
+#include "BootProfiler.h"
 
 constexpr uint64_t APIC_EIO_OFFSET = 0xb0;
 constexpr uint64_t APIC_SPURIOUS_INTERRUPT_VECTOR = 0xf0;
+constexpr uint64_t APIC_INTERRUPT_COMMAND_LOW = 0x300;
+constexpr uint64_t APIC_INTERRUPT_COMMAND_HIGH = 0x310;
 constexpr uint64_t APIC_DIVIDE_CONFIG = 0x3e0;
 constexpr uint64_t APIC_LVT_TIMER = 0x320;
 constexpr uint64_t APIC_INITIAL_COUNT = 0x380;
 constexpr uint64_t APIC_CURRENT_COUNT = 0x390;
 
+constexpr uint32_t APIC_BASE_MSR = 0x1b;
+constexpr uint64_t APIC_BASE_ENABLE = 1 << 11;
+constexpr uint64_t APIC_BASE_X2APIC = 1 << 10;
+
+// In x2APIC mode, every register at xAPIC offset n is the MSR X2APIC_MSR_BASE + n / 16
+constexpr uint32_t X2APIC_MSR_BASE = 0x800;
+
+uint64_t calibratedTimerBaseFrequency = 0;
+
 void LAPIC::SendEOI()
 {
-    *(volatile uint32_t*)(apicRegisterBase + APIC_EIO_OFFSET) = 0;
+    WriteRegister(APIC_EIO_OFFSET, 0);
+}
+
+// Core IDs are the LAPIC IDs of the cores, see InitializeCore
+void LAPIC::SendIPI(uint32_t destinationCore, uint8_t vector)
+{
+    // Fixed delivery mode, physical destination mode, no shorthand
+    if (x2apic)
+    {
+        // The x2APIC ICR is a single 64-bit MSR, so the IPI is sent with one write
+        uint64_t command = static_cast<uint64_t>(destinationCore) << 32 | vector;
+        asm volatile("wrmsr" : : "c"(X2APIC_MSR_BASE + APIC_INTERRUPT_COMMAND_LOW / 16),
+                     "a"(command & 0xffffffff), "d"(command >> 32));
+    }
+    else
+    {
+        // Wait for the previous IPI to be accepted
+        while (ReadRegister(APIC_INTERRUPT_COMMAND_LOW) & (1 << 12)) asm volatile("pause");
+
+        WriteRegister(APIC_INTERRUPT_COMMAND_HIGH, destinationCore << 24);
+        WriteRegister(APIC_INTERRUPT_COMMAND_LOW, vector);
+    }
 }
 
 LAPIC::LAPIC()
 {
-    apicRegisterBase = HigherHalf((GetBaseMSR() & ~0xfff));
+    uint64_t baseMSR = GetBaseMSR();
+    apicRegisterBase = HigherHalf((baseMSR & ~0xfff));
+
+    // CPUID.01H:ECX bit 21 advertises x2APIC support.
+    // The switch has to be done on every core, since the mode is part of each core's IA32_APIC_BASE.
+    uint32_t eax = 1, ebx, ecx, edx;
+    asm volatile("cpuid" : "+a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx));
+    x2apic = ecx & (1 << 21);
+
+    if (x2apic)
+    {
+        baseMSR |= APIC_BASE_ENABLE | APIC_BASE_X2APIC;
+        asm volatile("wrmsr" : : "c"(APIC_BASE_MSR), "a"(baseMSR & 0xffffffff), "d"(baseMSR >> 32));
+    }
 
     // Activate LAPIC and map the Spurious Interrupt Vector to interrupt gate 255
-    *(volatile uint32_t*)(apicRegisterBase + APIC_SPURIOUS_INTERRUPT_VECTOR) = 0x1ff;
+    WriteRegister(APIC_SPURIOUS_INTERRUPT_VECTOR, 0x1ff);
 
     // Divide by 2
-    *(volatile uint32_t*)(apicRegisterBase + APIC_DIVIDE_CONFIG) = 0;
+    WriteRegister(APIC_DIVIDE_CONFIG, 0);
 
     // Interrupt gate 48, one-shot
-    *(volatile uint32_t*)(apicRegisterBase + APIC_LVT_TIMER) = 0b00'0'000'0'0000'00110000;
-
-    lapicTimerBaseFrequency = GetTimerBaseFrequency();
-
-    *(volatile uint32_t*)(apicRegisterBase + APIC_INITIAL_COUNT) = 0;
+    WriteRegister(APIC_LVT_TIMER, 0b00'0'000'0'0000'00110000);
+
+    // The timers of all cores run at the same rate, so only the BSP calibrates its own against the PIT.
+    // The APs start after it, and calibrating them at the same time would have them all program the one PIT.
+    if (calibratedTimerBaseFrequency == 0)
+    {
+        uint64_t calibrationStart = CPU::ReadTimestampCounter();
+        calibratedTimerBaseFrequency = GetTimerBaseFrequency();
+        BootProfiler::Record(BootPhase::TimerCalibration, calibrationStart);
+    }
+    lapicTimerBaseFrequency = calibratedTimerBaseFrequency;
+
+    WriteRegister(APIC_INITIAL_COUNT, 0);
 }
 
 void LAPIC::SetTimeBetweenTimerFires(uint64_t milliseconds)
@@ -38,38 +94,44 @@ void LAPIC::SetTimeBetweenTimerFires(uint64_t milliseconds)
     uint64_t count = lapicTimerBaseFrequency * milliseconds / 1000;
 
     Assert(count <= UINT32_MAX);
-    *(volatile uint32_t*)(apicRegisterBase + APIC_INITIAL_COUNT) = static_cast<uint32_t>(count);
+    WriteRegister(APIC_INITIAL_COUNT, static_cast<uint32_t>(count));
 }
 
 uint64_t LAPIC::GetTimeRemainingMilliseconds() const
 {
-    uint64_t count = *(volatile uint32_t*)(apicRegisterBase + APIC_CURRENT_COUNT);
+    uint64_t count = ReadRegister(APIC_CURRENT_COUNT);
     return count * 1000 / lapicTimerBaseFrequency;
 }
 
 uint64_t LAPIC::GetTimerBaseFrequency()
 {
-    // Initialize variables and pointers here to make instructions as fast as possible while calibrating.
     uint64_t lapicTicksCount = 0xfffff;
-    auto currentCountRegister = (volatile uint32_t*)(apicRegisterBase + APIC_CURRENT_COUNT);
-    auto initialCountRegister = (volatile uint32_t*)(apicRegisterBase + APIC_INITIAL_COUNT);
 
     // Set the PIT's reload value to its max value so that the PIT takes a long time to reset the
     // current tick value to 0, so that the LAPIC timer has enough time to tick {lapicTicksCount} times.
     PITSetReloadValue(UINT16_MAX);
 
     uint16_t initialPITTick = PITGetTick();
+    uint64_t initialTimestamp = CPU::ReadTimestampCounter();
 
     // Set the number of samples
-    *initialCountRegister = lapicTicksCount;
+    WriteRegister(APIC_INITIAL_COUNT, lapicTicksCount);
 
     // Wait until the LAPIC finishes counting
-    while (*currentCountRegister != 0) continue;
+    while (ReadRegister(APIC_CURRENT_COUNT) != 0) continue;
 
     uint16_t endPITTick = PITGetTick();
+    uint64_t endTimestamp = CPU::ReadTimestampCounter();
 
     // Stop the LAPIC timer
-    *initialCountRegister = 0;
+    WriteRegister(APIC_INITIAL_COUNT, 0);
+
+    // The TSC runs at the same rate on every core, the first calibration is good enough for all of them
+    if (CPU::GetTimestampCounterFrequency() == 0)
+    {
+        CPU::SetTimestampCounterFrequency((endTimestamp - initialTimestamp) / (initialPITTick - endPITTick) * PIT_BASE_FREQUENCY);
+        Serial::Log("TSC frequency: %d Hz", CPU::GetTimestampCounterFrequency());
+    }
 
     return (lapicTicksCount / (initialPITTick - endPITTick)) * PIT_BASE_FREQUENCY;
 }
@@ -78,6 +140,31 @@ uint64_t LAPIC::GetBaseMSR()
 {
     uint32_t low;
     uint32_t high;
-    asm volatile("rdmsr" : "=a"(low), "=d"(high) : "c"(0x1b));
+    asm volatile("rdmsr" : "=a"(low), "=d"(high) : "c"(APIC_BASE_MSR));
     return (uint64_t)high << 32 | low;
-}
\ No newline at end of file
+}
+
+uint32_t LAPIC::ReadRegister(uint64_t offset) const
+{
+    if (x2apic)
+    {
+        uint32_t low;
+        uint32_t high;
+        asm volatile("rdmsr" : "=a"(low), "=d"(high) : "c"(X2APIC_MSR_BASE + offset / 16));
+        return low;
+    }
+
+    return *reinterpret_cast<volatile uint32_t*>(apicRegisterBase + offset);
+}
+
+void LAPIC::WriteRegister(uint64_t offset, uint32_t value)
+{
+    if (x2apic)
+    {
+        asm volatile("wrmsr" : : "c"(X2APIC_MSR_BASE + offset / 16), "a"(value), "d"(0));
+    }
+    else
+    {
+        *reinterpret_cast<volatile uint32_t*>(apicRegisterBase + offset) = value;
+    }
+}
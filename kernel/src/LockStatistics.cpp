@@ -0,0 +1,134 @@
+#include "LockStatistics.h"
+#include "PerCoreRing.h"
+#include "Memory/Memory.h"
+
+constexpr uint64_t LOCK_CLASS_COUNT = static_cast<uint64_t>(LockClass::Count);
+
+const char* lockClassNames[LOCK_CLASS_COUNT] =
+{
+    "Unclassified",
+    "TaskQueue",
+    "PageFrameBitmap",
+    "Slab",
+    "PermanentAllocator",
+    "PagingManager",
+    "IRQ",
+    "IOAPIC",
+    "WorkQueue",
+    "Terminal",
+    "TerminalOutput",
+    "Keyboard",
+    "LogDrain",
+    "AllocationProfiler"
+};
+
+struct LockClassStatistics
+{
+    uint64_t acquisitions;
+    uint64_t contentions;
+    uint64_t spinCycles;
+    uint64_t maxSpinCycles;
+    uintptr_t maxSpinCaller;
+    uint64_t holdCycles;
+    uint64_t maxHoldCycles;
+    uintptr_t maxHoldCaller;
+};
+
+LockClassStatistics lockStatistics[PER_CORE_RING_MAX_CORES][LOCK_CLASS_COUNT];
+
+void LockStatistics::RecordAcquisition(LockClass lockClass, bool contended, uint64_t spinCycles, uintptr_t caller)
+{
+    uint32_t coreId = CPU::GetCoreID();
+    if (coreId >= PER_CORE_RING_MAX_CORES) return;
+
+    LockClassStatistics& statistics = lockStatistics[coreId][static_cast<uint64_t>(lockClass)];
+    statistics.acquisitions++;
+    if (!contended) return;
+
+    statistics.contentions++;
+    statistics.spinCycles += spinCycles;
+    if (spinCycles > statistics.maxSpinCycles)
+    {
+        statistics.maxSpinCycles = spinCycles;
+        statistics.maxSpinCaller = caller;
+    }
+}
+
+void LockStatistics::RecordRelease(LockClass lockClass, uint64_t holdCycles, uintptr_t caller)
+{
+    uint32_t coreId = CPU::GetCoreID();
+    if (coreId >= PER_CORE_RING_MAX_CORES) return;
+
+    LockClassStatistics& statistics = lockStatistics[coreId][static_cast<uint64_t>(lockClass)];
+    statistics.holdCycles += holdCycles;
+    if (holdCycles > statistics.maxHoldCycles)
+    {
+        statistics.maxHoldCycles = holdCycles;
+        statistics.maxHoldCaller = caller;
+    }
+}
+
+// One line per lock class that was used, cycles are TSC ticks and callers are where the lock was acquired
+void LockStatistics::Report(TextWriter& writer)
+{
+#ifdef LOCK_STATISTICS
+    writer.Write("TSC frequency: ");
+    writer.WriteDecimal(CPU::GetTimestampCounterFrequency());
+    writer.Write(" Hz\n");
+
+    writer.Write("class");
+    writer.Pad(20);
+    writer.Write("  acquisitions   contentions     spin total       spin max  spin max caller");
+    writer.Pad(98);
+    writer.Write("    hold total       hold max  hold max caller\n");
+
+    for (uint64_t lockClass = 0; lockClass < LOCK_CLASS_COUNT; ++lockClass)
+    {
+        LockClassStatistics total {};
+        for (uint32_t coreId = 0; coreId < PER_CORE_RING_MAX_CORES; ++coreId)
+        {
+            const LockClassStatistics& statistics = lockStatistics[coreId][lockClass];
+            total.acquisitions += statistics.acquisitions;
+            total.contentions += statistics.contentions;
+            total.spinCycles += statistics.spinCycles;
+            total.holdCycles += statistics.holdCycles;
+
+            if (statistics.maxSpinCycles > total.maxSpinCycles)
+            {
+                total.maxSpinCycles = statistics.maxSpinCycles;
+                total.maxSpinCaller = statistics.maxSpinCaller;
+            }
+
+            if (statistics.maxHoldCycles > total.maxHoldCycles)
+            {
+                total.maxHoldCycles = statistics.maxHoldCycles;
+                total.maxHoldCaller = statistics.maxHoldCaller;
+            }
+        }
+
+        if (total.acquisitions == 0) continue;
+
+        writer.Write(lockClassNames[lockClass]);
+        writer.Pad(20);
+        writer.WriteDecimal(total.acquisitions, 14);
+        writer.WriteDecimal(total.contentions, 14);
+        writer.WriteDecimal(total.spinCycles, 15);
+        writer.WriteDecimal(total.maxSpinCycles, 15);
+        writer.Write("  ");
+        writer.WriteHex(total.maxSpinCaller);
+        writer.Pad(98);
+        writer.WriteDecimal(total.holdCycles, 14);
+        writer.WriteDecimal(total.maxHoldCycles, 15);
+        writer.Write("  ");
+        writer.WriteHex(total.maxHoldCaller);
+        writer.Write('\n');
+    }
+#else
+    writer.Write("Lock statistics are not collected, build the kernel with -DLOCK_STATISTICS\n");
+#endif
+}
+
+void LockStatistics::Clear()
+{
+    memset(lockStatistics, 0, sizeof(lockStatistics));
+}
@@ -0,0 +1,20 @@
+#include "LockStatisticsDevice.h"
+#include "LockStatistics.h"
+
+uint64_t LockStatisticsDevice::Read(void* buffer, uint64_t count, uint64_t position)
+{
+    TextWriter writer(static_cast<char*>(buffer), count, position);
+    LockStatistics::Report(writer);
+    return writer.GetWrittenCount();
+}
+
+uint64_t LockStatisticsDevice::Write(const void* buffer, uint64_t count, uint64_t position)
+{
+    LockStatistics::Clear();
+
+    (void)buffer;
+    (void)position;
+    return count;
+}
+
+LockStatisticsDevice::LockStatisticsDevice(const String& name, uint32_t inodeNum) : Device(name, inodeNum) {}
@@ -29,6 +29,11 @@ uintptr_t HigherHalf(uintptr_t physAddr)
 	return physAddr + 0xffff'8000'0000'0000;
 }
 
+uintptr_t LowerHalf(uintptr_t virtAddr)
+{
+	return virtAddr - 0xffff'8000'0000'0000;
+}
+
 bool memcmp(const void* left, const void* right, uint64_t count)
 {
 	auto x = static_cast<const uint8_t*>(left);
@@ -6,13 +6,20 @@
 #include "Bitmap.h"
 #include "Spinlock.h"
 #include "Heap.h"
+#include "AllocationProfiler.h"
 
 Bitmap pageFrameBitmap = Bitmap(nullptr, 0, false);
-Spinlock pageFrameBitmapLock;
+Spinlock pageFrameBitmapLock {LockClass::PageFrameBitmap};
 
 uint64_t pageFrameCount = 0;
+uint64_t usablePageFrameCount = 0;
+uint64_t usedPageFrameCount = 0;
 uint64_t latestAllocatedPageFrame = 0;
 
+#ifdef ALLOCATION_PROFILING
+AllocationTag* pageFrameTags = nullptr;
+#endif
+
 void InitializePageFrameAllocator()
 {
     auto memoryMapStruct = (stivale2_struct_tag_memmap*)GetStivale2Tag(STIVALE2_STRUCT_TAG_MEMMAP_ID);
@@ -22,11 +29,17 @@ void InitializePageFrameAllocator()
     pageFrameCount = memorySize / 0x1000;
     uint64_t bitmapSize = pageFrameCount / 8;
 
+    // The allocation profiler's tags for every page frame are placed right after the bitmap
+    uint64_t reservedSize = bitmapSize;
+#ifdef ALLOCATION_PROFILING
+    reservedSize += pageFrameCount * sizeof(AllocationTag);
+#endif
+
     uint8_t* bitmapBuffer = nullptr;
     for (uint64_t entryIndex = 0; entryIndex < memoryMapStruct->entries; ++entryIndex)
     {
         stivale2_mmap_entry memoryMapEntry = memoryMapStruct->memmap[entryIndex];
-        if (memoryMapEntry.type == 1 && memoryMapEntry.length > bitmapSize)
+        if (memoryMapEntry.type == 1 && memoryMapEntry.length > reservedSize)
         {
             bitmapBuffer = reinterpret_cast<uint8_t*>(HigherHalf(memoryMapEntry.base));
             break;
@@ -45,6 +58,7 @@ void InitializePageFrameAllocator()
         if (memoryMapEntry.type == 1)
         {
             uint64_t basePageFrame = memoryMapEntry.base / 0x1000;
+            usablePageFrameCount += memoryMapEntry.length / 0x1000;
             for (uint64_t pageFrame = 0; pageFrame < memoryMapEntry.length / 0x1000; ++pageFrame)
             {
                 pageFrameBitmap.SetBit(basePageFrame + pageFrame, false);
@@ -53,14 +67,39 @@ void InitializePageFrameAllocator()
     }
 
     uint64_t bitmapBasePageFrame = ((uint64_t)bitmapBuffer - 0xffff'8000'0000'0000) / 0x1000;
-    for (uint64_t bitmapPage = 0; bitmapPage < bitmapSize / 0x1000; ++bitmapPage)
+    for (uint64_t bitmapPage = 0; bitmapPage < (reservedSize + 0xfff) / 0x1000; ++bitmapPage)
     {
         pageFrameBitmap.SetBit(bitmapBasePageFrame + bitmapPage, true);
     }
+    usedPageFrameCount = (reservedSize + 0xfff) / 0x1000;
+
+#ifdef ALLOCATION_PROFILING
+    pageFrameTags = reinterpret_cast<AllocationTag*>(bitmapBuffer + bitmapSize);
+    memset(pageFrameTags, 0, pageFrameCount * sizeof(AllocationTag));
+    AllocationProfiler::RegisterTags(pageFrameTags, pageFrameCount, 0x1000);
+#endif
+}
+
+void TagPageFrames(uint64_t firstPageFrame, uint64_t count, uintptr_t caller)
+{
+#ifdef ALLOCATION_PROFILING
+    uint32_t site = AllocationProfiler::RecordAllocation(AllocationKind::PageFrame, caller, count * 0x1000);
+    uint32_t pid = AllocationProfiler::GetCurrentPid();
+    for (uint64_t pageFrame = firstPageFrame; pageFrame < firstPageFrame + count; ++pageFrame)
+    {
+        pageFrameTags[pageFrame] = {pid, site};
+    }
+#else
+    (void)firstPageFrame;
+    (void)count;
+    (void)caller;
+#endif
 }
 
 uintptr_t RequestPageFrame()
 {
+    auto caller = reinterpret_cast<uintptr_t>(__builtin_return_address(0));
+
     pageFrameBitmapLock.Acquire();
 
     // Find first free page frame, starting from page frame with the lowest physical address (0)
@@ -69,8 +108,12 @@ uintptr_t RequestPageFrame()
         if (!pageFrameBitmap.GetBit(latestAllocatedPageFrame))
         {
             pageFrameBitmap.SetBit(latestAllocatedPageFrame, true);
+            usedPageFrameCount++;
+            uint64_t pageFrame = latestAllocatedPageFrame;
             pageFrameBitmapLock.Release();
-            return latestAllocatedPageFrame * 0x1000;
+
+            TagPageFrames(pageFrame, 1, caller);
+            return pageFrame * 0x1000;
         }
     }
 
@@ -80,6 +123,11 @@ uintptr_t RequestPageFrame()
 }
 
 uintptr_t RequestPageFrames(uint64_t count)
+{
+    return RequestPageFrames(count, reinterpret_cast<uintptr_t>(__builtin_return_address(0)));
+}
+
+uintptr_t RequestPageFrames(uint64_t count, uintptr_t caller)
 {
     pageFrameBitmapLock.Acquire();
 
@@ -96,7 +144,10 @@ uintptr_t RequestPageFrames(uint64_t count)
                 {
                     pageFrameBitmap.SetBit(pageFrame, true);
                 }
+                usedPageFrameCount += count;
                 pageFrameBitmapLock.Release();
+
+                TagPageFrames(first, count, caller);
                 return first * 0x1000;
             }
         }
@@ -119,6 +170,12 @@ void FreePageFrame(void* ptr)
 
     Assert(pageFrameBitmap.GetBit(pageFrame));
     pageFrameBitmap.SetBit(pageFrame, false);
+    usedPageFrameCount--;
+
+#ifdef ALLOCATION_PROFILING
+    AllocationProfiler::RecordFree(pageFrameTags[pageFrame].site, 0x1000);
+    pageFrameTags[pageFrame] = {};
+#endif
 
     pageFrameBitmapLock.Release();
 }
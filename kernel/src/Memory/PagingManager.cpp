@@ -3,9 +3,13 @@
 #include "Memory/PagingManager.h"
 #include "Stivale2Interface.h"
 #include "Assert.h"
+#include "Trace.h"
 
 constexpr unsigned int PAGING_LEVELS = 4;
+constexpr uint64_t USERSPACE_PML4_ENTRY_COUNT = 256;
+constexpr uintptr_t USERSPACE_END = 0x0000'8000'0000'0000;
 PagingManager::PageTableEntry* PagingManager::defaultPml4 = nullptr;
+PagingManager PagingManager::kernelAddressSpace;
 
 void PagingManager::GetPageTableIndexes(const void* virtAddr, uint16_t* pageIndexes)
 {
@@ -51,18 +55,23 @@ void PagingManager::InitializePaging()
     memset(pml4, 0, 0x1000 / 2);
 
     Assert(defaultPml4 != nullptr);
-    memcpy(pml4 + 256, defaultPml4 + 256, 0x1000 / 2);
+    memcpy(pml4 + USERSPACE_PML4_ENTRY_COUNT, defaultPml4 + USERSPACE_PML4_ENTRY_COUNT, 0x1000 / 2);
 
     lock.Release();
 }
 
 void PagingManager::CopyUserspace(PagingManager& original)
 {
+    uint64_t traceStart = TraceBegin(AddressSpaceCopy);
+
     original.lock.Acquire();
     lock.Acquire();
-    CopyPages(original.pml4, pml4, 256, PAGING_LEVELS - 1);
+    CopyPages(original.pml4, pml4, USERSPACE_PML4_ENTRY_COUNT, PAGING_LEVELS - 1);
+    userPageCount = original.userPageCount;
     lock.Release();
     original.lock.Release();
+
+    TraceEnd(AddressSpaceCopy, traceStart, pml4PhysAddr, original.pml4PhysAddr);
 }
 
 void PagingManager::CopyPages(const PageTableEntry* originalTable, PageTableEntry* table, uint64_t pageCount, unsigned int level)
@@ -76,6 +85,9 @@ void PagingManager::CopyPages(const PageTableEntry* originalTable, PageTableEntr
             Assert(!entry.GetFlag(PagingFlag::Present));
 
             memcpy(&entry, &originalEntry, sizeof(PageTableEntry));
+            // Both address spaces keep pointing at the same device memory, only page frames are copied
+            if (level == 0 && entry.GetFlag(PagingFlag::Device)) continue;
+
             auto originalNext = reinterpret_cast<PageTableEntry*>(HigherHalf(entry.GetPhysicalAddress()));
 
             uintptr_t nextPhysAddr = RequestPageFrame();
@@ -101,12 +113,33 @@ void PagingManager::SetCR3() const
 }
 
 void PagingManager::MapMemory(const void* virtAddr, const void* physAddr)
+{
+    lock.Acquire();
+    MapPage(virtAddr, physAddr);
+    if (reinterpret_cast<uintptr_t>(virtAddr) < USERSPACE_END) userPageCount++;
+    lock.Release();
+
+    TracePoint(PageMap, reinterpret_cast<uint64_t>(virtAddr), reinterpret_cast<uint64_t>(physAddr));
+}
+
+void PagingManager::MapDeviceMemory(const void* virtAddr, const void* physAddr, bool writeCombining)
+{
+    lock.Acquire();
+    PageTableEntry& page = MapPage(virtAddr, physAddr);
+    page.SetFlag(PagingFlag::Device, true);
+    if (writeCombining) page.SetFlag(PagingFlag::PAT, true);
+    lock.Release();
+
+    TracePoint(PageMap, reinterpret_cast<uint64_t>(virtAddr), reinterpret_cast<uint64_t>(physAddr));
+}
+
+// Called with the lock held
+PagingManager::PageTableEntry& PagingManager::MapPage(const void* virtAddr, const void* physAddr)
 {
     uint16_t pageIndexes[PAGING_LEVELS];
     GetPageTableIndexes(virtAddr, pageIndexes);
 
     auto table = pml4;
-    lock.Acquire();
     for (unsigned int level = PAGING_LEVELS - 1; level > 0; --level)
     {
         auto& entry = table[pageIndexes[level]];
@@ -124,7 +157,7 @@ void PagingManager::MapMemory(const void* virtAddr, const void* physAddr)
     Assert(!page.GetFlag(PagingFlag::Present));
 
     PopulatePagingStructureEntry(page, reinterpret_cast<uintptr_t>(physAddr));
-    lock.Release();
+    return page;
 }
 
 unsigned int PagingManager::FlagMismatchLevel(const void* virtAddr, PagingFlag flag, bool enabled)
@@ -140,6 +173,7 @@ unsigned int PagingManager::FlagMismatchLevel(const void* virtAddr, PagingFlag f
         auto& entry = table[i];
         if (entry.GetFlag(flag) != enabled)
         {
+            lock.Release();
             return level + 1;
         }
         table = reinterpret_cast<PageTableEntry*>(HigherHalf(entry.GetPhysicalAddress()));
@@ -155,23 +189,74 @@ unsigned int PagingManager::PageNotPresentLevel(const void* virtAddr)
     return FlagMismatchLevel(virtAddr, PagingFlag::Present, true);
 }
 
+void PagingManager::GetUserMappings(Vector<Mapping>& mappings)
+{
+    lock.Acquire();
+    AddUserMappings(pml4, 0, PAGING_LEVELS - 1, true, true, mappings);
+    lock.Release();
+}
+
+// The permissions of a page are the most restrictive ones along the way to it
+void PagingManager::AddUserMappings(const PageTableEntry* table, uintptr_t tableStart, unsigned int level, bool writable,
+                                    bool executable, Vector<Mapping>& mappings)
+{
+    uint64_t entryCount = level == PAGING_LEVELS - 1 ? USERSPACE_PML4_ENTRY_COUNT : 512;
+    uint64_t entrySize = 0x1000ull << (9 * level);
+
+    for (uint64_t entryIndex = 0; entryIndex < entryCount; ++entryIndex)
+    {
+        const auto& entry = table[entryIndex];
+        if (!entry.GetFlag(PagingFlag::Present)) continue;
+
+        uintptr_t start = tableStart + entryIndex * entrySize;
+        bool entryWritable = writable && entry.GetFlag(PagingFlag::AllowWrite);
+        bool entryExecutable = executable && !entry.GetFlag(PagingFlag::NX);
+
+        if (level > 0)
+        {
+            auto next = reinterpret_cast<const PageTableEntry*>(HigherHalf(entry.GetPhysicalAddress()));
+            AddUserMappings(next, start, level - 1, entryWritable, entryExecutable, mappings);
+            continue;
+        }
+
+        if (!mappings.IsEmpty())
+        {
+            Mapping& last = mappings.Get(mappings.GetLength() - 1);
+            if (last.end == start && last.writable == entryWritable && last.executable == entryExecutable)
+            {
+                last.end += entrySize;
+                continue;
+            }
+        }
+        mappings.Push({start, start + entrySize, entryWritable, entryExecutable});
+    }
+}
+
+uint64_t PagingManager::GetUserPageCount() const
+{
+    return userPageCount;
+}
+
 void PagingManager::SaveBootloaderAddressSpace()
 {
     Assert(defaultPml4 == nullptr);
     uint64_t bootloaderPml4PhysAddr;
     asm volatile("mov %%cr3, %0" : "=r"(bootloaderPml4PhysAddr));
     defaultPml4 = reinterpret_cast<PageTableEntry*>(HigherHalf(bootloaderPml4PhysAddr));
+
+    kernelAddressSpace.pml4PhysAddr = bootloaderPml4PhysAddr;
+    kernelAddressSpace.pml4 = defaultPml4;
 }
 
 void PagingManager::PageTableEntry::SetFlag(PagingFlag flag, bool enable)
 {
-    if (enable) value |= (1 << (uint64_t)flag);
-    else value &= ~(1 << (uint64_t)flag);
+    if (enable) value |= (1ull << (uint64_t)flag);
+    else value &= ~(1ull << (uint64_t)flag);
 }
 
 bool PagingManager::PageTableEntry::GetFlag(PagingFlag flag) const
 {
-    return value & (1 << (uint64_t)flag);
+    return value & (1ull << (uint64_t)flag);
 }
 
 void PagingManager::PageTableEntry::SetPhysicalAddress(uint64_t physAddr)
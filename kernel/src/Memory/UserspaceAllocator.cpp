@@ -5,4 +5,16 @@ void* UserspaceAllocator::AllocatePages(uint64_t pageCount)
     void* addr = reinterpret_cast<void*>(currentAddr);
     currentAddr += pageCount * 0x1000;
     return addr;
-}
\ No newline at end of file
+}
+
+// Keeps the allocator from handing out a range that is mapped some other way. Everything below where it starts
+// is left to the program, ranges at or past its next address are stepped over, the ones in between are taken.
+bool UserspaceAllocator::Reserve(uintptr_t addr, uint64_t pageCount)
+{
+    uintptr_t end = addr + pageCount * 0x1000;
+    if (end <= START) return true;
+    if (addr < currentAddr) return false;
+
+    currentAddr = end;
+    return true;
+}
@@ -29,15 +29,4 @@ void InitializePIC()
     // Mask all PIC IRQs by default
     outb(MASTER_DATA, 0xff);
     outb(SLAVE_DATA, 0xff);
-}
-
-void PICSendEIO(int irq)
-{
-    // 0x20: EIO
-    outb(irq < 8 ? MASTER_COMMAND : SLAVE_COMMAND, 0x20);
-}
-
-void ActivatePICKeyboardInterrupts()
-{
-    outb(MASTER_DATA, inb(MASTER_DATA) & ~0b00000010);
 }
\ No newline at end of file
@@ -9,6 +9,7 @@ constexpr uint8_t PSF2_MAGIC_1 = 0xb5;
 constexpr uint8_t PSF2_MAGIC_2 = 0x4a;
 constexpr uint8_t PSF2_MAGIC_3 = 0x86;
 constexpr uint32_t PSF2_HEADER_FLAG_HAS_UNICODE_TABLE = 0x01;
+constexpr uint32_t REPLACEMENT_GLYPH = '?';
 
 PSF2::PSF2(const String &path)
 {
@@ -23,6 +24,7 @@ PSF2::PSF2(const String &path)
            header->magic[3] == PSF2_MAGIC_3);
 
     Assert(sizeof(PSF2::Header) == header->headerSize);
+    Assert(header->glyphCount > REPLACEMENT_GLYPH);
 
     Serial::Log("Width: %d", header->width);
     Serial::Log("Height: %d", header->height);
@@ -39,10 +41,12 @@ PSF2::PSF2(const String &path)
     VFS::kernelVfs->Close(fontFile);
 }
 
+// Anything can be written to the terminal, characters the font has no glyph for are drawn as '?'
 PSF2Glyph PSF2::GetGlyphBitmap(char c) const
 {
-    Assert(static_cast<uint32_t>(c) < header->glyphCount);
-    return {glyphBuffer + (c * header->charSize), header->charSize, Width(), Height()};
+    uint32_t glyphIndex = static_cast<unsigned char>(c);
+    if (glyphIndex >= header->glyphCount) glyphIndex = REPLACEMENT_GLYPH;
+    return {glyphBuffer + (glyphIndex * header->charSize), header->charSize, Width(), Height()};
 }
 
 uint32_t PSF2::Height() const
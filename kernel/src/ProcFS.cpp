@@ -0,0 +1,521 @@
+#include "ProcFS.h"
+#include "Scheduler.h"
+#include "CPU.h"
+#include "InterruptStatistics.h"
+#include "SystemCallStatistics.h"
+#include "BootProfiler.h"
+#include "LockStatistics.h"
+#include "AllocationProfiler.h"
+#include "Memory/PageFrameAllocator.h"
+
+// Inode numbers of the files in the root, tasks' directories and files are numbered from their pid
+enum ProcInode : uint32_t
+{
+    RootInode = 1,
+    MemoryInformationInode,
+    StatisticsInode,
+    LoadAverageInode,
+    UptimeInode,
+    InterruptsInode,
+    InterruptLatencyInode,
+    LockStatisticsInode,
+    AllocationStatisticsInode,
+    SystemCallsInode,
+    BootInode,
+    StaticInodeCount
+};
+
+enum class TaskFile : uint32_t
+{
+    Directory = 0,
+    Statistics = 1,
+    Status = 2,
+    Mappings = 3,
+    Count
+};
+
+constexpr uint32_t TASK_INODE_SHIFT = 8;
+
+// Times are reported in clock ticks of this frequency, the value of sysconf(_SC_CLK_TCK) on Linux
+constexpr uint64_t USER_HZ = 100;
+
+// A directory's entries are numbered, and its reading position is the number of the next one
+constexpr uint64_t DIRECTORY_ENTRY_SIZE = 1;
+constexpr uint32_t DIRECTORY_SIZE = 0x1000;
+
+struct ProcFileName
+{
+    const char* name;
+    uint32_t inodeNum;
+};
+
+const ProcFileName rootFiles[] =
+{
+    {"meminfo", MemoryInformationInode},
+    {"stat", StatisticsInode},
+    {"loadavg", LoadAverageInode},
+    {"uptime", UptimeInode},
+    {"interrupts", InterruptsInode},
+    {"interrupt_latency", InterruptLatencyInode},
+    {"lockstat", LockStatisticsInode},
+    {"allocstat", AllocationStatisticsInode},
+    {"syscalls", SystemCallsInode},
+    {"boot", BootInode},
+};
+constexpr uint64_t ROOT_FILE_COUNT = sizeof(rootFiles) / sizeof(rootFiles[0]);
+
+const char* taskFileNames[static_cast<uint32_t>(TaskFile::Count)] = {nullptr, "stat", "status", "maps"};
+
+uint32_t GetTaskInode(uint64_t pid, TaskFile file)
+{
+    return static_cast<uint32_t>(pid << TASK_INODE_SHIFT) | static_cast<uint32_t>(file);
+}
+
+uint64_t TicksToClockTicks(uint64_t ticks)
+{
+    uint64_t ticksPerClockTick = CPU::GetTimestampCounterFrequency() / USER_HZ;
+    return ticksPerClockTick == 0 ? 0 : ticks / ticksPerClockTick;
+}
+
+// Writes a fixed point number with two decimals
+void WriteHundredths(TextWriter& writer, uint64_t hundredths)
+{
+    writer.WriteDecimal(hundredths / 100);
+    writer.Write('.');
+    if (hundredths % 100 < 10) writer.Write('0');
+    writer.WriteDecimal(hundredths % 100);
+}
+
+char GetStateCharacter(TaskState state)
+{
+    switch (state)
+    {
+        case TaskState::Normal:
+            return 'R';
+        case TaskState::Blocked:
+        case TaskState::WaitingForChild:
+            return 'S';
+        case TaskState::Terminated:
+            return 'Z';
+    }
+    return '?';
+}
+
+ProcFS::ProcFS(Disk* disk) : FileSystem(disk)
+{
+    fileSystemRoot = VFS::ConstructVnode(RootInode, this, nullptr, DIRECTORY_SIZE, VFS::VnodeType::Directory);
+    for (const ProcFileName& file : rootFiles)
+    {
+        VFS::ConstructVnode(file.inodeNum, this, nullptr, 0, VFS::VnodeType::GeneratedFile);
+    }
+}
+
+// Vnodes are never freed, so the ones of a task that exited are reused by the next task with its pid
+VFS::Vnode* ProcFS::GetVnode(uint32_t inodeNum, VFS::VnodeType type)
+{
+    VFS::Vnode* vnode = VFS::SearchInCache(inodeNum, this);
+    if (vnode == nullptr)
+    {
+        uint32_t size = type == VFS::VnodeType::Directory ? DIRECTORY_SIZE : 0;
+        vnode = VFS::ConstructVnode(inodeNum, this, nullptr, size, type);
+    }
+    return vnode;
+}
+
+uint64_t ProcFS::Read(VFS::Vnode* vnode, void* buffer, uint64_t count, uint64_t readPos)
+{
+    TextWriter writer(static_cast<char*>(buffer), count, readPos);
+
+    switch (vnode->inodeNum)
+    {
+        case MemoryInformationInode:
+            WriteMemoryInformation(writer);
+            break;
+        case StatisticsInode:
+            WriteStatistics(writer);
+            break;
+        case LoadAverageInode:
+            WriteLoadAverages(writer);
+            break;
+        case UptimeInode:
+            WriteUptime(writer);
+            break;
+        case InterruptsInode:
+            InterruptStatistics::Report(writer);
+            break;
+        case InterruptLatencyInode:
+            InterruptStatistics::ReportLatency(writer);
+            break;
+        case LockStatisticsInode:
+            LockStatistics::Report(writer);
+            break;
+        case AllocationStatisticsInode:
+            AllocationProfiler::Report(writer);
+            break;
+        case SystemCallsInode:
+            SystemCallStatistics::Report(writer);
+            break;
+        case BootInode:
+            BootProfiler::Report(writer);
+            break;
+        default:
+        {
+            uint64_t pid = vnode->inodeNum >> TASK_INODE_SHIFT;
+            auto file = static_cast<TaskFile>(vnode->inodeNum & ((1 << TASK_INODE_SHIFT) - 1));
+
+            if (file == TaskFile::Mappings)
+            {
+                WriteTaskMappings(writer, pid);
+                break;
+            }
+
+            Task task;
+            uint64_t userPageCount;
+            if (!Scheduler::CopyTask(pid, task, userPageCount)) return 0;
+
+            if (file == TaskFile::Statistics) WriteTaskStatistics(writer, task, userPageCount);
+            else if (file == TaskFile::Status) WriteTaskStatus(writer, task, userPageCount);
+        }
+    }
+
+    return writer.GetWrittenCount();
+}
+
+// Writing to lockstat clears the lock statistics, like writing to /dev/lockstat. Everything else is read-only.
+uint64_t ProcFS::Write(VFS::Vnode* vnode, const void* buffer, uint64_t count, uint64_t writePos)
+{
+    if (vnode->inodeNum == LockStatisticsInode)
+    {
+        LockStatistics::Clear();
+    }
+
+    (void)buffer;
+    (void)writePos;
+    return count;
+}
+
+VFS::Vnode* ProcFS::FindInDirectory(VFS::Vnode* directory, const String& name)
+{
+    if (directory == fileSystemRoot)
+    {
+        for (const ProcFileName& file : rootFiles)
+        {
+            if (name.Equals(file.name))
+            {
+                return VFS::SearchInCache(file.inodeNum, this);
+            }
+        }
+
+        // Looked up like a directory rather than being a symbolic link, since only the last component of a path
+        // can be a symbolic link
+        uint64_t pid = 0;
+        if (name.Equals("self"))
+        {
+            pid = Scheduler::GetScheduler()->currentTask.pid;
+        }
+        else
+        {
+            for (uint64_t i = 0; i < name.GetLength(); ++i)
+            {
+                if (!name.IsNumeric(i)) return nullptr;
+                pid = pid * 10 + name[i] - '0';
+            }
+        }
+
+        Task task;
+        uint64_t userPageCount;
+        if (!Scheduler::CopyTask(pid, task, userPageCount)) return nullptr;
+        return GetVnode(GetTaskInode(pid, TaskFile::Directory), VFS::VnodeType::Directory);
+    }
+
+    uint64_t pid = directory->inodeNum >> TASK_INODE_SHIFT;
+    for (uint32_t file = 1; file < static_cast<uint32_t>(TaskFile::Count); ++file)
+    {
+        if (name.Equals(taskFileNames[file]))
+        {
+            return GetVnode(GetTaskInode(pid, static_cast<TaskFile>(file)), VFS::VnodeType::GeneratedFile);
+        }
+    }
+
+    return nullptr;
+}
+
+VFS::DirectoryEntry ProcFS::ReadDirectory(VFS::Vnode* directory, uint64_t readPos)
+{
+    if (directory == fileSystemRoot)
+    {
+        if (readPos < ROOT_FILE_COUNT)
+        {
+            const ProcFileName& file = rootFiles[readPos];
+            return {file.inodeNum, String(file.name), VFS::VnodeType::RegularFile, DIRECTORY_ENTRY_SIZE};
+        }
+
+        Vector<uint64_t> pids;
+        Scheduler::GetPids(pids);
+
+        uint64_t index = readPos - ROOT_FILE_COUNT;
+        if (index < pids.GetLength())
+        {
+            uint64_t pid = pids.Get(index);
+
+            String name;
+            char digits[20];
+            uint64_t digitCount = 0;
+            for (uint64_t number = pid; number > 0; number /= 10)
+            {
+                digits[digitCount++] = static_cast<char>('0' + number % 10);
+            }
+            while (digitCount > 0) name.Push(digits[--digitCount]);
+
+            return {GetTaskInode(pid, TaskFile::Directory), name, VFS::VnodeType::Directory, DIRECTORY_ENTRY_SIZE};
+        }
+
+        if (index == pids.GetLength())
+        {
+            uint64_t currentPid = Scheduler::GetScheduler()->currentTask.pid;
+            return {GetTaskInode(currentPid, TaskFile::Directory), String("self"), VFS::VnodeType::Directory,
+                    DIRECTORY_ENTRY_SIZE};
+        }
+
+        return {0, String(), VFS::VnodeType::Unknown, 0};
+    }
+
+    uint64_t pid = directory->inodeNum >> TASK_INODE_SHIFT;
+    uint64_t file = readPos + 1;
+    if (file < static_cast<uint64_t>(TaskFile::Count))
+    {
+        return {GetTaskInode(pid, static_cast<TaskFile>(file)), String(taskFileNames[file]), VFS::VnodeType::RegularFile,
+                DIRECTORY_ENTRY_SIZE};
+    }
+
+    return {0, String(), VFS::VnodeType::Unknown, 0};
+}
+
+String ProcFS::GetPathFromSymbolicLink(VFS::Vnode* symLinkVnode)
+{
+    Panic();
+    (void)symLinkVnode;
+}
+
+VFS::Vnode* ProcFS::Create(VFS::Vnode* directory, const String& name, VFS::VnodeType vnodeType)
+{
+    Panic();
+    return nullptr;
+
+    (void)directory;
+    (void)name;
+    (void)vnodeType;
+}
+
+// Files are generated on each read, there is nothing to truncate
+void ProcFS::Truncate(VFS::Vnode* vnode)
+{
+    (void)vnode;
+}
+
+void WriteMemoryLine(TextWriter& writer, const char* name, uint64_t kilobytes)
+{
+    writer.Write(name);
+    writer.Write(':');
+    writer.Pad(16);
+    writer.WriteDecimal(kilobytes, 8);
+    writer.Write(" kB\n");
+}
+
+// Page frames are never reclaimed, so all of the free memory is available and nothing is cached
+void ProcFS::WriteMemoryInformation(TextWriter& writer)
+{
+    uint64_t totalKilobytes = usablePageFrameCount * 4;
+    uint64_t freeKilobytes = (usablePageFrameCount - usedPageFrameCount) * 4;
+
+    WriteMemoryLine(writer, "MemTotal", totalKilobytes);
+    WriteMemoryLine(writer, "MemFree", freeKilobytes);
+    WriteMemoryLine(writer, "MemAvailable", freeKilobytes);
+    WriteMemoryLine(writer, "Buffers", 0);
+    WriteMemoryLine(writer, "Cached", 0);
+    WriteMemoryLine(writer, "SwapCached", 0);
+    WriteMemoryLine(writer, "SwapTotal", 0);
+    WriteMemoryLine(writer, "SwapFree", 0);
+    WriteMemoryLine(writer, "Shmem", 0);
+    WriteMemoryLine(writer, "SReclaimable", 0);
+}
+
+void WriteCPULine(TextWriter& writer, uint64_t userTime, uint64_t systemTime, uint64_t idleTime)
+{
+    // user nice system idle iowait irq softirq steal guest guest_nice
+    writer.Write(' ');
+    writer.WriteDecimal(TicksToClockTicks(userTime));
+    writer.Write(" 0 ");
+    writer.WriteDecimal(TicksToClockTicks(systemTime));
+    writer.Write(' ');
+    writer.WriteDecimal(TicksToClockTicks(idleTime));
+    writer.Write(" 0 0 0 0 0 0\n");
+}
+
+void ProcFS::WriteStatistics(TextWriter& writer)
+{
+    uint64_t totalUserTime = 0;
+    uint64_t totalSystemTime = 0;
+    uint64_t totalIdleTime = 0;
+    uint64_t contextSwitchCount = 0;
+    for (uint32_t coreId = 0; coreId < CPU::GetCoreCount(); ++coreId)
+    {
+        if (!CPU::IsCoreOnline(coreId)) continue;
+
+        const Scheduler* scheduler = CPU::GetStruct(coreId).scheduler;
+        totalUserTime += scheduler->userTime;
+        totalSystemTime += scheduler->systemTime;
+        totalIdleTime += scheduler->idleTime;
+        contextSwitchCount += scheduler->contextSwitchCount;
+    }
+
+    writer.Write("cpu ");
+    WriteCPULine(writer, totalUserTime, totalSystemTime, totalIdleTime);
+    for (uint32_t coreId = 0; coreId < CPU::GetCoreCount(); ++coreId)
+    {
+        if (!CPU::IsCoreOnline(coreId)) continue;
+
+        const Scheduler* scheduler = CPU::GetStruct(coreId).scheduler;
+        writer.Write("cpu");
+        writer.WriteDecimal(coreId);
+        WriteCPULine(writer, scheduler->userTime, scheduler->systemTime, scheduler->idleTime);
+    }
+
+    SchedulerStatistics statistics = Scheduler::GetStatistics();
+
+    writer.Write("intr ");
+    writer.WriteDecimal(InterruptStatistics::GetTotal());
+    writer.Write("\nctxt ");
+    writer.WriteDecimal(contextSwitchCount);
+    writer.Write("\nbtime 0\nprocesses ");
+    writer.WriteDecimal(statistics.createdCount);
+    writer.Write("\nprocs_running ");
+    writer.WriteDecimal(statistics.runnableCount);
+    writer.Write("\nprocs_blocked 0\n");
+}
+
+void ProcFS::WriteLoadAverages(TextWriter& writer)
+{
+    SchedulerStatistics statistics = Scheduler::GetStatistics();
+
+    for (uint64_t loadAverage : statistics.loadAverages)
+    {
+        // Rounded to hundredths
+        constexpr uint64_t one = 1 << LOAD_AVERAGE_SHIFT;
+        WriteHundredths(writer, ((loadAverage + one / 200) * 100) >> LOAD_AVERAGE_SHIFT);
+        writer.Write(' ');
+    }
+
+    writer.WriteDecimal(statistics.runnableCount);
+    writer.Write('/');
+    writer.WriteDecimal(statistics.taskCount);
+    writer.Write(' ');
+    writer.WriteDecimal(statistics.createdCount);
+    writer.Write('\n');
+}
+
+// The timestamp counter starts counting at reset, so it gives the time since boot
+void ProcFS::WriteUptime(TextWriter& writer)
+{
+    uint64_t totalIdleTime = 0;
+    for (uint32_t coreId = 0; coreId < CPU::GetCoreCount(); ++coreId)
+    {
+        if (!CPU::IsCoreOnline(coreId)) continue;
+        totalIdleTime += CPU::GetStruct(coreId).scheduler->idleTime;
+    }
+
+    WriteHundredths(writer, TicksToClockTicks(CPU::ReadTimestampCounter()));
+    writer.Write(' ');
+    WriteHundredths(writer, TicksToClockTicks(totalIdleTime));
+    writer.Write('\n');
+}
+
+// All 52 fields of Linux's /proc/<pid>/stat, the ones this kernel has no equivalent for are 0.
+// Page faults are always fatal here, so there are no fault counts to report.
+void ProcFS::WriteTaskStatistics(TextWriter& writer, const Task& task, uint64_t userPageCount)
+{
+    writer.WriteDecimal(task.pid);
+    writer.Write(" (");
+    writer.Write(task.name);
+    writer.Write(") ");
+    writer.Write(GetStateCharacter(task.state));
+    writer.Write(' ');
+    writer.WriteDecimal(task.parentPid);
+    writer.Write(' ');
+    writer.WriteDecimal(task.pid); // Process group
+    writer.Write(' ');
+    writer.WriteDecimal(task.pid); // Session
+
+    // Terminal, terminal process group, flags and fault counts
+    writer.Write(" 0 -1 0 0 0 0 0 ");
+
+    writer.WriteDecimal(TicksToClockTicks(task.usage.userTime));
+    writer.Write(' ');
+    writer.WriteDecimal(TicksToClockTicks(task.usage.systemTime));
+    writer.Write(' ');
+    writer.WriteDecimal(TicksToClockTicks(task.childrenUsage.userTime));
+    writer.Write(' ');
+    writer.WriteDecimal(TicksToClockTicks(task.childrenUsage.systemTime));
+    writer.Write(" 20 0 1 0 "); // Priority, nice, threads, interval timer
+    writer.WriteDecimal(TicksToClockTicks(task.startTimestamp));
+    writer.Write(' ');
+    writer.WriteDecimal(userPageCount * 0x1000); // Virtual memory size
+    writer.Write(' ');
+    writer.WriteDecimal(userPageCount); // Resident set size
+
+    // Resident set size limit, twelve address, signal and swap fields, and the exit signal
+    writer.Write(" 18446744073709551615 0 0 0 0 0 0 0 0 0 0 0 0 17 ");
+    writer.WriteDecimal(task.lastCoreId);
+
+    // Real-time priority, policy, I/O delay, guest times, seven address fields and the exit code
+    writer.Write(" 0 0 0 0 0 0 0 0 0 0 0 0 ");
+    writer.WriteDecimal(task.state == TaskState::Terminated ? task.exitStatus : 0);
+    writer.Write('\n');
+}
+
+void ProcFS::WriteTaskStatus(TextWriter& writer, const Task& task, uint64_t userPageCount)
+{
+    const char* stateName = "R (running)";
+    if (task.state == TaskState::Blocked || task.state == TaskState::WaitingForChild) stateName = "S (sleeping)";
+    else if (task.state == TaskState::Terminated) stateName = "Z (zombie)";
+
+    writer.Write("Name:\t");
+    writer.Write(task.name);
+    writer.Write("\nState:\t");
+    writer.Write(stateName);
+    writer.Write("\nTgid:\t");
+    writer.WriteDecimal(task.pid);
+    writer.Write("\nPid:\t");
+    writer.WriteDecimal(task.pid);
+    writer.Write("\nPPid:\t");
+    writer.WriteDecimal(task.parentPid);
+    writer.Write("\nVmSize:\t");
+    writer.WriteDecimal(userPageCount * 4, 8);
+    writer.Write(" kB\nVmHWM:\t");
+    uint64_t peakUserPageCount = task.usage.peakUserPageCount > userPageCount ? task.usage.peakUserPageCount : userPageCount;
+    writer.WriteDecimal(peakUserPageCount * 4, 8);
+    writer.Write(" kB\nVmRSS:\t");
+    writer.WriteDecimal(userPageCount * 4, 8);
+    writer.Write(" kB\nThreads:\t1\nvoluntary_ctxt_switches:\t");
+    writer.WriteDecimal(task.usage.voluntarySwitchCount);
+    writer.Write("\nnonvoluntary_ctxt_switches:\t");
+    writer.WriteDecimal(task.usage.involuntarySwitchCount);
+    writer.Write('\n');
+}
+
+void ProcFS::WriteTaskMappings(TextWriter& writer, uint64_t pid)
+{
+    Vector<PagingManager::Mapping> mappings;
+    if (!Scheduler::GetTaskMappings(pid, mappings)) return;
+
+    for (const PagingManager::Mapping& mapping : mappings)
+    {
+        writer.WriteHex(mapping.start);
+        writer.Write('-');
+        writer.WriteHex(mapping.end);
+        writer.Write(" r");
+        writer.Write(mapping.writable ? 'w' : '-');
+        writer.Write(mapping.executable ? 'x' : '-');
+        writer.Write("p 00000000 00:00 0\n");
+    }
+}
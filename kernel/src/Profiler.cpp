@@ -0,0 +1,193 @@
+#include "Profiler.h"
+#include "PerCoreRing.h"
+#include "Scheduler.h"
+#include "Serial.h"
+#include "Memory/PagingManager.h"
+#include "Memory/Memory.h"
+
+constexpr uint64_t PROFILE_RING_SIZE = 128;
+constexpr uint64_t PROFILE_STREAM_INTERVAL_MILLISECONDS = 10;
+constexpr uint64_t PROFILE_LINE_SIZE = 32 + 17 * (PROFILE_STACK_DEPTH + 3);
+
+constexpr uintptr_t USERSPACE_END = 0x0000'8000'0000'0000;
+constexpr uintptr_t KERNELSPACE_START = 0xffff'8000'0000'0000;
+
+typedef PerCoreRing<ProfileSample, PROFILE_RING_SIZE> ProfileRing;
+
+ProfileRing profileSamples;
+uint64_t lastSampleTimestamps[PER_CORE_RING_MAX_CORES];
+uint64_t samplePeriod = 0; // TSC ticks
+
+uint64_t Profiler::timerIntervalMilliseconds = 0;
+
+bool streaming = false;
+bool streamThreadStarted = false;
+uint64_t streamSequence = 0;
+
+bool IsFrameReadable(PagingManager* pagingManager, uintptr_t framePointer, bool userspace)
+{
+    if (framePointer % 8 != 0) return false;
+
+    // The whole frame has to be canonical. Past the end of user space, the page walk would go through the
+    // kernel's half of the tables and find a present page at an address that faults when read.
+    bool inRange = userspace ? framePointer <= USERSPACE_END - 16
+                             : framePointer >= KERNELSPACE_START && framePointer <= UINTPTR_MAX - 16;
+    if (!inRange) return false;
+
+    // A frame is the saved RBP followed by the return address, which may be on the next page
+    return pagingManager->PageNotPresentLevel(reinterpret_cast<void*>(framePointer)) == 0 &&
+           pagingManager->PageNotPresentLevel(reinterpret_cast<void*>(framePointer + 8)) == 0;
+}
+
+// Runs in the timer interrupt, with interrupts disabled
+void Profiler::Sample(const InterruptFrame* interruptFrame)
+{
+    uint32_t coreId = CPU::GetCoreID();
+    if (coreId >= PER_CORE_RING_MAX_CORES) return;
+
+    // The timer also fires early for sleeping tasks, so samples are taken on the first tick after a period has
+    // (nearly) passed, and weighted by the time since the previous one.
+    uint64_t now = CPU::ReadTimestampCounter();
+    uint64_t& lastSample = lastSampleTimestamps[coreId];
+    if (lastSample == 0)
+    {
+        lastSample = now;
+        return;
+    }
+
+    uint64_t weight = now - lastSample;
+    if (weight < samplePeriod - samplePeriod / 8) return;
+    lastSample = now;
+
+    const Task& task = Scheduler::GetScheduler()->currentTask;
+    bool userspace = (interruptFrame->cs & 3) == 3;
+
+    uint64_t stack[PROFILE_STACK_DEPTH];
+    uint32_t depth = 0;
+    stack[depth++] = interruptFrame->rip;
+
+    // Only code built with frame pointers can be unwound, the walk stops at the first frame that doesn't look valid
+    uintptr_t framePointer = interruptFrame->rbp;
+    while (depth < PROFILE_STACK_DEPTH && IsFrameReadable(task.pagingManager, framePointer, userspace))
+    {
+        auto frame = reinterpret_cast<const uint64_t*>(framePointer);
+        if (frame[1] == 0) break;
+        stack[depth++] = frame[1];
+
+        // Callers' frames are higher up the stack, this also stops the walk on loops
+        if (frame[0] <= framePointer) break;
+        framePointer = frame[0];
+    }
+
+    uint64_t pid = task.pid;
+    profileSamples.Push([now, weight, pid, coreId, depth, &stack](ProfileSample& sample)
+    {
+        sample.timestamp = now;
+        sample.weight = weight;
+        sample.pid = pid;
+        sample.coreId = coreId;
+        sample.depth = depth;
+        memcpy(sample.stack, stack, depth * sizeof(uint64_t));
+    });
+}
+
+// Samples that were overwritten before being read are skipped
+uint64_t Profiler::Read(ProfileSample* buffer, uint64_t maxCount, uint64_t& sequence)
+{
+    uint64_t count = 0;
+    while (count < maxCount)
+    {
+        uint64_t nextAvailable;
+        auto status = profileSamples.Find(sequence, buffer[count], nextAvailable);
+
+        if (status == ProfileRing::Status::Pending) break;
+
+        if (status == ProfileRing::Status::Lost)
+        {
+            sequence = nextAvailable;
+            continue;
+        }
+
+        sequence++;
+        count++;
+    }
+
+    return count;
+}
+
+uint64_t Profiler::GetNextSequence()
+{
+    return profileSamples.GetNextSequence();
+}
+
+void Profiler::SetFrequency(uint64_t frequency)
+{
+    if (frequency == 0)
+    {
+        timerIntervalMilliseconds = 0;
+        return;
+    }
+
+    // The scheduler's timer has a resolution of one millisecond
+    if (frequency > PROFILE_MAX_FREQUENCY) frequency = PROFILE_MAX_FREQUENCY;
+
+    samplePeriod = CPU::GetTimestampCounterFrequency() / frequency;
+    for (uint64_t& lastSample : lastSampleTimestamps) lastSample = 0;
+    timerIntervalMilliseconds = 1000 / frequency;
+}
+
+void Profiler::SetStreaming(bool enabled)
+{
+    if (enabled && !streaming)
+    {
+        streamSequence = GetNextSequence();
+        Serial::LogSynchronously("profile-tsc %d", CPU::GetTimestampCounterFrequency());
+    }
+
+    streaming = enabled;
+
+    // Two cores enabling streaming at once must not both start a thread
+    if (enabled && !__atomic_exchange_n(&streamThreadStarted, true, __ATOMIC_ACQ_REL))
+    {
+        Scheduler::CreateKernelThread(StreamThread, nullptr);
+    }
+}
+
+void AppendHex(char* line, uint64_t& length, uint64_t number)
+{
+    line[length++] = ' ';
+
+    uint64_t digitCount = 1;
+    while (digitCount < 16 && (number >> (digitCount * 4)) != 0) digitCount++;
+
+    for (uint64_t i = digitCount; i-- > 0; )
+    {
+        line[length++] = "0123456789abcdef"[(number >> (i * 4)) & 0xf];
+    }
+}
+
+// Writes one line per sample, which tools/profile2folded.py understands:
+// "profile <weight> <pid> <core> <rip> <return address>..."
+void Profiler::StreamThread(void*)
+{
+    while (true)
+    {
+        ProfileSample sample;
+        while (streaming && Read(&sample, 1, streamSequence) == 1)
+        {
+            char line[PROFILE_LINE_SIZE];
+            uint64_t length = 0;
+            const char* prefix = "profile";
+            while (*prefix != 0) line[length++] = *prefix++;
+
+            AppendHex(line, length, sample.weight);
+            AppendHex(line, length, sample.pid);
+            AppendHex(line, length, sample.coreId);
+            for (uint32_t i = 0; i < sample.depth; ++i) AppendHex(line, length, sample.stack[i]);
+
+            Serial::WriteSynchronously(line, length);
+        }
+
+        Scheduler::GetScheduler()->SleepCurrentTask(PROFILE_STREAM_INTERVAL_MILLISECONDS);
+    }
+}
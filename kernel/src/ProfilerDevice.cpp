@@ -0,0 +1,52 @@
+#include "ProfilerDevice.h"
+#include "Profiler.h"
+
+uint64_t ProfilerDevice::ReadStream(void* buffer, uint64_t count, uint64_t& sequence, bool nonBlocking, Error& error)
+{
+    uint64_t sampleCount = Profiler::Read(static_cast<ProfileSample*>(buffer), count / sizeof(ProfileSample), sequence);
+    return sampleCount * sizeof(ProfileSample);
+
+    (void)nonBlocking;
+    (void)error;
+}
+
+// Readers only see the samples taken after they open the profiler
+uint64_t ProfilerDevice::GetStreamStart()
+{
+    return Profiler::GetNextSequence();
+}
+
+uint64_t ProfilerDevice::Write(const void* buffer, uint64_t count, uint64_t position)
+{
+    auto data = static_cast<const char*>(buffer);
+
+    uint64_t frequency = 0;
+    for (uint64_t i = 0; i < count && data[i] >= '0' && data[i] <= '9'; ++i)
+    {
+        frequency = frequency * 10 + (data[i] - '0');
+    }
+
+    Profiler::SetFrequency(frequency);
+    Profiler::SetStreaming(frequency != 0);
+
+    (void)position;
+    return count;
+}
+
+uint64_t ProfilerDevice::Control(uint64_t request, void* argument, Error& error)
+{
+    switch (static_cast<ProfileRequest>(request))
+    {
+        case ProfileRequest::SetFrequency:
+            Profiler::SetFrequency(*static_cast<uint64_t*>(argument));
+            return 0;
+        case ProfileRequest::SetStreaming:
+            Profiler::SetStreaming(*static_cast<uint64_t*>(argument) != 0);
+            return 0;
+    }
+
+    error = Error::InvalidArgument;
+    return 0;
+}
+
+ProfilerDevice::ProfilerDevice(const String& name, uint32_t inodeNum) : Device(name, inodeNum) {}
@@ -13,15 +13,64 @@
 #include "IDT.h"
 #include "Heap.h"
 #include "AuxiliaryVector.h"
+#include "IRQ.h"
+#include "Trace.h"
+#include "Profiler.h"
+#include "AllocationProfiler.h"
+#include "BootProfiler.h"
 
 constexpr uint64_t SYSCALL_STACK_PAGE_COUNT = 3;
+constexpr uint64_t KERNEL_THREAD_STACK_PAGE_COUNT = 4;
 constexpr uintptr_t USER_STACK_BASE = 0x0000'8000'0000'0000 - 0x1000;
 constexpr uintptr_t USER_STACK_SIZE = 0x20000;
 
+// Load averages are sampled every 5 seconds, and decay by e^(-5/60), e^(-5/300) and e^(-5/900) in fixed point
+constexpr uint64_t LOAD_SAMPLE_INTERVAL_SECONDS = 5;
+constexpr uint64_t LOAD_AVERAGE_DECAY[3] = {1884, 2014, 2037};
+
 uint64_t millisecondsPassed = 0;
 
 Vector<Task>* taskQueue;
-Spinlock taskQueueLock;
+Spinlock taskQueueLock {LockClass::TaskQueue};
+
+// Shared by the idle tasks and kernel threads, which never use them
+VFS* kernelVfs;
+UserspaceAllocator* kernelUserspaceAllocator;
+
+// Wakeups that arrived before their task finished suspending (it was still running or
+// about to block), applied when the task is put back in the queue
+struct PendingWakeup
+{
+    uint64_t pid;
+    uint64_t suspensionId;
+    uint64_t returnValue;
+};
+Vector<PendingWakeup>* pendingWakeups;
+
+uint64_t nextPid = 1;
+uint64_t loadAverages[3] {};
+uint64_t nextLoadSampleTimestamp = 0;
+
+uint64_t TicksToMicroseconds(uint64_t ticks)
+{
+    uint64_t frequency = CPU::GetTimestampCounterFrequency();
+    if (frequency == 0) return 0;
+
+    // Split so that the multiplication can't overflow
+    return ticks / frequency * 1'000'000 + ticks % frequency * 1'000'000 / frequency;
+}
+
+// Page faults are always fatal, so there are never any faults to report
+ResourceUsage ToResourceUsage(const TaskUsage& usage)
+{
+    ResourceUsage resourceUsage {};
+    resourceUsage.userMicroseconds = TicksToMicroseconds(usage.userTime);
+    resourceUsage.systemMicroseconds = TicksToMicroseconds(usage.systemTime);
+    resourceUsage.peakResidentKilobytes = usage.peakUserPageCount * 4;
+    resourceUsage.voluntarySwitchCount = usage.voluntarySwitchCount;
+    resourceUsage.involuntarySwitchCount = usage.involuntarySwitchCount;
+    return resourceUsage;
+}
 
 Task CreateTask(PagingManager* pagingManager, VFS* vfs, UserspaceAllocator* userspaceAllocator,
                 uintptr_t entry, uint64_t pid, uint64_t parentPid, bool giveStack, const AuxiliaryVector* auxiliaryVector,
@@ -149,6 +198,7 @@ Task CreateTask(PagingManager* pagingManager, VFS* vfs, UserspaceAllocator* user
 
     task.pid = pid;
     task.parentPid = parentPid;
+    task.startTimestamp = CPU::ReadTimestampCounter();
 
     return task;
 }
@@ -158,20 +208,45 @@ void Idle() { while (true) asm("hlt"); }
 void Scheduler::InitializeQueue()
 {
     taskQueue = new Vector<Task>();
+    pendingWakeups = new Vector<PendingWakeup>();
+    kernelVfs = new VFS();
+    kernelUserspaceAllocator = new UserspaceAllocator();
 }
 
 uint64_t Scheduler::GeneratePID()
 {
-    static uint64_t pid = 1;
-    return __atomic_fetch_add(&pid, 1, __ATOMIC_RELAXED);
+    return __atomic_fetch_add(&nextPid, 1, __ATOMIC_RELAXED);
 }
 
 void Scheduler::SwitchToNextTask(InterruptFrame* interruptFrame)
 {
+    uint64_t previousPid = currentTask.pid;
+    uint64_t timestamp = CPU::ReadTimestampCounter();
+    AccountTime(timestamp, false);
+    bool previousQueued = restoreFrame;
+    bool previousBlocked = currentTask.state != TaskState::Normal;
+
     taskQueueLock.Acquire();
     if (restoreFrame)
     {
         currentTask.frame = *interruptFrame;
+
+        for (uint64_t i = pendingWakeups->GetLength(); i-- > 0; )
+        {
+            PendingWakeup wakeup = pendingWakeups->Get(i);
+            if (wakeup.pid != currentTask.pid) continue;
+
+            if (wakeup.suspensionId < currentTask.suspensionId)
+            {
+                pendingWakeups->Pop(i);
+            }
+            else if (wakeup.suspensionId == currentTask.suspensionId && currentTask.state == TaskState::Blocked)
+            {
+                pendingWakeups->Pop(i);
+                Unsuspend(currentTask, wakeup.returnValue);
+            }
+        }
+
         taskQueue->Push(currentTask);
     }
     restoreFrame = true;
@@ -182,12 +257,35 @@ void Scheduler::SwitchToNextTask(InterruptFrame* interruptFrame)
     taskQueueLock.Acquire();
 
     bool foundNewTask = false;
+    auto coreId = static_cast<int64_t>(CPU::GetCoreID());
+    if (coreId == 0)
+    {
+        UpdateLoadAverages(timestamp);
+    }
+
     for (uint64_t i = 0; i < taskQueue->GetLength(); ++i)
     {
-        if (taskQueue->Get(i).state == TaskState::Normal)
+        const Task& task = taskQueue->Get(i);
+        if (task.state == TaskState::Normal && (task.pinnedCore == -1 || task.pinnedCore == coreId))
         {
             currentTask = taskQueue->Pop(i);
             foundNewTask = true;
+            break;
+        }
+    }
+
+    // The task that was switched out is near the end of the queue, where it was pushed
+    if (previousQueued && previousPid != 0 && (!foundNewTask || currentTask.pid != previousPid))
+    {
+        for (uint64_t i = taskQueue->GetLength(); i-- > 0; )
+        {
+            Task& task = taskQueue->Get(i);
+            if (task.pid != previousPid) continue;
+
+            if (task.state == TaskState::Terminated) break;
+            if (previousBlocked) task.usage.voluntarySwitchCount++;
+            else task.usage.involuntarySwitchCount++;
+            break;
         }
     }
 
@@ -199,12 +297,21 @@ void Scheduler::SwitchToNextTask(InterruptFrame* interruptFrame)
         currentTask = idleTask;
     }
 
+    currentTask.accountedTimestamp = timestamp;
+    currentTask.lastCoreId = coreId;
+    if (currentTask.pid != previousPid)
+    {
+        contextSwitchCount++;
+    }
+
     ConfigureTimerClosestExpiry();
 
     tss->SetSystemCallStack(currentTask.syscallStackAddr);
     *interruptFrame = currentTask.frame;
     currentTask.pagingManager->SetCR3();
     CPU::SetTCB(currentTask.taskControlBlock);
+
+    TracePoint(TaskSwitch, previousPid, currentTask.pid);
 }
 
 Task& Scheduler::GetTask(uint64_t pid)
@@ -219,9 +326,89 @@ Task& Scheduler::GetTask(uint64_t pid)
     Panic();
 }
 
+// Must be called with taskQueueLock held, which keeps tasks from moving between the queue and the cores.
+// The queue is searched first since a core's current task is a stale copy between being queued and replaced.
+Task* Scheduler::FindTask(uint64_t pid)
+{
+    for (Task& task : *taskQueue)
+    {
+        if (task.pid == pid)
+        {
+            return &task;
+        }
+    }
+
+    for (uint32_t coreId = 0; coreId < CPU::GetCoreCount(); ++coreId)
+    {
+        if (!CPU::IsCoreOnline(coreId)) continue;
+
+        Task& task = CPU::GetStruct(coreId).scheduler->currentTask;
+        if (task.pid == pid)
+        {
+            return &task;
+        }
+    }
+
+    return nullptr;
+}
+
+// Called on every entry to and exit from the kernel, with whether the time since the last call was spent in user mode
+void Scheduler::AccountTime(uint64_t timestamp, bool userMode)
+{
+    uint64_t elapsed = timestamp - currentTask.accountedTimestamp;
+    currentTask.accountedTimestamp = timestamp;
+
+    if (currentTask.pid == 0)
+    {
+        idleTime += elapsed;
+    }
+    else if (userMode)
+    {
+        userTime += elapsed;
+        currentTask.usage.userTime += elapsed;
+    }
+    else
+    {
+        systemTime += elapsed;
+        currentTask.usage.systemTime += elapsed;
+    }
+}
+
+// Must be called with taskQueueLock held
+void Scheduler::UpdateLoadAverages(uint64_t timestamp)
+{
+    uint64_t frequency = CPU::GetTimestampCounterFrequency();
+    if (frequency == 0 || timestamp < nextLoadSampleTimestamp) return;
+    nextLoadSampleTimestamp = timestamp + LOAD_SAMPLE_INTERVAL_SECONDS * frequency;
+
+    // The task this core is switching away from has already been queued
+    uint64_t activeCount = 0;
+    for (const Task& task : *taskQueue)
+    {
+        if (task.state == TaskState::Normal) activeCount++;
+    }
+    for (uint32_t coreId = 1; coreId < CPU::GetCoreCount(); ++coreId)
+    {
+        if (!CPU::IsCoreOnline(coreId)) continue;
+        if (CPU::GetStruct(coreId).scheduler->currentTask.pid != 0) activeCount++;
+    }
+
+    constexpr uint64_t one = 1 << LOAD_AVERAGE_SHIFT;
+    for (uint64_t i = 0; i < 3; ++i)
+    {
+        uint64_t decay = LOAD_AVERAGE_DECAY[i];
+        loadAverages[i] = (loadAverages[i] * decay + activeCount * one * (one - decay)) >> LOAD_AVERAGE_SHIFT;
+    }
+}
+
 void Scheduler::ConfigureTimerClosestExpiry()
 {
     uint64_t closestTime = 5;
+    if (Profiler::timerIntervalMilliseconds != 0 && Profiler::timerIntervalMilliseconds < closestTime)
+    {
+        closestTime = Profiler::timerIntervalMilliseconds;
+    }
+
     for (uint64_t i = 0; i < timerEntries.GetLength(); ++i)
     {
         auto time = timerEntries.Get(i);
@@ -251,7 +438,7 @@ void Scheduler::UpdateTimerEntries()
             if (timerEntry.unblockOnExpire)
             {
                 Assert(timerEntry.pid != 0);
-                Scheduler::Unsuspend(timerEntry.pid, 0);
+                Scheduler::Unsuspend(timerEntry.pid, timerEntry.suspensionId, SUSPENSION_TIMED_OUT);
             }
 
             timerEntries.Pop(i);
@@ -263,16 +450,29 @@ void Scheduler::UpdateTimerEntries()
     }
 }
 
-uint64_t Scheduler::SuspendSystemCall(TaskState newTaskState, uint64_t argument)
+uint64_t Scheduler::SuspendSystemCall(TaskState newTaskState, uint64_t argument, uint64_t timeoutMilliseconds)
 {
     Assert(currentTask.state == TaskState::Normal);
     currentTask.state = newTaskState;
     currentTask.suspensionArg = argument;
 
+    if (timeoutMilliseconds > 0)
+    {
+        timerEntries.Push({timeoutMilliseconds, true, currentTask.pid, currentTask.suspensionId});
+    }
+
+    TracePoint(TaskBlock, static_cast<uint64_t>(newTaskState), timeoutMilliseconds);
+
     uint64_t returnValue;
     asm volatile("int $0x81" : "=a"(returnValue) : : "memory");
 
-    Assert(currentTask.state == TaskState::Normal);
+    // The task may have been resumed by another core's scheduler
+    Task& resumedTask = GetScheduler()->currentTask;
+    Assert(resumedTask.state == TaskState::Normal);
+
+    // Any timer or waker that still refers to this suspension must not unsuspend a later one
+    resumedTask.suspensionId++;
+
     return returnValue;
 }
 
@@ -283,32 +483,183 @@ void Scheduler::Unsuspend(uint64_t pid, uint64_t returnValue)
     taskQueueLock.Release();
 }
 
+bool Scheduler::Unsuspend(uint64_t pid, uint64_t suspensionId, uint64_t returnValue)
+{
+    bool unsuspended = false;
+    bool foundTask = false;
+
+    taskQueueLock.Acquire();
+    for (Task& task : *taskQueue)
+    {
+        if (task.pid == pid)
+        {
+            foundTask = true;
+            if (task.suspensionId == suspensionId && task.state == TaskState::Blocked)
+            {
+                Unsuspend(task, returnValue);
+                unsuspended = true;
+            }
+            else if (task.suspensionId == suspensionId)
+            {
+                pendingWakeups->Push({pid, suspensionId, returnValue});
+            }
+            break;
+        }
+    }
+
+    // The task is running on some core and hasn't been switched out yet
+    if (!foundTask)
+    {
+        pendingWakeups->Push({pid, suspensionId, returnValue});
+    }
+    taskQueueLock.Release();
+
+    return unsuspended;
+}
+
+bool Scheduler::SetTraced(uint64_t pid, bool traced)
+{
+    taskQueueLock.Acquire();
+    Task* task = FindTask(pid);
+    if (task != nullptr)
+    {
+        task->traced = traced;
+    }
+    taskQueueLock.Release();
+
+    return task != nullptr;
+}
+
+// The copy's pointers can dangle as soon as the task is reaped, so whatever they point to is read here
+bool Scheduler::CopyTask(uint64_t pid, Task& copy, uint64_t& userPageCount)
+{
+    if (pid == 0) return false;
+
+    taskQueueLock.Acquire();
+    Task* task = FindTask(pid);
+    if (task != nullptr)
+    {
+        copy = *task;
+        userPageCount = task->pagingManager->GetUserPageCount();
+    }
+    taskQueueLock.Release();
+
+    return task != nullptr;
+}
+
+void Scheduler::GetPids(Vector<uint64_t>& pids)
+{
+    auto add = [&pids] (uint64_t pid)
+    {
+        if (pid == 0) return;
+
+        // Kept sorted, and a task can be both queued and on a core while it's being switched out
+        uint64_t index = 0;
+        for (; index < pids.GetLength() && pids.Get(index) < pid; ++index);
+        if (index < pids.GetLength() && pids.Get(index) == pid) return;
+
+        pids.Push(pid);
+        for (uint64_t i = pids.GetLength() - 1; i > index; --i)
+        {
+            pids.Get(i) = pids.Get(i - 1);
+        }
+        pids.Get(index) = pid;
+    };
+
+    taskQueueLock.Acquire();
+    for (const Task& task : *taskQueue)
+    {
+        add(task.pid);
+    }
+    for (uint32_t coreId = 0; coreId < CPU::GetCoreCount(); ++coreId)
+    {
+        if (!CPU::IsCoreOnline(coreId)) continue;
+        add(CPU::GetStruct(coreId).scheduler->currentTask.pid);
+    }
+    taskQueueLock.Release();
+}
+
+bool Scheduler::GetTaskMappings(uint64_t pid, Vector<PagingManager::Mapping>& mappings)
+{
+    if (pid == 0) return false;
+
+    // The lock also keeps the task's address space from being freed by WaitForChild
+    taskQueueLock.Acquire();
+    Task* task = FindTask(pid);
+    if (task != nullptr)
+    {
+        task->pagingManager->GetUserMappings(mappings);
+    }
+    taskQueueLock.Release();
+
+    return task != nullptr;
+}
+
+SchedulerStatistics Scheduler::GetStatistics()
+{
+    SchedulerStatistics statistics {};
+
+    Vector<uint64_t> pids;
+    GetPids(pids);
+    statistics.taskCount = pids.GetLength();
+    statistics.createdCount = __atomic_load_n(&nextPid, __ATOMIC_RELAXED) - 1;
+
+    taskQueueLock.Acquire();
+    for (uint64_t i = 0; i < 3; ++i)
+    {
+        statistics.loadAverages[i] = loadAverages[i];
+    }
+    for (const Task& task : *taskQueue)
+    {
+        if (task.state == TaskState::Normal) statistics.runnableCount++;
+    }
+    for (uint32_t coreId = 0; coreId < CPU::GetCoreCount(); ++coreId)
+    {
+        if (!CPU::IsCoreOnline(coreId)) continue;
+        if (CPU::GetStruct(coreId).scheduler->currentTask.pid != 0) statistics.runnableCount++;
+    }
+    taskQueueLock.Release();
+
+    return statistics;
+}
+
 void Scheduler::Unsuspend(Task& task, uint64_t returnValue)
 {
     Assert(task.state == TaskState::Blocked || task.state == TaskState::WaitingForChild);
     task.frame.rax = returnValue;
     task.state = TaskState::Normal;
+
+    TracePoint(TaskWakeup, task.pid, returnValue);
 }
 
-Spinlock tssInitLock;
 extern "C" void InitializeCore(stivale2_smp_info* smpInfoPtr)
 {
+    uint64_t entryTimestamp = CPU::ReadTimestampCounter();
+
     GDT::LoadGDTR();
     IDT::Load();
 
     // Write core ID in IA32_TSC_AUX so that CPU::GetCoreID can get it
     asm volatile ("wrmsr" : : "c"(0xc0000103), "a"(smpInfoPtr->lapic_id), "d"(0));
 
-    tssInitLock.Acquire();
+    // The BSP left the time it released this core in the extra argument. That is its own TSC, so the phase is
+    // only as accurate as the TSCs are synchronized, which firmware usually does but nothing here checks.
+    BootProfiler::Record(BootPhase::CoreWakeup, smpInfoPtr->extra_argument);
+
     TSS* tss = TSS::Initialize();
     GDT::LoadTSS(tss);
-    tssInitLock.Release();
 
     auto scheduler = new Scheduler(tss);
     scheduler->ConfigureTimerClosestExpiry();
 
     CPU::InitializeCPUStruct(scheduler);
     CPU::EnableSSE();
+    CPU::InitializePAT();
+
+    IRQ::Rebalance();
+
+    BootProfiler::Record(BootPhase::CoreBringUp, entryTimestamp);
+    BootProfiler::FinishCore();
 
     asm volatile("sti");
     while (true) asm("hlt");
@@ -316,11 +667,13 @@ extern "C" void InitializeCore(stivale2_smp_info* smpInfoPtr)
 
 void Scheduler::StartCores(TSS* bspTss)
 {
+    uint64_t phaseStart = CPU::ReadTimestampCounter();
     auto smpStruct = static_cast<stivale2_struct_tag_smp*>(GetStivale2Tag(STIVALE2_STRUCT_TAG_SMP_ID));
     CPU::InitializeCPUList(smpStruct->cpu_count);
 
     Assert(CPU::GetCoreID() == 0);
 
+    // Calibrates the LAPIC timer for every core, so it has to be done before the APs start
     auto bspScheduler = new Scheduler(bspTss);
     CPU::InitializeCPUStruct(bspScheduler);
 
@@ -332,19 +685,27 @@ void Scheduler::StartCores(TSS* bspTss)
             if (smpInfo.lapic_id == smpStruct->bsp_lapic_id) continue;
 
             smpInfo.target_stack = HigherHalf(RequestPageFrame()) + 0x1000;
-            smpInfo.goto_address = reinterpret_cast<uintptr_t>(InitializeCore);
+            smpInfo.extra_argument = CPU::ReadTimestampCounter();
+            // The core starts as soon as it sees the address, so everything else has to be written before it
+            __atomic_store_n(&smpInfo.goto_address, reinterpret_cast<uintptr_t>(InitializeCore), __ATOMIC_RELEASE);
         }
     }
 
     bspScheduler->ConfigureTimerClosestExpiry();
 
     CPU::EnableSSE();
+    CPU::InitializePAT();
+
+    BootProfiler::Record(BootPhase::StartCores, phaseStart);
+    BootProfiler::FinishCore();
+
     asm volatile("sti");
 }
 
 void Scheduler::ExitCurrentTask(int status, InterruptFrame* interruptFrame)
 {
     Serial::Log("Task exited with status %d.", status);
+    AllocationProfiler::ReportTaskAllocations(currentTask.pid);
 
     currentTask.state = TaskState::Terminated;
     currentTask.exitStatus = status;
@@ -367,8 +728,14 @@ void Scheduler::SleepCurrentTask(uint64_t milliseconds)
 {
     Assert(currentTask.pid != 0);
     Assert(milliseconds > 0);
-    timerEntries.Push({milliseconds, true, currentTask.pid});
-    SuspendSystemCall(TaskState::Blocked);
+    SuspendSystemCall(TaskState::Blocked, 0, milliseconds);
+}
+
+// The task stays runnable and goes to the back of the queue
+void Scheduler::YieldCurrentTask()
+{
+    Assert(currentTask.pid != 0);
+    asm volatile("int $0x81" : : : "memory");
 }
 
 uint64_t Scheduler::ForkCurrentTask(InterruptFrame* interruptFrame)
@@ -386,6 +753,8 @@ uint64_t Scheduler::ForkCurrentTask(InterruptFrame* interruptFrame)
     child.frame.rax = 0;
 
     child.taskControlBlock = currentTask.taskControlBlock;
+    child.traced = currentTask.traced;
+    child.SetName(currentTask.name);
 
     currentTask.childrenPids.Push(child.pid);
 
@@ -412,6 +781,18 @@ void Scheduler::Execute(const String& path, InterruptFrame* interruptFrame, cons
     Task task = CreateTask(pagingManager, vfs, new UserspaceAllocator(), entry, currentTask.pid,
                            currentTask.parentPid, true, auxiliaryVector, arguments, environment);
 
+    // Wakeups meant for the old program keep the same pid, so make sure they can't match the new one
+    task.suspensionId = currentTask.suspensionId + 1;
+    task.traced = currentTask.traced;
+    task.SetName(path.Split('/', path.Count('/')).ToRawString());
+
+    // It's still the same process, so it keeps its age and what it already used
+    task.startTimestamp = currentTask.startTimestamp;
+    task.usage = currentTask.usage;
+    task.childrenUsage = currentTask.childrenUsage;
+    uint64_t userPageCount = currentTask.pagingManager->GetUserPageCount();
+    if (userPageCount > task.usage.peakUserPageCount) task.usage.peakUserPageCount = userPageCount;
+
     taskQueueLock.Acquire();
     taskQueue->Push(task);
     taskQueueLock.Release();
@@ -422,7 +803,7 @@ void Scheduler::Execute(const String& path, InterruptFrame* interruptFrame, cons
     (void)error;
 }
 
-uint64_t Scheduler::WaitForChild(uint64_t pid, int& status, Error& error)
+uint64_t Scheduler::WaitForChild(uint64_t pid, int& status, ResourceUsage* childUsage, Error& error)
 {
     if (currentTask.childrenPids.IsEmpty())
     {
@@ -453,6 +834,9 @@ uint64_t Scheduler::WaitForChild(uint64_t pid, int& status, Error& error)
         taskQueueLock.Release();
     }
 
+    // The task may have been resumed by another core's scheduler
+    Task& waitingTask = GetScheduler()->currentTask;
+
     bool removedTask = false;
     taskQueueLock.Acquire();
     for (uint64_t i = 0; i < taskQueue->GetLength(); ++i)
@@ -461,21 +845,38 @@ uint64_t Scheduler::WaitForChild(uint64_t pid, int& status, Error& error)
         if (task.pid == childPid)
         {
             status = task.exitStatus;
+
+            TaskUsage usage = task.usage;
+            uint64_t userPageCount = task.pagingManager->GetUserPageCount();
+            if (userPageCount > usage.peakUserPageCount) usage.peakUserPageCount = userPageCount;
+            usage.Add(task.childrenUsage);
+
+            waitingTask.childrenUsage.Add(usage);
+            if (childUsage != nullptr) *childUsage = ToResourceUsage(usage);
+
             taskQueue->Pop(i).FreeResources();
             removedTask = true;
             break;
         }
     }
+
+    for (uint64_t i = pendingWakeups->GetLength(); i-- > 0; )
+    {
+        if (pendingWakeups->Get(i).pid == childPid)
+        {
+            pendingWakeups->Pop(i);
+        }
+    }
     taskQueueLock.Release();
     Assert(removedTask);
 
-    // Child PID must be removed from currentTask.childrenPids so it doesn't get waited for twice
+    // Child PID must be removed from childrenPids so it doesn't get waited for twice
     bool removed = false;
-    for (uint64_t i = 0; i < currentTask.childrenPids.GetLength(); ++i)
+    for (uint64_t i = 0; i < waitingTask.childrenPids.GetLength(); ++i)
     {
-        if (currentTask.childrenPids.Get(i) == childPid)
+        if (waitingTask.childrenPids.Get(i) == childPid)
         {
-            currentTask.childrenPids.Pop(i);
+            waitingTask.childrenPids.Pop(i);
             removed = true;
             break;
         }
@@ -485,6 +886,29 @@ uint64_t Scheduler::WaitForChild(uint64_t pid, int& status, Error& error)
     return childPid;
 }
 
+void Scheduler::GetResourceUsage(int64_t who, ResourceUsage& resourceUsage, Error& error)
+{
+    if (who == RESOURCE_USAGE_CHILDREN)
+    {
+        resourceUsage = ToResourceUsage(currentTask.childrenUsage);
+        return;
+    }
+
+    if (who != RESOURCE_USAGE_SELF)
+    {
+        error = Error::InvalidArgument;
+        return;
+    }
+
+    // Include the time of this system call so far
+    AccountTime(CPU::ReadTimestampCounter(), false);
+
+    TaskUsage usage = currentTask.usage;
+    uint64_t userPageCount = currentTask.pagingManager->GetUserPageCount();
+    if (userPageCount > usage.peakUserPageCount) usage.peakUserPageCount = userPageCount;
+    resourceUsage = ToResourceUsage(usage);
+}
+
 uint64_t Scheduler::GetClock()
 {
     return millisecondsPassed;
@@ -501,6 +925,7 @@ void Scheduler::CreateTaskFromELF(const String& path, const Vector<String>& argu
 
     Task task = CreateTask(pagingManager, new VFS(), new UserspaceAllocator(), entry, GeneratePID(), 0, true,
                            auxiliaryVector, arguments, environment);
+    task.SetName(path.Split('/', path.Count('/')).ToRawString());
 
     int desc = task.vfs->Open(String("/dev/tty"), VFS::OpenFlag::ReadWrite);
     Assert(desc == 0);
@@ -514,6 +939,27 @@ void Scheduler::CreateTaskFromELF(const String& path, const Vector<String>& argu
     taskQueueLock.Release();
 }
 
+// Kernel threads never leave the kernel either, so like the idle tasks they borrow the kernel's page tables
+uint64_t Scheduler::CreateKernelThread(void (*entry)(void*), void* argument, int64_t pinnedCore)
+{
+    Task task = CreateTask(&PagingManager::kernelAddressSpace, kernelVfs, kernelUserspaceAllocator,
+                           reinterpret_cast<uintptr_t>(entry), GeneratePID(), 0, false, nullptr, <%%>, <%%>, true);
+    task.pinnedCore = pinnedCore;
+    task.SetName("kthread");
+    task.frame.rdi = reinterpret_cast<uint64_t>(argument);
+
+    // The stack lives in the higher half so that it doesn't depend on the address space of the thread.
+    // Offset by 8 bytes as if entry had been called, to keep the ABI stack alignment.
+    uintptr_t stackSize = KERNEL_THREAD_STACK_PAGE_COUNT * 0x1000;
+    task.frame.rsp = HigherHalf(RequestPageFrames(KERNEL_THREAD_STACK_PAGE_COUNT) + stackSize) - 8;
+
+    taskQueueLock.Acquire();
+    taskQueue->Push(task);
+    taskQueueLock.Release();
+
+    return task.pid;
+}
+
 Scheduler* Scheduler::GetScheduler()
 {
     // This isn't a race condition, assuming all the cores have
@@ -521,13 +967,17 @@ Scheduler* Scheduler::GetScheduler()
     return CPU::GetStruct().scheduler;
 }
 
+// The idle task never leaves the kernel, so it borrows the kernel's page tables instead of having an address space
 Scheduler::Scheduler(TSS* tss) : lapic(new LAPIC()), tss(tss)
 {
-    auto idlePagingManager = new PagingManager();
-    idlePagingManager->InitializePaging();
     auto idleEntry = reinterpret_cast<uintptr_t>(Idle);
-    idleTask = CreateTask(idlePagingManager, new VFS(), new UserspaceAllocator(), idleEntry, 0, 0, true,
-                          nullptr, <%%>, <%%>, true);
+    idleTask = CreateTask(&PagingManager::kernelAddressSpace, kernelVfs, kernelUserspaceAllocator, idleEntry, 0, 0,
+                          false, nullptr, <%%>, <%%>, true);
+    idleTask.SetName("idle");
+
+    // Interrupts that arrive while the core idles run on this stack, as on a kernel thread's
+    uintptr_t stackSize = KERNEL_THREAD_STACK_PAGE_COUNT * 0x1000;
+    idleTask.frame.rsp = HigherHalf(RequestPageFrames(KERNEL_THREAD_STACK_PAGE_COUNT) + stackSize) - 8;
 
     currentTask = idleTask;
 }
@@ -1,9 +1,51 @@
 #include "Serial.h"
 #include "IO.h"
 #include "Spinlock.h"
+#include "Scheduler.h"
+#include "CPU.h"
+#include "PerCoreRing.h"
+#include "Memory/Memory.h"
 
 constexpr uint16_t PORT = 0xe9;
 
+constexpr uint64_t LOG_RING_SIZE = 64;
+constexpr uint64_t LOG_MESSAGE_SIZE = 176;
+constexpr uint64_t LOG_DRAIN_INTERVAL_MILLISECONDS = 10;
+
+struct LogRecord
+{
+    uint64_t timestamp; // Milliseconds since boot
+    LogLevel level;
+    uint8_t coreId;
+    uint16_t length;
+    char message[LOG_MESSAGE_SIZE];
+};
+
+typedef PerCoreRing<LogRecord, LOG_RING_SIZE> LogRing;
+
+LogRing logRing;
+LogLevel runtimeLevel = LogLevel::Info;
+bool drainThreadStarted = false;
+
+uint64_t drainSequence = 0;
+bool panicking = false;
+Spinlock drainLock {LockClass::LogDrain};
+
+// The panicking core may already hold drainLock, or another core may never get to release it,
+// so once a panic starts the lock is skipped at the cost of output from several cores interleaving
+bool AcquireDrainLock()
+{
+    if (__atomic_load_n(&panicking, __ATOMIC_ACQUIRE)) return false;
+
+    drainLock.Acquire();
+    return true;
+}
+
+void ReleaseDrainLock(bool acquired)
+{
+    if (acquired) drainLock.Release();
+}
+
 uint64_t ToRawString(char* buffer, uint64_t number, unsigned int base)
 {
     Assert(base > 0);
@@ -34,15 +76,16 @@ uint64_t ToRawString(char* buffer, uint64_t number, unsigned int base)
     return size;
 }
 
-void Serial::Log(const char* string, ...)
+uint16_t FormatMessage(char* buffer, const char* format, va_list args)
 {
-    va_list args;
-    va_start(args, string);
-
-    char formatBuffer[128];
-    char* bufferPtr = formatBuffer;
+    uint64_t length = 0;
+    auto append = [buffer, &length](char c)
+    {
+        if (length < LOG_MESSAGE_SIZE) buffer[length++] = c;
+    };
 
-    const char* c = string;
+    char numberBuffer[20];
+    const char* c = format;
     bool nextIsFormatCode = false;
     while (*c != 0)
     {
@@ -51,19 +94,16 @@ void Serial::Log(const char* string, ...)
             switch (*c)
             {
                 case 'd':
-                {
-                    bufferPtr += ToRawString(bufferPtr, va_arg(args, uint64_t), 10);
-                    break;
-                }
                 case 'x':
                 {
-                    bufferPtr += ToRawString(bufferPtr, va_arg(args, uint64_t), 16);
+                    uint64_t numberLength = ToRawString(numberBuffer, va_arg(args, uint64_t), *c == 'd' ? 10 : 16);
+                    for (uint64_t i = 0; i < numberLength; ++i) append(numberBuffer[i]);
                     break;
                 }
                 case 's':
                 {
                     const char* s = va_arg(args, const char*);
-                    while (*s != 0) *bufferPtr++ = *s++;
+                    while (*s != 0) append(*s++);
                     break;
                 }
             }
@@ -71,23 +111,192 @@ void Serial::Log(const char* string, ...)
         }
         else if (*c == '%')
         {
-            Assert(!nextIsFormatCode);
             nextIsFormatCode = true;
         }
         else
         {
-            *bufferPtr++ = *c;
+            append(*c);
         }
         c++;
     }
-    *bufferPtr = 0;
 
-    va_end(args);
+    return length;
+}
 
-    static Spinlock lock;
-    lock.Acquire();
-    bufferPtr = formatBuffer;
-    while (*bufferPtr != 0) outb(PORT, *bufferPtr++);
+void WriteToPort(const char* message, uint64_t length)
+{
+    for (uint64_t i = 0; i < length; ++i) outb(PORT, message[i]);
     outb(PORT, '\n');
-    lock.Release();
-}
\ No newline at end of file
+}
+
+void Serial::Log(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    VLog(LogLevel::Info, format, args);
+    va_end(args);
+}
+
+void Serial::Log(LogLevel level, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    VLog(level, format, args);
+    va_end(args);
+}
+
+void Serial::VLog(LogLevel level, const char* format, va_list args)
+{
+    if (level < runtimeLevel) return;
+
+    bool pushed = logRing.Push([level, format, &args](LogRecord& record)
+    {
+        record.timestamp = Scheduler::GetClock();
+        record.level = level;
+        record.coreId = CPU::GetCoreID();
+        record.length = FormatMessage(record.message, format, args);
+    });
+
+    if (!pushed)
+    {
+        // No ring for this core, fall back to writing synchronously
+        char message[LOG_MESSAGE_SIZE];
+        uint16_t length = FormatMessage(message, format, args);
+
+        bool acquired = AcquireDrainLock();
+        WriteToPort(message, length);
+        ReleaseDrainLock(acquired);
+    }
+
+    // Until the drain thread runs, nothing else would write the message out
+    if (!drainThreadStarted) Flush();
+}
+
+void Serial::SetLevel(LogLevel level)
+{
+    runtimeLevel = level;
+}
+
+void Serial::StartDrainThread()
+{
+    Scheduler::CreateKernelThread(DrainThread, nullptr);
+    drainThreadStarted = true;
+}
+
+void Serial::Flush()
+{
+    bool acquired = AcquireDrainLock();
+
+    uint64_t lostCount = 0;
+    while (true)
+    {
+        LogRecord record;
+        uint64_t nextAvailable;
+        LogRing::Status status = logRing.Find(drainSequence, record, nextAvailable);
+
+        if (status == LogRing::Status::Pending) break;
+
+        if (status == LogRing::Status::Lost)
+        {
+            lostCount += nextAvailable - drainSequence;
+            drainSequence = nextAvailable;
+            continue;
+        }
+
+        if (lostCount > 0)
+        {
+            char message[LOG_MESSAGE_SIZE];
+            uint64_t length = ToRawString(message, lostCount, 10);
+            const char* suffix = " log messages were lost";
+            while (*suffix != 0) message[length++] = *suffix++;
+            WriteToPort(message, length);
+            lostCount = 0;
+        }
+
+        WriteToPort(record.message, record.length);
+        drainSequence++;
+    }
+
+    ReleaseDrainLock(acquired);
+}
+
+void Serial::EnterPanicMode()
+{
+    __atomic_store_n(&panicking, true, __ATOMIC_RELEASE);
+}
+
+// Bypasses the rings, for bulk output that would overrun them
+void Serial::LogSynchronously(const char* format, ...)
+{
+    char message[LOG_MESSAGE_SIZE];
+    va_list args;
+    va_start(args, format);
+    uint16_t length = FormatMessage(message, format, args);
+    va_end(args);
+
+    WriteSynchronously(message, length);
+}
+
+// Writes one line as is
+void Serial::WriteSynchronously(const char* text, uint64_t length)
+{
+    // Keep the output ordered after anything already queued
+    Flush();
+
+    bool acquired = AcquireDrainLock();
+    WriteToPort(text, length);
+    ReleaseDrainLock(acquired);
+}
+
+// Formats one record like Linux's /dev/kmsg: "level,sequence,timestamp in microseconds,-;message\n"
+uint64_t Serial::ReadRecord(char* buffer, uint64_t count, uint64_t& sequence, Error& error)
+{
+    LogRecord record;
+    while (true)
+    {
+        uint64_t nextAvailable;
+        LogRing::Status status = logRing.Find(sequence, record, nextAvailable);
+
+        if (status == LogRing::Status::Pending) return 0;
+        if (status == LogRing::Status::Found) break;
+
+        sequence = nextAvailable;
+    }
+
+    // Syslog priorities: 7 is debug, 6 info, 4 warning and 3 error
+    constexpr char priorities[] = {'7', '6', '4', '3'};
+
+    char header[64];
+    uint64_t headerLength = 0;
+    header[headerLength++] = priorities[static_cast<uint8_t>(record.level)];
+    header[headerLength++] = ',';
+    headerLength += ToRawString(header + headerLength, sequence, 10);
+    header[headerLength++] = ',';
+    headerLength += ToRawString(header + headerLength, record.timestamp * 1000, 10);
+    header[headerLength++] = ',';
+    header[headerLength++] = '-';
+    header[headerLength++] = ';';
+
+    uint64_t length = headerLength + record.length + 1;
+    if (length > count)
+    {
+        error = Error::InvalidArgument;
+        return 0;
+    }
+
+    memcpy(buffer, header, headerLength);
+    memcpy(buffer + headerLength, record.message, record.length);
+    buffer[length - 1] = '\n';
+
+    sequence++;
+    return length;
+}
+
+void Serial::DrainThread(void*)
+{
+    while (true)
+    {
+        Flush();
+        Scheduler::GetScheduler()->SleepCurrentTask(LOG_DRAIN_INTERVAL_MILLISECONDS);
+    }
+}
@@ -1,13 +1,42 @@
 #include "Spinlock.h"
+#include "LockStatistics.h"
+#include "CPU.h"
+
+constexpr uint64_t INTERRUPT_FLAG = 1 << 9;
 
 void Spinlock::Acquire()
 {
+    uint64_t flags;
+    asm volatile("pushfq; pop %0; cli" : "=r"(flags) : : "memory");
+
     auto ticket = __atomic_fetch_add(&nextTicket, 1, __ATOMIC_RELAXED);
+
+#ifdef LOCK_STATISTICS
+    uint64_t spinStart = CPU::ReadTimestampCounter();
+    bool contended = __atomic_load_n(&servingTicket, __ATOMIC_ACQUIRE) != ticket;
+#endif
+
     while (__atomic_load_n(&servingTicket, __ATOMIC_ACQUIRE) != ticket);
+
+#ifdef LOCK_STATISTICS
+    acquiredTimestamp = CPU::ReadTimestampCounter();
+    acquiredCaller = reinterpret_cast<uintptr_t>(__builtin_return_address(0));
+    LockStatistics::RecordAcquisition(lockClass, contended, acquiredTimestamp - spinStart, acquiredCaller);
+#endif
+
+    savedFlags = flags;
 }
 
 void Spinlock::Release()
 {
+    uint64_t flags = savedFlags;
+
+#ifdef LOCK_STATISTICS
+    LockStatistics::RecordRelease(lockClass, CPU::ReadTimestampCounter() - acquiredTimestamp, acquiredCaller);
+#endif
+
     auto current = __atomic_load_n(&servingTicket, __ATOMIC_RELAXED);
     __atomic_store_n(&servingTicket, current + 1, __ATOMIC_RELEASE);
-}
\ No newline at end of file
+
+    if (flags & INTERRUPT_FLAG) asm volatile("sti" : : : "memory");
+}
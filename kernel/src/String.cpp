@@ -61,7 +61,7 @@ bool String::Equals(const char* other) const
 
 char String::operator[](uint64_t index) const
 {
-    Assert(index < length);
+    DebugAssert(index < length);
     return buffer[index];
 }
 
@@ -84,7 +84,7 @@ bool String::Match(uint64_t index, char c, bool assertValidIndex) const
 {
     if (assertValidIndex && index >= length) return false;
 
-    Assert(index < length);
+    DebugAssert(index < length);
     return buffer[index] == c;
 }
 
@@ -92,7 +92,7 @@ bool String::IsNumeric(uint64_t index, bool assertValidIndex) const
 {
     if (assertValidIndex && index >= length) return false;
 
-    Assert(index < length);
+    DebugAssert(index < length);
     return buffer[index] >= '0' && buffer[index] <= '9';
 }
 
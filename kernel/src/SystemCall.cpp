@@ -41,6 +41,15 @@ uint64_t SystemCall(SystemCallType type, uint64_t arg0, uint64_t arg1, uint64_t
         case SystemCallType::FileMap:
             return reinterpret_cast<uintptr_t>(FileMap((void*)arg0, arg1));
 
+        case SystemCallType::DescriptorMap:
+        {
+            void* addr = scheduler->currentTask.vfs->Map((int)arg0, (void*)arg1, arg2, error);
+            return reinterpret_cast<uintptr_t>(addr);
+        }
+
+        case SystemCallType::Control:
+            return scheduler->currentTask.vfs->Control((int)arg0, arg1, (void*)arg2, error);
+
         case SystemCallType::Log:
             Serial::Log("%s", arg0); return 0;
 
@@ -70,6 +79,10 @@ uint64_t SystemCall(SystemCallType type, uint64_t arg0, uint64_t arg1, uint64_t
             return 0;
         }
 
+        case SystemCallType::Yield:
+            scheduler->YieldCurrentTask();
+            return 0;
+
         case SystemCallType::FStat:
         {
             int fd = (int)arg0;
@@ -85,6 +98,12 @@ uint64_t SystemCall(SystemCallType type, uint64_t arg0, uint64_t arg1, uint64_t
             return 0;
         }
 
+        case SystemCallType::SetTerminalReadPolicy:
+        {
+            scheduler->currentTask.vfs->SetTerminalReadPolicy((int)arg0, (uint8_t)arg1, (uint8_t)arg2, error);
+            return 0;
+        }
+
         case SystemCallType::GetTerminalWindowSize:
         {
             auto windowSize = reinterpret_cast<WindowSize*>(arg1);
@@ -188,7 +207,15 @@ uint64_t SystemCall(SystemCallType type, uint64_t arg0, uint64_t arg1, uint64_t
         case SystemCallType::Wait:
         {
             int* status = reinterpret_cast<int*>(arg1);
-            return scheduler->WaitForChild(arg0, *status, error);
+            auto childUsage = reinterpret_cast<ResourceUsage*>(arg2);
+            return scheduler->WaitForChild(arg0, *status, childUsage, error);
+        }
+
+        case SystemCallType::GetResourceUsage:
+        {
+            auto resourceUsage = reinterpret_cast<ResourceUsage*>(arg1);
+            scheduler->GetResourceUsage(static_cast<int64_t>(arg0), *resourceUsage, error);
+            return 0;
         }
 
         case SystemCallType::ReadDirectory:
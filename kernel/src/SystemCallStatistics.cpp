@@ -0,0 +1,122 @@
+#include "SystemCallStatistics.h"
+#include "SystemCall.h"
+#include "PerCoreRing.h"
+#include "CPU.h"
+
+// Types are at most 255, Panic and Log are at the top of the range
+constexpr uint64_t SYSTEM_CALL_TYPE_COUNT = 256;
+constexpr uint64_t NAME_COLUMN_WIDTH = 26;
+
+uint64_t systemCallCounts[PER_CORE_RING_MAX_CORES][SYSTEM_CALL_TYPE_COUNT];
+
+const char* GetSystemCallName(uint64_t type)
+{
+    switch (static_cast<SystemCallType>(type))
+    {
+        case SystemCallType::Open:
+            return "Open";
+        case SystemCallType::Read:
+            return "Read";
+        case SystemCallType::Write:
+            return "Write";
+        case SystemCallType::Seek:
+            return "Seek";
+        case SystemCallType::Close:
+            return "Close";
+        case SystemCallType::FileMap:
+            return "FileMap";
+        case SystemCallType::TCBSet:
+            return "TCBSet";
+        case SystemCallType::Clock:
+            return "Clock";
+        case SystemCallType::Exit:
+            return "Exit";
+        case SystemCallType::Sleep:
+            return "Sleep";
+        case SystemCallType::Stat:
+            return "Stat";
+        case SystemCallType::FStat:
+            return "FStat";
+        case SystemCallType::SetTerminalSettings:
+            return "SetTerminalSettings";
+        case SystemCallType::GetTerminalWindowSize:
+            return "GetTerminalWindowSize";
+        case SystemCallType::GetPID:
+            return "GetPID";
+        case SystemCallType::GetWorkingDirectory:
+            return "GetWorkingDirectory";
+        case SystemCallType::Fork:
+            return "Fork";
+        case SystemCallType::Wait:
+            return "Wait";
+        case SystemCallType::GetParentPID:
+            return "GetParentPID";
+        case SystemCallType::SetWorkingDirectory:
+            return "SetWorkingDirectory";
+        case SystemCallType::Execute:
+            return "Execute";
+        case SystemCallType::ReadDirectory:
+            return "ReadDirectory";
+        case SystemCallType::GetFileDescriptorFlags:
+            return "GetFileDescriptorFlags";
+        case SystemCallType::CreateDirectory:
+            return "CreateDirectory";
+        case SystemCallType::SetTerminalReadPolicy:
+            return "SetTerminalReadPolicy";
+        case SystemCallType::Control:
+            return "Control";
+        case SystemCallType::DescriptorMap:
+            return "DescriptorMap";
+        case SystemCallType::GetResourceUsage:
+            return "GetResourceUsage";
+        case SystemCallType::Yield:
+            return "Yield";
+        case SystemCallType::Panic:
+            return "Panic";
+        case SystemCallType::Log:
+            return "Log";
+    }
+    return "Unknown";
+}
+
+void SystemCallStatistics::Record(uint64_t type)
+{
+    uint32_t coreId = CPU::GetCoreID();
+    if (coreId >= PER_CORE_RING_MAX_CORES || type >= SYSTEM_CALL_TYPE_COUNT) return;
+
+    systemCallCounts[coreId][type]++;
+}
+
+void SystemCallStatistics::Report(TextWriter& writer)
+{
+    uint32_t coreCount = CPU::GetCoreCount();
+    if (coreCount > PER_CORE_RING_MAX_CORES) coreCount = PER_CORE_RING_MAX_CORES;
+
+    writer.Pad(NAME_COLUMN_WIDTH + 6);
+    writer.Write("Total");
+    for (uint32_t coreId = 0; coreId < coreCount; ++coreId)
+    {
+        writer.Pad(NAME_COLUMN_WIDTH + 18 + 11 * coreId);
+        writer.Write("CPU");
+        writer.WriteDecimal(coreId);
+    }
+    writer.Write('\n');
+
+    for (uint64_t type = 0; type < SYSTEM_CALL_TYPE_COUNT; ++type)
+    {
+        uint64_t total = 0;
+        for (uint32_t coreId = 0; coreId < coreCount; ++coreId) total += systemCallCounts[coreId][type];
+        if (total == 0) continue;
+
+        writer.Write(GetSystemCallName(type));
+        writer.Write(':');
+        writer.Pad(NAME_COLUMN_WIDTH);
+        writer.WriteDecimal(total, 11);
+        for (uint32_t coreId = 0; coreId < coreCount; ++coreId)
+        {
+            writer.Write(' ');
+            writer.WriteDecimal(systemCallCounts[coreId][type], 10);
+        }
+        writer.Write('\n');
+    }
+}
@@ -0,0 +1,41 @@
+#include "SystemCallTrace.h"
+#include "PerCoreRing.h"
+
+constexpr uint64_t TRACE_RING_SIZE = 128;
+
+PerCoreRing<SystemCallTraceRecord, TRACE_RING_SIZE> traceRing;
+
+void SystemCallTrace::Record(const SystemCallTraceRecord& record)
+{
+    // Cores without a ring simply aren't traced
+    traceRing.Push([&record](SystemCallTraceRecord& slot) { slot = record; });
+}
+
+// Records that were overwritten before being read are skipped
+uint64_t SystemCallTrace::Read(SystemCallTraceRecord* buffer, uint64_t maxCount, uint64_t& sequence)
+{
+    uint64_t count = 0;
+    while (count < maxCount)
+    {
+        uint64_t nextAvailable;
+        auto status = traceRing.Find(sequence, buffer[count], nextAvailable);
+
+        if (status == decltype(traceRing)::Status::Pending) break;
+
+        if (status == decltype(traceRing)::Status::Lost)
+        {
+            sequence = nextAvailable;
+            continue;
+        }
+
+        sequence++;
+        count++;
+    }
+
+    return count;
+}
+
+uint64_t SystemCallTrace::GetNextSequence()
+{
+    return traceRing.GetNextSequence();
+}
@@ -0,0 +1,47 @@
+#include "SystemCallTraceDevice.h"
+#include "SystemCallTrace.h"
+#include "Scheduler.h"
+
+uint64_t SystemCallTraceDevice::ReadStream(void* buffer, uint64_t count, uint64_t& sequence, bool nonBlocking, Error& error)
+{
+    auto records = static_cast<SystemCallTraceRecord*>(buffer);
+    uint64_t recordCount = SystemCallTrace::Read(records, count / sizeof(SystemCallTraceRecord), sequence);
+    return recordCount * sizeof(SystemCallTraceRecord);
+
+    (void)nonBlocking;
+    (void)error;
+}
+
+// Readers only see the system calls made after they open the trace
+uint64_t SystemCallTraceDevice::GetStreamStart()
+{
+    return SystemCallTrace::GetNextSequence();
+}
+
+// Records only come from the system call handler, VFS rejects writes from userspace before they get here
+uint64_t SystemCallTraceDevice::Write(const void* buffer, uint64_t count, uint64_t position)
+{
+    (void)buffer;
+    (void)count;
+    (void)position;
+    return 0;
+}
+
+uint64_t SystemCallTraceDevice::Control(uint64_t request, void* argument, Error& error)
+{
+    if (request != static_cast<uint64_t>(SystemCallTraceRequest::SetTraced))
+    {
+        error = Error::InvalidArgument;
+        return 0;
+    }
+
+    auto control = static_cast<SystemCallTraceControl*>(argument);
+    if (control->pid == 0 || !Scheduler::SetTraced(control->pid, control->enabled != 0))
+    {
+        error = Error::InvalidArgument;
+    }
+
+    return 0;
+}
+
+SystemCallTraceDevice::SystemCallTraceDevice(const String& name, uint32_t inodeNum) : Device(name, inodeNum) {}
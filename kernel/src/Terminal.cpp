@@ -5,6 +5,8 @@
 
 void Terminal::Write(const String& string)
 {
+    lock.Acquire();
+
     // Erase previous cursor
     if (!pendingWrap)
         textRenderer->Paint(cursorX, cursorY, backgroundColour);
@@ -56,36 +58,38 @@ void Terminal::Write(const String& string)
             }
             case '\033': // Escape
             {
+                // Userspace can end the write anywhere, so every lookahead checks the index
                 EscapeSequence escapeSequence;
 
-                escapeSequence.controlSequence = string.Match(currentIndex, '[');
+                escapeSequence.controlSequence = string.Match(currentIndex, '[', true);
                 if (escapeSequence.controlSequence) currentIndex++;
 
-                escapeSequence.decPrivate = string.Match(currentIndex, '?');
+                escapeSequence.decPrivate = string.Match(currentIndex, '?', true);
                 if (escapeSequence.decPrivate) currentIndex++;
 
-                escapeSequence.rightParentheses = string.Match(currentIndex, ')');
+                escapeSequence.rightParentheses = string.Match(currentIndex, ')', true);
                 if (escapeSequence.rightParentheses) currentIndex++;
 
-                if (escapeSequence.controlSequence && string.IsNumeric(currentIndex))
+                if (escapeSequence.controlSequence && string.IsNumeric(currentIndex, true))
                 {
                     while (true)
                     {
                         String numberString;
-                        while (string.IsNumeric(currentIndex))
+                        while (string.IsNumeric(currentIndex, true))
                         {
                             numberString.Push(string[currentIndex++]);
                         }
 
-                        Assert(numberString.GetLength() > 0);
+                        if (numberString.GetLength() == 0) break; // Nothing after the ';'
                         escapeSequence.controlArguments.Push(numberString.ToUnsignedInt());
 
-                        if (string.Match(currentIndex, ';')) currentIndex++;
+                        if (string.Match(currentIndex, ';', true)) currentIndex++;
                         else break;
                     }
                 }
 
-                Assert(currentIndex < string.GetLength());
+                // A sequence cut off by the end of the write is dropped
+                if (currentIndex >= string.GetLength()) break;
                 escapeSequence.command = string[currentIndex++];
 
                 ProcessEscapeSequence(escapeSequence);
@@ -132,6 +136,8 @@ void Terminal::Write(const String& string)
         textRenderer->Print('_', cursorX, cursorY, textColour, backgroundColour);
     else
         textRenderer->Print('_', 0, cursorY + 1, textColour, backgroundColour);
+
+    lock.Release();
 }
 
 Terminal::Terminal() : textRenderer(new TextRenderer()),
@@ -2,6 +2,11 @@
 #include "Terminal.h"
 #include "Scheduler.h"
 #include "Serial.h"
+#include "Heap.h"
+#include "Math.h"
+#include "Memory/Memory.h"
+
+constexpr uint64_t INPUT_BUFFER_SIZE = 4096;
 
 TerminalDevice* TerminalDevice::instance = nullptr;
 
@@ -9,38 +14,76 @@ uint64_t TerminalDevice::Read(void* buffer, uint64_t count, uint64_t position)
 {
     Assert(position == 0);
 
-    char* charBuffer = static_cast<char*>(buffer);
+    if (count == 0) return 0;
+
+    lock.Acquire();
 
-    if (count > (canonical ? lines.Get(0).GetLength() : rawBuffer.GetLength()))
+    // Canonical reads wait for a complete line. Non-canonical reads follow the VMIN/VTIME rules of termios:
+    // VMIN is the number of characters to wait for, and VTIME is a timeout that, if VMIN is above 0,
+    // only starts once at least one character has been received.
+    uint64_t requiredCount = 1;
+    uint64_t timeoutMilliseconds = 0;
+    if (!canonical)
     {
-        Scheduler* scheduler = Scheduler::GetScheduler();
-        unblockQueue.Push({scheduler->currentTask.pid, count});
-        scheduler->SuspendSystemCall(TaskState::Blocked);
+        requiredCount = minimumReadCount > 0 ? Min(count, minimumReadCount) : (readTimeout > 0 ? 1 : 0);
+        timeoutMilliseconds = readTimeout * 100;
     }
 
-    uint64_t readCount;
-    if (canonical)
+    while (commitIndex - readIndex < requiredCount)
     {
-        Vector<char>& line = lines.Get(0);
-        readCount = count <= line.GetLength() ? count : line.GetLength();
-        for (uint64_t i = readCount; i-- > 0; )
-        {
-            charBuffer[i] = line.Pop(i);
-        }
-        if (line.GetLength() == 0) lines.Pop(0);
+        bool timerStarted = minimumReadCount == 0 || commitIndex - readIndex > 0;
+
+        Scheduler* scheduler = Scheduler::GetScheduler();
+        unblockQueue.Push({scheduler->currentTask.pid, scheduler->currentTask.suspensionId});
+        lock.Release();
+
+        uint64_t result = scheduler->SuspendSystemCall(TaskState::Blocked, 0, timerStarted ? timeoutMilliseconds : 0);
+
+        lock.Acquire();
+        if (result == SUSPENSION_TIMED_OUT) break;
     }
-    else
+
+    uint64_t readCount = CopyInput(static_cast<char*>(buffer), count);
+
+    lock.Release();
+    return readCount;
+}
+
+uint64_t TerminalDevice::CopyInput(char* buffer, uint64_t count)
+{
+    uint64_t readCount = Min(count, commitIndex - readIndex);
+
+    // A canonical read never returns more than one line
+    if (canonical)
     {
-        readCount = count <= rawBuffer.GetLength() ? count : rawBuffer.GetLength();
-        for (uint64_t i = readCount; i-- > 0; )
+        for (uint64_t i = 0; i < readCount; ++i)
         {
-            charBuffer[i] = rawBuffer.Pop(i);
+            if (inputBuffer[(readIndex + i) % INPUT_BUFFER_SIZE] == '\n')
+            {
+                readCount = i + 1;
+                break;
+            }
         }
     }
 
+    uint64_t offset = readIndex % INPUT_BUFFER_SIZE;
+    uint64_t firstCount = Min(readCount, INPUT_BUFFER_SIZE - offset);
+    memcpy(buffer, inputBuffer + offset, firstCount);
+    memcpy(buffer + firstCount, inputBuffer, readCount - firstCount);
+
+    readIndex += readCount;
     return readCount;
 }
 
+void TerminalDevice::WakeReaders()
+{
+    // Every waiting reader rechecks its own condition, so all of them can be woken up
+    while (!unblockQueue.IsEmpty())
+    {
+        ReadRequest request = unblockQueue.Pop();
+        Scheduler::Unsuspend(request.pid, request.suspensionId, 0);
+    }
+}
 
 uint64_t TerminalDevice::Write(const void* buffer, uint64_t count, uint64_t position)
 {
@@ -52,30 +95,65 @@ uint64_t TerminalDevice::Write(const void* buffer, uint64_t count, uint64_t posi
 
 void TerminalDevice::KeyboardInput(char c)
 {
+    lock.Acquire();
+
     if (c == '\b' && canonical)
     {
-        if (lines.GetLength() == 0 || lines.GetLast().GetLength() == 0)
+        if (editIndex == commitIndex)
         {
+            lock.Release();
             return;
         }
-        lines.GetLast().Pop();
+        editIndex--;
     }
     else
     {
-        if (canonical && lines.GetLength() == 0) lines.Push({});
+        // When the buffer is full, input is dropped, but canonical mode keeps room to terminate the line
+        uint64_t capacity = canonical && c != '\n' ? INPUT_BUFFER_SIZE - 1 : INPUT_BUFFER_SIZE;
+        if (editIndex - readIndex >= capacity)
+        {
+            lock.Release();
+            return;
+        }
 
-        Vector<char>& buffer = canonical ? lines.GetLast() : rawBuffer;
-        buffer.Push(c);
+        inputBuffer[editIndex++ % INPUT_BUFFER_SIZE] = c;
 
-        bool isNewline = c == '\n';
-        if (isNewline && canonical) lines.Push({});
-        else if (!unblockQueue.IsEmpty() && (isNewline || unblockQueue.Get(0).requestedCount <= buffer.GetLength()))
+        if (!canonical || c == '\n')
         {
-            Scheduler::Unsuspend(unblockQueue.Pop(0).pid, 0);
+            commitIndex = editIndex;
+            WakeReaders();
         }
     }
 
-    if (echo || canonical) terminal->Write(String(c));
+    bool echoInput = echo || canonical;
+    lock.Release();
+
+    if (echoInput) terminal->Write(String(c));
+}
+
+void TerminalDevice::SetMode(bool newCanonical, bool newEcho)
+{
+    lock.Acquire();
+
+    canonical = newCanonical;
+    echo = newEcho;
+
+    // A line that was being edited becomes readable as soon as canonical mode is left
+    if (!canonical && commitIndex != editIndex)
+    {
+        commitIndex = editIndex;
+        WakeReaders();
+    }
+
+    lock.Release();
+}
+
+void TerminalDevice::SetReadPolicy(uint8_t newMinimumReadCount, uint8_t newReadTimeout)
+{
+    lock.Acquire();
+    minimumReadCount = newMinimumReadCount;
+    readTimeout = newReadTimeout;
+    lock.Release();
 }
 
 TerminalDevice::TerminalDevice(const String& name, uint32_t inodeNum) : Device(name, inodeNum)
@@ -83,11 +161,13 @@ TerminalDevice::TerminalDevice(const String& name, uint32_t inodeNum) : Device(n
     Assert(instance == nullptr);
     instance = this;
 
-    lines.Push({});
+    inputBuffer = new (Allocator::Permanent) char[INPUT_BUFFER_SIZE];
     terminal = new Terminal();
 
     canonical = true;
     echo = true;
+    minimumReadCount = 1;
+    readTimeout = 0;
 }
 
 WindowSize TerminalDevice::GetWindowSize()
@@ -1,17 +1,33 @@
 #include "TextRenderer.h"
 #include "Framebuffer.h"
+#include "CPU.h"
+#include "BootProfiler.h"
 
 const char* FONT_PATH = "/fonts/ibm/iv9x16u.psfu";
 
-TextRenderer::TextRenderer() : font(new PSF2(String(FONT_PATH))) {}
+TextRenderer::TextRenderer()
+{
+    uint64_t loadStart = CPU::ReadTimestampCounter();
+    font = new PSF2(String(FONT_PATH));
+    BootProfiler::Record(BootPhase::Font, loadStart);
+}
 
 TextRenderer::~TextRenderer()
 {
     delete font;
 }
 
+// Cells off the screen, like the cursor's after a wrap on the last row, are skipped
+bool TextRenderer::IsOnScreen(long x, long y)
+{
+    WindowSize windowSize = GetWindowSize();
+    return x >= 0 && y >= 0 && x < windowSize.columnCount && y < windowSize.rowCount;
+}
+
 void TextRenderer::Print(char c, long x, long y, const Colour& colour, const Colour& bgColour)
 {
+    if (!IsOnScreen(x, y)) return;
+
     PSF2Glyph glyph = font->GetGlyphBitmap(c);
     for (uint32_t glyphY = 0; glyphY < font->Height(); ++glyphY)
     {
@@ -26,6 +42,8 @@ void TextRenderer::Print(char c, long x, long y, const Colour& colour, const Col
 
 void TextRenderer::Paint(long x, long y, const Colour& colour)
 {
+    if (!IsOnScreen(x, y)) return;
+
     for (uint32_t glyphY = 0; glyphY < font->Height(); ++glyphY)
     {
         for (uint32_t glyphX = 0; glyphX < font->Width(); ++glyphX)
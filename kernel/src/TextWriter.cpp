@@ -0,0 +1,55 @@
+#include "TextWriter.h"
+
+void TextWriter::Write(char c)
+{
+    if (textLength >= position && textLength - position < count)
+    {
+        buffer[textLength - position] = c;
+    }
+
+    textLength++;
+    if (c == '\n') lineStart = textLength;
+}
+
+void TextWriter::Write(const char* string)
+{
+    while (*string != 0) Write(*string++);
+}
+
+void TextWriter::WriteDecimal(uint64_t number, uint64_t width)
+{
+    char digits[20];
+    uint64_t digitCount = 0;
+    do
+    {
+        digits[digitCount++] = static_cast<char>('0' + number % 10);
+        number /= 10;
+    } while (number > 0);
+
+    for (uint64_t i = digitCount; i < width; ++i) Write(' ');
+    while (digitCount > 0) Write(digits[--digitCount]);
+}
+
+void TextWriter::WriteHex(uint64_t number)
+{
+    uint64_t digitCount = 1;
+    while (digitCount < 16 && (number >> (digitCount * 4)) != 0) digitCount++;
+
+    for (uint64_t i = digitCount; i-- > 0; )
+    {
+        Write("0123456789abcdef"[(number >> (i * 4)) & 0xf]);
+    }
+}
+
+void TextWriter::Pad(uint64_t column)
+{
+    while (textLength - lineStart < column) Write(' ');
+}
+
+uint64_t TextWriter::GetWrittenCount() const
+{
+    if (textLength <= position) return 0;
+    return textLength - position < count ? textLength - position : count;
+}
+
+TextWriter::TextWriter(char* buffer, uint64_t count, uint64_t position) : buffer(buffer), count(count), position(position) {}
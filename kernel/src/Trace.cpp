@@ -0,0 +1,65 @@
+#include "Trace.h"
+#include "PerCoreRing.h"
+#include "CPU.h"
+#include "Serial.h"
+
+constexpr uint64_t TRACE_RING_SIZE = 256;
+
+uint64_t Trace::enabledEvents = 0;
+PerCoreRing<TraceRecord, TRACE_RING_SIZE> traceRecords;
+
+void Trace::Record(TraceEvent event, uint64_t start, uint64_t argument0, uint64_t argument1)
+{
+    uint64_t now = CPU::ReadTimestampCounter();
+    auto pid = static_cast<uint32_t>(Scheduler::GetScheduler()->currentTask.pid);
+
+    traceRecords.Push([event, start, now, pid, argument0, argument1](TraceRecord& record)
+    {
+        record.timestamp = start == 0 ? now : start;
+        record.duration = start == 0 ? 0 : now - start;
+        record.arguments[0] = argument0;
+        record.arguments[1] = argument1;
+        record.pid = pid;
+        record.event = static_cast<uint16_t>(event);
+        record.coreId = CPU::GetCoreID();
+    });
+}
+
+// Records that were overwritten before being read are skipped
+uint64_t Trace::Read(TraceRecord* buffer, uint64_t maxCount, uint64_t& sequence)
+{
+    uint64_t count = 0;
+    while (count < maxCount)
+    {
+        uint64_t nextAvailable;
+        auto status = traceRecords.Find(sequence, buffer[count], nextAvailable);
+
+        if (status == decltype(traceRecords)::Status::Pending) break;
+
+        if (status == decltype(traceRecords)::Status::Lost)
+        {
+            sequence = nextAvailable;
+            continue;
+        }
+
+        sequence++;
+        count++;
+    }
+
+    return count;
+}
+
+// Writes every record still in the buffers as text lines that tools/trace2json.py understands:
+// "trace-tsc <frequency>" followed by "trace <timestamp> <duration> <event> <core> <pid> <argument0> <argument1>"
+void Trace::DumpToDebugPort()
+{
+    Serial::LogSynchronously("trace-tsc %d", CPU::GetTimestampCounterFrequency());
+
+    uint64_t sequence = 0;
+    TraceRecord record;
+    while (Read(&record, 1, sequence) == 1)
+    {
+        Serial::LogSynchronously("trace %x %x %x %x %x %x %x", record.timestamp, record.duration,
+                                 record.event, record.coreId, record.pid, record.arguments[0], record.arguments[1]);
+    }
+}
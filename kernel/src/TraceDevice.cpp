@@ -0,0 +1,38 @@
+#include "TraceDevice.h"
+#include "Trace.h"
+
+uint64_t TraceDevice::ReadStream(void* buffer, uint64_t count, uint64_t& sequence, bool nonBlocking, Error& error)
+{
+    uint64_t recordCount = Trace::Read(static_cast<TraceRecord*>(buffer), count / sizeof(TraceRecord), sequence);
+    return recordCount * sizeof(TraceRecord);
+
+    (void)nonBlocking;
+    (void)error;
+}
+
+// The trace buffer is only written by tracepoints, VFS rejects writes from userspace before they get here
+uint64_t TraceDevice::Write(const void* buffer, uint64_t count, uint64_t position)
+{
+    (void)buffer;
+    (void)count;
+    (void)position;
+    return 0;
+}
+
+uint64_t TraceDevice::Control(uint64_t request, void* argument, Error& error)
+{
+    switch (static_cast<TraceRequest>(request))
+    {
+        case TraceRequest::SetEnabledEvents:
+            Trace::enabledEvents = *static_cast<uint64_t*>(argument);
+            return 0;
+        case TraceRequest::DumpToDebugPort:
+            Trace::DumpToDebugPort();
+            return 0;
+    }
+
+    error = Error::InvalidArgument;
+    return 0;
+}
+
+TraceDevice::TraceDevice(const String& name, uint32_t inodeNum) : Device(name, inodeNum) {}
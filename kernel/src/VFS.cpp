@@ -1,11 +1,14 @@
 #include "VFS.h"
 #include "Ext2.h"
 #include "DeviceFS.h"
+#include "ProcFS.h"
 #include "Vector.h"
 #include "Serial.h"
 #include "RAMDisk.h"
 #include "Heap.h"
 #include "TerminalDevice.h"
+#include "Device.h"
+#include "Trace.h"
 
 VFS::Vnode* root;
 VFS::Vnode* currentInCache = nullptr;
@@ -35,6 +38,10 @@ void VFS::Initialize(void* ext2RamDisk)
     VFS::Vnode* devMountPoint = kernelVfs->CreateDirectory(String("/dev"));
     FileSystem* deviceFileSystem = new DeviceFS(nullptr);
     Mount(devMountPoint, deviceFileSystem->fileSystemRoot);
+
+    VFS::Vnode* procMountPoint = kernelVfs->CreateDirectory(String("/proc"));
+    FileSystem* processFileSystem = new ProcFS(nullptr);
+    Mount(procMountPoint, processFileSystem->fileSystemRoot);
 }
 
 void VFS::CacheVNode(VFS::Vnode* vnode)
@@ -45,7 +52,7 @@ void VFS::CacheVNode(VFS::Vnode* vnode)
 
 VFS::FileDescriptor* VFS::GetFileDescriptor(int descriptor)
 {
-    if (descriptor >= static_cast<int>(fileDescriptors.GetLength()))
+    if (descriptor < 0 || descriptor >= static_cast<int>(fileDescriptors.GetLength()))
     {
         return nullptr;
     }
@@ -93,7 +100,7 @@ VFS::Vnode* VFS::TraversePath(String path, String& fileName, VFS::Vnode*& contai
         fileName = path.Split('/', currentDepth + 1);
         Assert(!fileName.IsEmpty());
 
-        Serial::Log("PATH TOKEN: %s", fileName.ToRawString());
+        LogDebug("PATH TOKEN: %s", fileName.ToRawString());
 
         // We make a stack of vnodes mounted on this directory so that we can attempt to find the next
         // file from the most recently mounted vnode.
@@ -207,6 +214,13 @@ int VFS::FindFreeFileDescriptor(FileDescriptor*& fileDescriptor)
     return descriptorIndex;
 }
 
+// Devices that hand out records in order, and keep the reader's place in its file offset
+bool IsStream(VFS::VnodeType type)
+{
+    return type == VFS::VnodeType::Keyboard || type == VFS::VnodeType::Kmsg || type == VFS::VnodeType::Trace ||
+           type == VFS::VnodeType::SystemCallTrace || type == VFS::VnodeType::Profile;
+}
+
 int VFS::Open(const String& path, int flags, Error& error)
 {
     FileDescriptor* fileDescriptor = nullptr;
@@ -257,15 +271,16 @@ int VFS::Open(const String& path, int flags, Error& error)
         fileDescriptor->flags().writeMode = false;
     }
 
-    if (fileDescriptor->flags().writeMode && (flags & OpenFlag::Truncate))
+    // Like on other systems, truncating anything but a regular file does nothing, so that "echo 1 > /dev/..." works
+    if (fileDescriptor->flags().writeMode && (flags & OpenFlag::Truncate) && vnode->type == VFS::VnodeType::RegularFile)
     {
-        Assert(vnode->type == VFS::VnodeType::RegularFile);
         vnode->fileSystem->Truncate(vnode);
     }
 
     fileDescriptor->flags().appendMode = flags & OpenFlag::Append;
     fileDescriptor->flags().directoryMode = flags & OpenFlag::DirectoryMode;
     fileDescriptor->flags().closeOnExecute = flags & OpenFlag::CloseOnExecute;
+    fileDescriptor->flags().nonBlocking = flags & OpenFlag::NonBlocking;
 
     if (fileDescriptor->flags().directoryMode && vnode->type != VnodeType::Directory)
     {
@@ -281,7 +296,15 @@ int VFS::Open(const String& path, int flags, Error& error)
 
     Assert(vnode->type != VnodeType::Unknown);
     fileDescriptor->vnode() = vnode;
+
+    // For stream devices, the offset is the reader's place in the stream
+    if (IsStream(vnode->type))
+    {
+        fileDescriptor->offset() = static_cast<Device*>(vnode->context)->GetStreamStart();
+    }
+
     fileDescriptor->present = true;
+    TracePoint(FileOpen, descriptorIndex, vnode->inodeNum);
     return descriptorIndex;
 }
 
@@ -312,6 +335,12 @@ uint64_t VFS::Read(int descriptor, void* buffer, uint64_t count, Error& error)
 
     VFS::Vnode* vnode = fileDescriptor->vnode();
 
+    if (IsStream(vnode->type))
+    {
+        auto device = static_cast<Device*>(vnode->context);
+        return device->ReadStream(buffer, count, fileDescriptor->offset(), fileDescriptor->flags().nonBlocking, error);
+    }
+
     uint64_t readCount = 0;
 
     if (!fileDescriptor->flags().directoryMode)
@@ -322,7 +351,9 @@ uint64_t VFS::Read(int descriptor, void* buffer, uint64_t count, Error& error)
             return -1;
         }
 
+        uint64_t traceStart = TraceBegin(FileRead);
         readCount = vnode->fileSystem->Read(vnode, buffer, count, fileDescriptor->offset());
+        TraceEnd(FileRead, traceStart, vnode->inodeNum, readCount);
     }
     else
     {
@@ -341,7 +372,8 @@ uint64_t VFS::Read(int descriptor, void* buffer, uint64_t count, Error& error)
         }
     }
 
-    if (vnode->type == VnodeType::RegularFile || vnode->type == VnodeType::Directory)
+    if (vnode->type == VnodeType::RegularFile || vnode->type == VnodeType::Directory ||
+        vnode->type == VnodeType::GeneratedFile)
     {
         fileDescriptor->offset() += readCount;
     }
@@ -374,6 +406,12 @@ uint64_t VFS::Write(int descriptor, const void* buffer, uint64_t count, Error& e
         return 0;
     }
 
+    if (vnode->type == VnodeType::Trace || vnode->type == VnodeType::SystemCallTrace)
+    {
+        error = Error::InvalidArgument;
+        return 0;
+    }
+
     if (fileDescriptor->flags().appendMode)
     {
         fileDescriptor->offset() = fileDescriptor->vnode()->fileSize;
@@ -391,7 +429,9 @@ uint64_t VFS::Write(int descriptor, const void* buffer, uint64_t count, Error& e
         Assert(vnode->fileSize == fileDescriptor->offset());
     }
 
+    uint64_t traceStart = TraceBegin(FileWrite);
     uint64_t wroteCount = vnode->fileSystem->Write(vnode, buffer, count, fileDescriptor->offset());
+    TraceEnd(FileWrite, traceStart, vnode->inodeNum, wroteCount);
 
     if (vnode->type == VnodeType::RegularFile)
     {
@@ -412,7 +452,8 @@ uint64_t VFS::RepositionOffset(int descriptor, int64_t offset, VFS::SeekType see
 
     VFS::Vnode* vnode = fileDescriptor->vnode();
 
-    if (vnode->type == VFS::VnodeType::Terminal)
+    // Like pipes, stream devices and the terminal have no place to seek to
+    if (vnode->type == VFS::VnodeType::Terminal || IsStream(vnode->type))
     {
         error = Error::IsPipe;
         return -1;
@@ -437,6 +478,32 @@ uint64_t VFS::RepositionOffset(int descriptor, int64_t offset, VFS::SeekType see
     return fileDescriptor->offset();
 }
 
+uint64_t VFS::Control(int descriptor, uint64_t request, void* argument, Error& error)
+{
+    FileDescriptor* fileDescriptor = GetFileDescriptor(descriptor);
+    if (fileDescriptor == nullptr)
+    {
+        error = Error::InvalidFileDescriptor;
+        return 0;
+    }
+
+    Vnode* vnode = fileDescriptor->vnode();
+    return vnode->fileSystem->Control(vnode, request, argument, error);
+}
+
+void* VFS::Map(int descriptor, void* addr, uint64_t length, Error& error)
+{
+    FileDescriptor* fileDescriptor = GetFileDescriptor(descriptor);
+    if (fileDescriptor == nullptr)
+    {
+        error = Error::InvalidFileDescriptor;
+        return nullptr;
+    }
+
+    Vnode* vnode = fileDescriptor->vnode();
+    return vnode->fileSystem->Map(vnode, addr, length, error);
+}
+
 void VFS::SetTerminalSettings(int descriptor, bool canonical, bool echo, Error& error)
 {
     auto terminal = GetTerminal(descriptor, error);
@@ -447,8 +514,20 @@ void VFS::SetTerminalSettings(int descriptor, bool canonical, bool echo, Error&
     }
 
     Assert(terminal != nullptr);
-    terminal->canonical = canonical;
-    terminal->echo = echo;
+    terminal->SetMode(canonical, echo);
+}
+
+void VFS::SetTerminalReadPolicy(int descriptor, uint8_t minimumCount, uint8_t timeout, Error& error)
+{
+    auto terminal = GetTerminal(descriptor, error);
+    if (error != Error::None)
+    {
+        Assert(terminal == nullptr);
+        return;
+    }
+
+    Assert(terminal != nullptr);
+    terminal->SetReadPolicy(minimumCount, timeout);
 }
 
 WindowSize VFS::GetTerminalWindowSize(int descriptor, Error& error)
@@ -525,7 +604,8 @@ VFS::VnodeInfo VFS::GetVnodeInfo(int descriptor, Error& error)
     }
 
     Vnode* vnode = fileDescriptor->vnode();
-    return {vnode->type, vnode->inodeNum, vnode->fileSize};
+    VnodeType type = vnode->type == VnodeType::GeneratedFile ? VnodeType::RegularFile : vnode->type;
+    return {type, vnode->inodeNum, vnode->fileSize};
 }
 
 VFS::VnodeInfo VFS::GetVnodeInfo(int descriptor)
@@ -0,0 +1,98 @@
+#include "WorkQueue.h"
+#include "Scheduler.h"
+#include "CPU.h"
+#include "Heap.h"
+#include "Serial.h"
+
+constexpr uint64_t WORK_QUEUE_SIZE = 256;
+
+WorkQueue* WorkQueue::unbound;
+Spinlock unboundLock {LockClass::WorkQueue};
+
+void WorkQueue::Queue(Function function, uint64_t argument)
+{
+    lock.Acquire();
+
+    // Work is mostly queued from interrupt handlers, which can't run it themselves or wait for room
+    if (writeIndex - readIndex == WORK_QUEUE_SIZE)
+    {
+        uint64_t count = ++droppedCount;
+        lock.Release();
+
+        // Logged at powers of two, so that a flood of work doesn't also flood the log
+        if ((count & (count - 1)) == 0)
+        {
+            Serial::Log(LogLevel::Warning, "Work queue is full, %lu work items dropped", count);
+        }
+        return;
+    }
+
+    items[writeIndex++ % WORK_QUEUE_SIZE] = {function, argument};
+
+    if (!waitingWorkers.IsEmpty())
+    {
+        WaitingWorker worker = waitingWorkers.Pop();
+        Scheduler::Unsuspend(worker.pid, worker.suspensionId, 0);
+    }
+
+    lock.Release();
+}
+
+void WorkQueue::QueueLocal(Function function, uint64_t argument)
+{
+    CPU::GetStruct().workQueue->Queue(function, argument);
+}
+
+// The unbound pool's workers are only started by the first work queued to it
+void WorkQueue::QueueUnbound(Function function, uint64_t argument)
+{
+    unboundLock.Acquire();
+    if (unbound == nullptr)
+    {
+        unbound = new (Allocator::Permanent) WorkQueue(CPU::GetCoreCount(), -1);
+    }
+    unboundLock.Release();
+
+    unbound->Queue(function, argument);
+}
+
+void WorkQueue::RunWorker(void* workQueuePtr)
+{
+    auto workQueue = static_cast<WorkQueue*>(workQueuePtr);
+
+    while (true)
+    {
+        // Interrupts stay disabled from here until the worker is switched out,
+        // so it can't be preempted between registering as waiting and blocking
+        asm volatile("cli" : : : "memory");
+        workQueue->lock.Acquire();
+
+        while (workQueue->readIndex == workQueue->writeIndex)
+        {
+            Scheduler* scheduler = Scheduler::GetScheduler();
+            workQueue->waitingWorkers.Push({scheduler->currentTask.pid, scheduler->currentTask.suspensionId});
+            workQueue->lock.Release();
+
+            scheduler->SuspendSystemCall(TaskState::Blocked);
+
+            workQueue->lock.Acquire();
+        }
+
+        Item item = workQueue->items[workQueue->readIndex++ % WORK_QUEUE_SIZE];
+
+        workQueue->lock.Release();
+        asm volatile("sti" : : : "memory");
+
+        item.function(item.argument);
+    }
+}
+
+WorkQueue::WorkQueue(uint64_t workerCount, int64_t pinnedCore)
+{
+    items = new (Allocator::Permanent) Item[WORK_QUEUE_SIZE];
+
+    for (uint64_t i = 0; i < workerCount; ++i)
+    {
+        Scheduler::CreateKernelThread(RunWorker, this, pinnedCore);
+    }
+}
@@ -0,0 +1,141 @@
+#!/bin/bash
+# Self-hosted build benchmark: builds the wordfreq sources in src/ with the in-guest gcc, one phase at a time for
+# all files, and reports how long each phase took and what the build cost the kernel. Output lines are
+#     build <phase> files=<n> ms=<t>
+#     build total ms=<t>
+#     build counter <name>=<delta>
+#     build syscall <type>=<delta>
+# where the counters are the differences of /proc/stat, /proc/interrupts, /proc/meminfo and /proc/syscalls
+# between the start and the end of the build.
+#
+# Usage: bash /root/buildbench/run.sh [--kmsg] [directory]
+# The kernel has no shebang support, so run it through bash. Everything is built in a new directory under the
+# given one (/root by default), files can't be removed yet. --kmsg also writes the results to /dev/kmsg.
+# CC and CFLAGS choose the compiler and its flags, gcc and -O2 by default.
+
+SOURCE_DIRECTORY=$(dirname "$0")/src
+CC=${CC:-gcc}
+CFLAGS=${CFLAGS:--O2}
+
+kmsg=0
+base=/root
+for argument in "$@"; do
+    case $argument in
+        --kmsg) kmsg=1 ;;
+        *) base=$argument ;;
+    esac
+done
+
+Output()
+{
+    echo "$1"
+    if [ $kmsg = 1 ]; then echo "$1" > /dev/kmsg; fi
+}
+
+# Microseconds from $EPOCHREALTIME, whose resolution is that of the kernel's clock, a millisecond
+Now()
+{
+    local time=${EPOCHREALTIME/[.,]/}
+    echo $((10#$time))
+}
+
+# Fills the associative array named by $1 with the kernel's counters
+Snapshot()
+{
+    local -n counters=$1
+    local name value rest
+
+    while read -r name value rest; do
+        case $name in
+            ctxt) counters[context_switches]=$value ;;
+            processes) counters[processes]=$value ;;
+            intr) counters[interrupts]=$value ;;
+        esac
+    done < /proc/stat
+
+    while read -r name value rest; do
+        if [ "$name" = MemFree: ]; then counters[memory_free_kb]=$value; fi
+    done < /proc/meminfo
+
+    # Page faults are fatal and mmap maps eagerly, so this stays 0 until the kernel pages on demand
+    counters[page_faults]=0
+    local vector count
+    while read -r vector rest; do
+        if [ "$vector" != 14: ]; then continue; fi
+        for count in $rest; do
+            if [[ $count != +([0-9]) ]]; then break; fi
+            counters[page_faults]=$((counters[page_faults] + count))
+        done
+    done < /proc/interrupts
+
+    while read -r name value rest; do
+        if [[ $name == *: ]]; then counters[syscall_${name%:}]=$value; fi
+    done < /proc/syscalls
+}
+
+# Runs "$@" for every source file, with {} replaced by the file's name without its extension
+Phase()
+{
+    local phase=$1
+    shift
+
+    local start=$(Now)
+    local file
+    for file in "${sources[@]}"; do
+        if ! "${@//\{\}/$file}"; then
+            Output "build $phase failed"
+            exit 1
+        fi
+    done
+    local end=$(Now)
+
+    Output "build $phase files=${#sources[@]} ms=$(((end - start) / 1000))"
+}
+
+shopt -s extglob
+
+directory=$base/buildbench-$$
+if ! mkdir "$directory"; then
+    Output "build setup failed"
+    exit 1
+fi
+export TMPDIR=$directory
+
+sources=()
+for path in "$SOURCE_DIRECTORY"/*.c; do
+    name=${path##*/}
+    sources+=("${name%.c}")
+done
+
+declare -A before after
+Snapshot before
+start=$(Now)
+
+Phase preprocess "$CC" $CFLAGS -E "$SOURCE_DIRECTORY/{}.c" -o "$directory/{}.i"
+Phase compile "$CC" $CFLAGS -S "$directory/{}.i" -o "$directory/{}.s"
+Phase assemble "$CC" -c "$directory/{}.s" -o "$directory/{}.o"
+
+linkStart=$(Now)
+if ! "$CC" "$directory"/*.o -o "$directory/wordfreq"; then
+    Output "build link failed"
+    exit 1
+fi
+end=$(Now)
+Output "build link files=${#sources[@]} ms=$(((end - linkStart) / 1000))"
+Output "build total ms=$(((end - start) / 1000))"
+
+Snapshot after
+
+# Page frames are never freed, so the memory that the build's processes used is still gone afterwards
+Output "build counter memory_used_kb=$((before[memory_free_kb] - after[memory_free_kb]))"
+for name in context_switches processes interrupts page_faults; do
+    Output "build counter $name=$((after[$name] - before[$name]))"
+done
+
+for name in "${!after[@]}"; do
+    if [[ $name != syscall_* ]]; then continue; fi
+    delta=$((after[$name] - ${before[$name]:-0}))
+    if [ $delta != 0 ]; then Output "build syscall ${name#syscall_}=$delta"; fi
+done
+
+Output "build done"
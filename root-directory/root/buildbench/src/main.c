@@ -0,0 +1,82 @@
+// wordfreq, the program that buildbench compiles. Counts the words in files or standard input.
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "table.h"
+#include "words.h"
+#include "sort.h"
+#include "report.h"
+
+#define INITIAL_BUCKET_COUNT 256
+#define DEFAULT_LIMIT 20
+
+static void Usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-a] [-n count] [file...]\n"
+                    "  -a  sort alphabetically instead of by count\n"
+                    "  -n  print the first count words, %d by default\n", name, DEFAULT_LIMIT);
+}
+
+int main(int argc, char** argv)
+{
+    enum SortOrder order = SORT_BY_COUNT;
+    size_t limit = DEFAULT_LIMIT;
+    int first = 1;
+
+    for (; first < argc && argv[first][0] == '-' && argv[first][1] != '\0'; ++first)
+    {
+        if (strcmp(argv[first], "-a") == 0) order = SORT_BY_WORD;
+        else if (strcmp(argv[first], "-n") == 0 && first + 1 < argc) limit = strtoul(argv[++first], NULL, 10);
+        else
+        {
+            Usage(argv[0]);
+            return 2;
+        }
+    }
+
+    struct Table table;
+    if (TableInitialize(&table, INITIAL_BUCKET_COUNT) < 0)
+    {
+        perror("wordfreq");
+        return 1;
+    }
+
+    struct WordStatistics statistics = {0};
+    int status = 0;
+    if (first == argc && CountWords(stdin, &table, &statistics) < 0) status = 1;
+
+    for (int i = first; i < argc; ++i)
+    {
+        FILE* file = fopen(argv[i], "r");
+        if (file == NULL)
+        {
+            fprintf(stderr, "wordfreq: %s: %s\n", argv[i], strerror(errno));
+            status = 1;
+            continue;
+        }
+        if (CountWords(file, &table, &statistics) < 0)
+        {
+            fprintf(stderr, "wordfreq: %s: read failed\n", argv[i]);
+            status = 1;
+        }
+        fclose(file);
+    }
+
+    struct Entry** entries = TableCollect(&table);
+    if (entries == NULL)
+    {
+        perror("wordfreq");
+        return 1;
+    }
+    if (SortEntries(entries, table.entryCount, order) < 0)
+    {
+        perror("wordfreq");
+        status = 1;
+    }
+    PrintReport(stdout, entries, table.entryCount, limit, &statistics);
+
+    free(entries);
+    TableFree(&table);
+    return status;
+}
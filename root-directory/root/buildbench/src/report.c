@@ -0,0 +1,30 @@
+#include "report.h"
+
+#define BAR_WIDTH 40
+
+void PrintReport(FILE* output, struct Entry** entries, size_t count, size_t limit,
+                 const struct WordStatistics* statistics)
+{
+    fprintf(output, "%lu lines, %lu words, %lu characters, %zu distinct words\n",
+            statistics->lineCount, statistics->wordCount, statistics->characterCount, count);
+    if (count == 0) return;
+
+    if (limit > count) limit = count;
+    unsigned long highest = 1;
+    for (size_t i = 0; i < limit; ++i)
+    {
+        if (entries[i]->count > highest) highest = entries[i]->count;
+    }
+    int wordWidth = (int)statistics->longestWord;
+
+    for (size_t i = 0; i < limit; ++i)
+    {
+        const struct Entry* entry = entries[i];
+        int barLength = (int)(entry->count * BAR_WIDTH / highest);
+        double share = statistics->wordCount ? 100.0 * entry->count / statistics->wordCount : 0;
+
+        fprintf(output, "%-*s %8lu %6.2f%% ", wordWidth, entry->word, entry->count, share);
+        for (int j = 0; j < barLength; ++j) fputc('#', output);
+        fputc('\n', output);
+    }
+}
@@ -0,0 +1,11 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <stdio.h>
+#include "table.h"
+#include "words.h"
+
+void PrintReport(FILE* output, struct Entry** entries, size_t count, size_t limit,
+                 const struct WordStatistics* statistics);
+
+#endif
@@ -0,0 +1,41 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sort.h"
+
+static int Compare(const struct Entry* a, const struct Entry* b, enum SortOrder order)
+{
+    if (order == SORT_BY_COUNT && a->count != b->count) return a->count > b->count ? -1 : 1;
+    return strcmp(a->word, b->word);
+}
+
+// Merge sort, so that words with the same count keep a stable order
+static void Merge(struct Entry** entries, struct Entry** scratch, size_t count, enum SortOrder order)
+{
+    if (count < 2) return;
+
+    size_t middle = count / 2;
+    Merge(entries, scratch, middle, order);
+    Merge(entries + middle, scratch, count - middle, order);
+
+    size_t left = 0, right = middle, index = 0;
+    while (left < middle && right < count)
+    {
+        if (Compare(entries[right], entries[left], order) < 0) scratch[index++] = entries[right++];
+        else scratch[index++] = entries[left++];
+    }
+    while (left < middle) scratch[index++] = entries[left++];
+    while (right < count) scratch[index++] = entries[right++];
+
+    memcpy(entries, scratch, count * sizeof(struct Entry*));
+}
+
+// Leaves the entries as they are if there is no memory for the scratch array
+int SortEntries(struct Entry** entries, size_t count, enum SortOrder order)
+{
+    struct Entry** scratch = malloc((count + 1) * sizeof(struct Entry*));
+    if (scratch == NULL) return -1;
+
+    Merge(entries, scratch, count, order);
+    free(scratch);
+    return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <stddef.h>
+#include "table.h"
+
+enum SortOrder
+{
+    SORT_BY_COUNT,
+    SORT_BY_WORD
+};
+
+int SortEntries(struct Entry** entries, size_t count, enum SortOrder order);
+
+#endif
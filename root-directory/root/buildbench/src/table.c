@@ -0,0 +1,111 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "table.h"
+
+// FNV-1a
+static uint64_t Hash(const char* word, size_t length)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= (unsigned char)word[i];
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+int TableInitialize(struct Table* table, size_t bucketCount)
+{
+    table->buckets = calloc(bucketCount, sizeof(struct Entry*));
+    if (table->buckets == NULL) return -1;
+
+    table->bucketCount = bucketCount;
+    table->entryCount = 0;
+    return 0;
+}
+
+void TableFree(struct Table* table)
+{
+    for (size_t i = 0; i < table->bucketCount; ++i)
+    {
+        struct Entry* entry = table->buckets[i];
+        while (entry != NULL)
+        {
+            struct Entry* next = entry->next;
+            free(entry->word);
+            free(entry);
+            entry = next;
+        }
+    }
+    free(table->buckets);
+}
+
+static int Grow(struct Table* table)
+{
+    size_t bucketCount = table->bucketCount * 2;
+    struct Entry** buckets = calloc(bucketCount, sizeof(struct Entry*));
+    if (buckets == NULL) return -1;
+
+    for (size_t i = 0; i < table->bucketCount; ++i)
+    {
+        struct Entry* entry = table->buckets[i];
+        while (entry != NULL)
+        {
+            struct Entry* next = entry->next;
+            size_t bucket = Hash(entry->word, strlen(entry->word)) % bucketCount;
+            entry->next = buckets[bucket];
+            buckets[bucket] = entry;
+            entry = next;
+        }
+    }
+
+    free(table->buckets);
+    table->buckets = buckets;
+    table->bucketCount = bucketCount;
+    return 0;
+}
+
+int TableAdd(struct Table* table, const char* word, size_t length)
+{
+    size_t bucket = Hash(word, length) % table->bucketCount;
+    for (struct Entry* entry = table->buckets[bucket]; entry != NULL; entry = entry->next)
+    {
+        if (strncmp(entry->word, word, length) == 0 && entry->word[length] == '\0')
+        {
+            entry->count++;
+            return 0;
+        }
+    }
+
+    struct Entry* entry = malloc(sizeof(struct Entry));
+    if (entry == NULL) return -1;
+    entry->word = malloc(length + 1);
+    if (entry->word == NULL)
+    {
+        free(entry);
+        return -1;
+    }
+    memcpy(entry->word, word, length);
+    entry->word[length] = '\0';
+    entry->count = 1;
+    entry->next = table->buckets[bucket];
+    table->buckets[bucket] = entry;
+
+    if (++table->entryCount > table->bucketCount * 2) return Grow(table);
+    return 0;
+}
+
+// The entries in no particular order, the array is the caller's to free
+struct Entry** TableCollect(const struct Table* table)
+{
+    struct Entry** entries = malloc((table->entryCount + 1) * sizeof(struct Entry*));
+    if (entries == NULL) return NULL;
+
+    size_t index = 0;
+    for (size_t i = 0; i < table->bucketCount; ++i)
+    {
+        for (struct Entry* entry = table->buckets[i]; entry != NULL; entry = entry->next) entries[index++] = entry;
+    }
+    return entries;
+}
@@ -0,0 +1,25 @@
+#ifndef TABLE_H
+#define TABLE_H
+
+#include <stddef.h>
+
+struct Entry
+{
+    char* word;
+    unsigned long count;
+    struct Entry* next;
+};
+
+struct Table
+{
+    struct Entry** buckets;
+    size_t bucketCount;
+    size_t entryCount;
+};
+
+int TableInitialize(struct Table* table, size_t bucketCount);
+void TableFree(struct Table* table);
+int TableAdd(struct Table* table, const char* word, size_t length);
+struct Entry** TableCollect(const struct Table* table);
+
+#endif
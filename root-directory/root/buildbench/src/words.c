@@ -0,0 +1,38 @@
+#include <ctype.h>
+#include "words.h"
+
+#define WORD_SIZE 64
+
+// Words are runs of letters, digits and apostrophes, folded to lower case. Longer ones are cut.
+int CountWords(FILE* file, struct Table* table, struct WordStatistics* statistics)
+{
+    char word[WORD_SIZE];
+    size_t length = 0;
+    int c;
+
+    while ((c = fgetc(file)) != EOF)
+    {
+        statistics->characterCount++;
+        if (c == '\n') statistics->lineCount++;
+
+        if (isalnum(c) || c == '\'')
+        {
+            if (length < WORD_SIZE) word[length++] = (char)tolower(c);
+            continue;
+        }
+
+        if (length == 0) continue;
+        if (TableAdd(table, word, length) < 0) return -1;
+        statistics->wordCount++;
+        if (length > statistics->longestWord) statistics->longestWord = length;
+        length = 0;
+    }
+
+    if (length > 0)
+    {
+        if (TableAdd(table, word, length) < 0) return -1;
+        statistics->wordCount++;
+        if (length > statistics->longestWord) statistics->longestWord = length;
+    }
+    return ferror(file) ? -1 : 0;
+}
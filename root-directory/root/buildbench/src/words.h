@@ -0,0 +1,17 @@
+#ifndef WORDS_H
+#define WORDS_H
+
+#include <stdio.h>
+#include "table.h"
+
+struct WordStatistics
+{
+    unsigned long lineCount;
+    unsigned long wordCount;
+    unsigned long characterCount;
+    size_t longestWord;
+};
+
+int CountWords(FILE* file, struct Table* table, struct WordStatistics* statistics);
+
+#endif
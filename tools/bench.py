@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""Runs the benchmark image and compares results against a stored baseline.
+
+"run" starts QEMU (everything after "--" is the command line), collects the "bench" lines that
+bench/bench.c writes to /dev/kmsg and that come out of the debug port, and stops QEMU at "bench done".
+"compare" prints the change of every benchmark against a baseline and fails on regressions.
+
+Results are text files with one benchmark per line:
+    bench <name> iterations=<n> cycles_per_op=<c>
+plus a "tsc <frequency in Hz>" line, so cycles can also be shown as time.
+
+The kernel logs how long every phase of boot took, those are kept as benchmarks named boot_<phase>, with the core
+appended for the phases of the APs, and a single iteration, so that boot regressions are caught the same way.
+"""
+import argparse
+import contextlib
+import re
+import subprocess
+import sys
+import threading
+
+BENCH_LINE = re.compile(r"bench (\S+) iterations=(\d+) cycles_per_op=(\d+)")
+FAILED_LINE = re.compile(r"bench (\S+) failed")
+TEST_FAILED_LINE = re.compile(r"test (\S+ \S+) failed: .*")
+TSC_LINE = re.compile(r"TSC frequency: (\d+) Hz")
+BOOT_LINE = re.compile(r"boot +(\S+) +core= *(\d+) +start_us= *\d+ +us= *\d+ +cycles=(\d+)")
+SLOWEST_BOOT_LINE = re.compile(r"Slowest boot phase: .*")
+
+
+def debug_port_lines(command, timeout, verbose, log=None):
+    """Runs QEMU and yields its output line by line, also writing it to the log file if there is one.
+    QEMU is killed after timeout seconds, or when the generator is closed."""
+    process = subprocess.Popen(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                               stdin=subprocess.DEVNULL, text=True, errors="replace")
+    timer = threading.Timer(timeout, process.kill)
+    timer.start()
+    try:
+        for line in process.stdout:
+            if verbose:
+                sys.stdout.write(line)
+            if log is not None:
+                log.write(line)
+            yield line
+    finally:
+        timer.cancel()
+        process.kill()
+        process.wait()
+
+
+def run(arguments):
+    results = []
+    failures = []
+    frequency = None
+    finished = False
+    log = open(arguments.log, "w") if arguments.log else None
+    lines = debug_port_lines(arguments.command, arguments.timeout, arguments.verbose, log)
+    with contextlib.closing(lines):
+        for line in lines:
+            match = TSC_LINE.search(line)
+            if match and frequency is None:
+                frequency = int(match.group(1))
+            match = BOOT_LINE.search(line)
+            if match:
+                phase, core, cycles = match.groups()
+                name = "boot_" + phase if core == "0" else "boot_%s_core%s" % (phase, core)
+                results.append("bench %s iterations=1 cycles_per_op=%s" % (name, cycles))
+            match = SLOWEST_BOOT_LINE.search(line)
+            if match and not arguments.verbose:
+                print(match.group(0))
+            match = BENCH_LINE.search(line)
+            if match:
+                results.append(match.group(0))
+                if not arguments.verbose:
+                    print(match.group(0))
+            match = FAILED_LINE.search(line) or TEST_FAILED_LINE.search(line)
+            if match:
+                failures.append(match.group(1))
+                print(match.group(0))
+            if "bench done" in line:
+                finished = True
+                break
+    if log is not None:
+        log.close()
+
+    if not finished:
+        print("QEMU stopped before the benchmarks finished", file=sys.stderr)
+        return 1
+
+    with open(arguments.output, "w") as output:
+        if frequency is not None:
+            output.write("tsc %d\n" % frequency)
+        for result in results:
+            output.write(result + "\n")
+
+    return 1 if failures else 0
+
+
+def load(path):
+    frequency = None
+    results = {}
+    with open(path) as results_file:
+        for line in results_file:
+            if line.startswith("tsc "):
+                frequency = int(line.split()[1])
+                continue
+            match = BENCH_LINE.match(line)
+            if match:
+                results[match.group(1)] = int(match.group(3))
+    return frequency, results
+
+
+def format_cycles(cycles, frequency):
+    if frequency is None:
+        return "%d" % cycles
+    return "%d (%.2f us)" % (cycles, cycles * 1e6 / frequency)
+
+
+def compare(arguments):
+    baseline_frequency, baseline = load(arguments.baseline)
+    frequency, results = load(arguments.results)
+
+    regressions = []
+    print("%-20s %24s %24s %9s" % ("benchmark", "baseline cycles/op", "cycles/op", "change"))
+    for name in sorted(set(baseline) | set(results)):
+        if name not in results or name not in baseline:
+            where = "results" if name not in results else "baseline"
+            print("%-20s missing from %s" % (name, where))
+            continue
+
+        change = (results[name] - baseline[name]) * 100.0 / max(baseline[name], 1)
+        marker = ""
+        if change > arguments.threshold:
+            regressions.append(name)
+            marker = "  regression"
+        print("%-20s %24s %24s %+8.1f%%%s" % (name, format_cycles(baseline[name], baseline_frequency),
+                                              format_cycles(results[name], frequency), change, marker))
+
+    if regressions:
+        print("%d benchmark(s) regressed by more than %.0f%%" % (len(regressions), arguments.threshold))
+        return 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    subparsers = parser.add_subparsers(dest="action", required=True)
+
+    run_parser = subparsers.add_parser("run", help="boot the benchmark image and collect results")
+    run_parser.add_argument("--output", required=True, help="results file to write")
+    run_parser.add_argument("--timeout", type=float, default=600, help="seconds before QEMU is killed")
+    run_parser.add_argument("--verbose", action="store_true", help="echo the whole debug port output")
+    run_parser.add_argument("--log", help="also write the whole debug port output to this file")
+    run_parser.add_argument("command", nargs=argparse.REMAINDER, help="QEMU command line, after --")
+
+    compare_parser = subparsers.add_parser("compare", help="compare results against a baseline")
+    compare_parser.add_argument("baseline")
+    compare_parser.add_argument("results")
+    compare_parser.add_argument("--threshold", type=float, default=10,
+                                help="percentage slowdown that counts as a regression")
+
+    arguments = parser.parse_args()
+    if arguments.action == "run":
+        if arguments.command[:1] == ["--"]:
+            arguments.command = arguments.command[1:]
+        if not arguments.command:
+            parser.error("run needs a QEMU command line after --")
+        return run(arguments)
+    return compare(arguments)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
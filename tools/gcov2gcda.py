@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Turns the arc counters that a PGO=generate kernel dumps to the debug port into .gcda files.
+
+The kernel has no libgcov to write .gcda files, instead writing to /dev/gcov dumps every object file's counters
+as "gcov-..." lines (see kernel/src/Gcov.cpp), which bench/bench.c does before "bench done". This reads a log of
+the debug port, takes the last complete dump in it and writes one .gcda file per object file, in the format of
+GCC 12, to the path the compiler recorded for it. That is next to the object, where PGO=use looks for it.
+"""
+import argparse
+import os
+import re
+import struct
+import sys
+
+GCOV_LINE = re.compile(r"gcov-(file|function|counters|values|done)\b ?(.*)")
+
+GCOV_DATA_MAGIC = 0x67636461
+GCOV_TAG_FUNCTION = 0x01000000
+GCOV_TAG_COUNTER_BASE = 0x01a10000
+GCOV_TAG_OBJECT_SUMMARY = 0xa1000000
+GCOV_COUNTER_ARCS = 0
+
+
+class ObjectFile:
+    def __init__(self, version, stamp, checksum, filename):
+        self.version = version
+        self.stamp = stamp
+        self.checksum = checksum
+        self.filename = filename
+        self.functions = []
+
+
+def parse(lines):
+    """Returns the object files of the last dump that got to "gcov-done"."""
+    dump = None
+    objects = None
+    counters = None
+
+    for line in lines:
+        match = GCOV_LINE.search(line)
+        if not match:
+            continue
+        kind, rest = match.group(1), match.group(2).strip()
+
+        if kind == "done":
+            if objects is not None:
+                dump = objects
+            objects = None
+        elif kind == "file":
+            if objects is None:
+                objects = []
+            version, stamp, checksum, filename = rest.split(" ", 3)
+            objects.append(ObjectFile(int(version, 16), int(stamp, 16), int(checksum, 16), filename))
+        elif objects is None:
+            continue
+        elif kind == "function":
+            ident, lineno_checksum, cfg_checksum = (int(field, 16) for field in rest.split())
+            objects[-1].functions.append((ident, lineno_checksum, cfg_checksum, []))
+        elif kind == "counters":
+            counter_kind, count = (int(field, 16) for field in rest.split())
+            counters = (counter_kind, count, [])
+            objects[-1].functions[-1][3].append(counters)
+        elif kind == "values":
+            counters[2].extend(int(field, 16) for field in rest.split())
+
+    return dump
+
+
+def words(*values):
+    return struct.pack("<%dI" % len(values), *(value & 0xffffffff for value in values))
+
+
+def gcda(object_file, sum_max):
+    """Lays the counters out like libgcov's write_one_data, lengths are in bytes since GCC 12."""
+    data = bytearray(words(GCOV_DATA_MAGIC, object_file.version, object_file.stamp, object_file.checksum))
+    data += words(GCOV_TAG_OBJECT_SUMMARY, 8, 1, sum_max)
+
+    for ident, lineno_checksum, cfg_checksum, counters in object_file.functions:
+        data += words(GCOV_TAG_FUNCTION, 12, ident, lineno_checksum, cfg_checksum)
+        for counter_kind, count, values in counters:
+            if len(values) != count:
+                raise ValueError("%s: function %x has %d of %d counters" %
+                                 (object_file.filename, ident, len(values), count))
+
+            tag = GCOV_TAG_COUNTER_BASE + (counter_kind << 17)
+            # Counters that are all zero only get their negated length
+            if not any(values):
+                data += words(tag, -count * 8)
+                continue
+            data += words(tag, count * 8)
+            for value in values:
+                data += words(value, value >> 32)
+
+    return bytes(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", help="debug port output with a dump from /dev/gcov")
+    arguments = parser.parse_args()
+
+    with open(arguments.log, errors="replace") as log:
+        objects = parse(log)
+    if not objects:
+        print("No complete gcov dump in %s, was the kernel built with PGO=generate?" % arguments.log,
+              file=sys.stderr)
+        return 1
+
+    # The summary holds the largest arc count in the whole program, which GCC scales its hotness thresholds to
+    sum_max = 0
+    for object_file in objects:
+        for function in object_file.functions:
+            for counter_kind, _, values in function[3]:
+                if counter_kind == GCOV_COUNTER_ARCS and values:
+                    sum_max = max(sum_max, max(values))
+
+    for object_file in objects:
+        os.makedirs(os.path.dirname(object_file.filename) or ".", exist_ok=True)
+        with open(object_file.filename, "wb") as output:
+            output.write(gcda(object_file, sum_max))
+
+    print("Wrote %d .gcda files, the hottest arc ran %d times" % (len(objects), sum_max))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Symbolizes kernel profiler samples and writes folded stacks, the input of flamegraph.pl and speedscope.
+
+Input is either a debug port log that contains the lines streamed after "echo 100 > /dev/profile",
+or the binary samples read from /dev/profile.
+
+Kernel addresses are looked up in kernel/bin/kernel.elf. User addresses are looked up in the ELFs given with
+--elf, each optionally followed by @ and the hexadecimal address it was loaded at, for shared objects and
+position-independent executables. Only code built with frame pointers has a full call stack.
+"""
+import argparse
+import bisect
+import os
+import struct
+import subprocess
+import sys
+from collections import Counter
+
+KERNELSPACE_START = 0xffff800000000000
+STACK_DEPTH = 16
+SAMPLE = struct.Struct("<QQQII%dQ" % STACK_DEPTH)
+
+
+class SymbolTable:
+    def __init__(self, path, base):
+        self.name = os.path.basename(path)
+        self.addresses = []
+        self.symbols = []
+
+        output = subprocess.run(["nm", "--defined-only", "--numeric-sort", "--print-size", "--demangle", path],
+                                capture_output=True, text=True, check=True).stdout
+        for line in output.splitlines():
+            fields = line.split(maxsplit=3)
+            if len(fields) == 4 and fields[2] in "tTwW":
+                self.addresses.append(base + int(fields[0], 16))
+                self.symbols.append((int(fields[1], 16), fields[3]))
+
+    def lookup(self, address):
+        i = bisect.bisect_right(self.addresses, address) - 1
+        if i < 0:
+            return None
+        size, name = self.symbols[i]
+        if size != 0 and address >= self.addresses[i] + size:
+            return None
+        return name
+
+
+def read_text(lines):
+    frequency = 0
+    samples = []
+    for line in lines:
+        fields = line.split()
+        if len(fields) == 2 and fields[0] == "profile-tsc":
+            frequency = int(fields[1])
+        elif len(fields) >= 5 and fields[0] == "profile":
+            weight, pid, _, *stack = (int(field, 16) for field in fields[1:])
+            samples.append((weight, pid, stack))
+    return samples, frequency
+
+
+def read_binary(data):
+    samples = []
+    for offset in range(0, len(data) - SAMPLE.size + 1, SAMPLE.size):
+        _, weight, pid, _, depth, *stack = SAMPLE.unpack_from(data, offset)
+        samples.append((weight, pid, stack[:depth]))
+    return samples
+
+
+def symbolize(address, is_return_address, kernel, user_tables):
+    # A return address points after the call, which may already be the next function
+    lookup_address = address - 1 if is_return_address else address
+
+    tables = [kernel] if address >= KERNELSPACE_START else user_tables
+    for table in tables:
+        name = table.lookup(lookup_address)
+        if name is not None:
+            return name if table is kernel else "%s`%s" % (table.name, name)
+
+    return "[kernel]" if address >= KERNELSPACE_START else hex(address)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="debug port log, or binary /dev/profile contents")
+    parser.add_argument("--kernel", default="kernel/bin/kernel.elf", help="kernel ELF, kernel/bin/kernel.elf by default")
+    parser.add_argument("--elf", action="append", default=[], metavar="PATH[@BASE]", help="user ELF to symbolize against")
+    parser.add_argument("--samples", action="store_true",
+                        help="count samples instead of weighting them by the time they stand for, in microseconds")
+    arguments = parser.parse_args()
+
+    data = open(arguments.input, "rb").read()
+    if b"profile-tsc " in data or data.startswith(b"profile "):
+        samples, frequency = read_text(data.decode("utf-8", "replace").splitlines())
+    else:
+        samples, frequency = read_binary(data), 0
+
+    kernel = SymbolTable(arguments.kernel, 0)
+    user_tables = []
+    for elf in arguments.elf:
+        path, _, base = elf.partition("@")
+        user_tables.append(SymbolTable(path, int(base, 16) if base else 0))
+
+    stacks = Counter()
+    for weight, pid, stack in samples:
+        frames = [symbolize(address, i > 0, kernel, user_tables) for i, address in enumerate(stack)]
+        root = "idle" if pid == 0 else "pid %d" % pid
+        key = ";".join([root] + frames[::-1])
+
+        if arguments.samples or frequency == 0:
+            stacks[key] += 1
+        else:
+            stacks[key] += weight * 1000000 // frequency
+
+    for key, value in sorted(stacks.items()):
+        if value > 0:
+            print("%s %d" % (key, value))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""Measures how throughput scales with the number of cores.
+
+Boots the smpbench image once for every core count (everything after "--" is the QEMU command line,
+"-smp <n>" is appended to it), collects the per-worker lines that bench/smpbench.c writes to /dev/kmsg
+and prints throughput, speedup and efficiency for every workload. It also prints how long the BSP took
+to start the other cores, from the start_cores line of the kernel's boot table.
+
+Kernels built with -DLOCK_STATISTICS also report the lock classes each workload spun on. The first
+serializing lock is the one with the most spin cycles in the first workload, at the lowest core count,
+whose efficiency falls below the threshold.
+"""
+import argparse
+import contextlib
+import re
+import sys
+
+from bench import debug_port_lines, BOOT_LINE, TSC_LINE
+
+WORKER_LINE = re.compile(r"smp (\S+) start=(\d+) end=(\d+) ops=(\d+)")
+LOCK_LINE = re.compile(r"smp lockstat (\S+) (\S+) acquisitions=(\d+) contentions=(\d+) spin=(\d+)")
+
+
+def run(command, core_count, timeout, verbose):
+    """Returns {workload: operations per second}, {workload: [(spin cycles, lock class)]}
+    and the microseconds it took to start the cores."""
+    spans = {}
+    locks = {}
+    start_cores_cycles = None
+    frequency = None
+    finished = False
+
+    lines = debug_port_lines(command + ["-smp", str(core_count)], timeout, verbose)
+    with contextlib.closing(lines):
+        for line in lines:
+            match = TSC_LINE.search(line)
+            if match and frequency is None:
+                frequency = int(match.group(1))
+            match = BOOT_LINE.search(line)
+            if match and match.group(1) == "start_cores":
+                start_cores_cycles = int(match.group(3))
+            match = WORKER_LINE.search(line)
+            if match:
+                workload, start, end, operations = match.group(1), *map(int, match.groups()[1:])
+                first, last, total = spans.get(workload, (start, end, 0))
+                spans[workload] = (min(first, start), max(last, end), total + operations)
+            match = LOCK_LINE.search(line)
+            if match:
+                locks.setdefault(match.group(1), []).append((int(match.group(5)), match.group(2)))
+            if "smp done" in line:
+                finished = True
+                break
+
+    if not finished or frequency is None:
+        raise RuntimeError("QEMU with %d cores stopped before the workloads finished" % core_count)
+
+    throughput = {}
+    for workload, (first, last, total) in spans.items():
+        throughput[workload] = total * frequency / max(last - first, 1)
+    for workload_locks in locks.values():
+        workload_locks.sort(reverse=True)
+    start_cores_us = None if start_cores_cycles is None else start_cores_cycles * 1000000 // frequency
+    return throughput, locks, start_cores_us
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--cores", default="1,2,4,8", help="comma separated core counts to boot with")
+    parser.add_argument("--threshold", type=float, default=75, help="efficiency in percent below which a workload "
+                                                                    "counts as serialized")
+    parser.add_argument("--output", help="also write the results to this file, one line per workload and core count")
+    parser.add_argument("--timeout", type=float, default=900, help="seconds before each QEMU run is killed")
+    parser.add_argument("--verbose", action="store_true", help="echo the whole debug port output")
+    parser.add_argument("command", nargs=argparse.REMAINDER, help="QEMU command line, after --")
+    arguments = parser.parse_args()
+
+    if arguments.command[:1] == ["--"]:
+        arguments.command = arguments.command[1:]
+    if not arguments.command:
+        parser.error("needs a QEMU command line after --")
+
+    core_counts = [int(count) for count in arguments.cores.split(",")]
+    results = {}
+    for core_count in core_counts:
+        print("Running with %d core(s)..." % core_count, file=sys.stderr)
+        try:
+            results[core_count] = run(arguments.command, core_count, arguments.timeout, arguments.verbose)
+        except RuntimeError as error:
+            print(error, file=sys.stderr)
+            return 1
+
+    baseline_count = core_counts[0]
+    workloads = list(results[baseline_count][0])
+    serializing = None
+
+    print("%-10s %6s %16s %9s %11s  %s" % ("workload", "cores", "ops/s", "speedup", "efficiency", "most spun lock"))
+    for workload in workloads:
+        baseline = results[baseline_count][0][workload]
+        for core_count in core_counts:
+            throughput, locks, _ = results[core_count]
+            speedup = throughput.get(workload, 0) / baseline
+            efficiency = speedup * baseline_count / core_count * 100
+            top_lock = "-"
+            if locks.get(workload):
+                spin, lock_class = locks[workload][0]
+                top_lock = "%s (%d spin cycles)" % (lock_class, spin)
+            print("%-10s %6d %16.0f %8.2fx %10.0f%%  %s" % (workload, core_count, throughput.get(workload, 0),
+                                                          speedup, efficiency, top_lock))
+
+            if efficiency < arguments.threshold and locks.get(workload):
+                if serializing is None or core_count < serializing[0]:
+                    serializing = (core_count, workload, locks[workload][0][1], efficiency)
+
+    if serializing is not None:
+        print("First serializing lock: %s, in %s at %d cores (%.0f%% efficiency)" %
+              (serializing[2], serializing[1], serializing[0], serializing[3]))
+    elif not any(locks for _, locks, _ in results.values()):
+        print("No lock statistics, build the kernel with -DLOCK_STATISTICS to find the serializing lock")
+    else:
+        print("No workload fell below %.0f%% efficiency" % arguments.threshold)
+
+    # With the APs coming up in parallel, this should grow much slower than the core count
+    print("%-10s %6s %16s" % ("boot", "cores", "start_cores us"))
+    for core_count in core_counts:
+        start_cores_us = results[core_count][2]
+        print("%-10s %6d %16s" % ("boot", core_count, "-" if start_cores_us is None else start_cores_us))
+
+    if arguments.output:
+        with open(arguments.output, "w") as output:
+            for core_count in core_counts:
+                for workload, throughput in results[core_count][0].items():
+                    output.write("smp %s cores=%d ops_per_second=%.0f\n" % (workload, core_count, throughput))
+                if results[core_count][2] is not None:
+                    output.write("smp start_cores cores=%d us=%d\n" % (core_count, results[core_count][2]))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Converts kernel trace records to the Chrome trace event format, which chrome://tracing and Perfetto open.
+
+Input is either the binary records read from /dev/trace, or a debug port log that contains the text lines
+written by the DumpToDebugPort request (or by a kernel panic while tracing).
+"""
+import argparse
+import json
+import struct
+import sys
+
+# Same order as TraceEvent in kernel/include/Trace.h
+EVENT_NAMES = [
+    ("TaskSwitch", "scheduler", ("previousPid", "nextPid")),
+    ("TaskBlock", "scheduler", ("state", "timeoutMilliseconds")),
+    ("TaskWakeup", "scheduler", ("pid", "returnValue")),
+    ("PageMap", "memory", ("virtualAddress", "physicalAddress")),
+    ("AddressSpaceCopy", "memory", ("pml4", "originalPml4")),
+    ("PageFault", "memory", ("address", "rip")),
+    ("FileOpen", "vfs", ("descriptor", "inode")),
+    ("FileRead", "vfs", ("inode", "count")),
+    ("FileWrite", "vfs", ("inode", "count")),
+    ("Ext2Read", "ext2", ("block", "count")),
+    ("Ext2Write", "ext2", ("block", "count")),
+]
+
+RECORD = struct.Struct("<QQQQIHH")
+ADDRESS_ARGUMENTS = {"virtualAddress", "physicalAddress", "pml4", "originalPml4", "address", "rip"}
+
+
+def read_binary(data):
+    for offset in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        timestamp, duration, argument0, argument1, pid, event, core = RECORD.unpack_from(data, offset)
+        yield timestamp, duration, event, core, pid, argument0, argument1
+
+
+def read_text(lines, frequency):
+    records = []
+    for line in lines:
+        fields = line.split()
+        if len(fields) == 2 and fields[0] == "trace-tsc":
+            frequency = frequency or int(fields[1])
+        elif len(fields) == 8 and fields[0] == "trace":
+            records.append(tuple(int(field, 16) for field in fields[1:]))
+    return records, frequency
+
+
+def to_event(record, frequency, base):
+    timestamp, duration, event, core, pid, argument0, argument1 = record
+    name, category, argument_names = EVENT_NAMES[event] if event < len(EVENT_NAMES) else ("Event%d" % event, "unknown", ("a0", "a1"))
+
+    arguments = {"pid": pid}
+    for argument_name, value in zip(argument_names, (argument0, argument1)):
+        arguments[argument_name] = hex(value) if argument_name in ADDRESS_ARGUMENTS else value
+
+    # One thread per core, so that events on the same core stack up in one track
+    trace_event = {
+        "name": name,
+        "cat": category,
+        "pid": 0,
+        "tid": core,
+        "ts": (timestamp - base) * 1e6 / frequency,
+        "args": arguments,
+    }
+
+    if duration > 0:
+        trace_event["ph"] = "X"
+        trace_event["dur"] = duration * 1e6 / frequency
+    else:
+        trace_event["ph"] = "i"
+        trace_event["s"] = "t"
+
+    return trace_event
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("input", help="binary /dev/trace contents, or a debug port log")
+    parser.add_argument("output", nargs="?", help="JSON file to write, stdout by default")
+    parser.add_argument("--tsc-frequency", type=int, default=0,
+                        help="TSC ticks per second, required for binary input")
+    arguments = parser.parse_args()
+
+    data = open(arguments.input, "rb").read()
+    frequency = arguments.tsc_frequency
+
+    if b"trace-tsc " in data or data.startswith(b"trace "):
+        records, frequency = read_text(data.decode("utf-8", "replace").splitlines(), frequency)
+    else:
+        records = list(read_binary(data))
+
+    if frequency == 0:
+        sys.exit("The TSC frequency is unknown, pass --tsc-frequency")
+
+    records.sort(key=lambda record: record[0])
+    base = records[0][0] if records else 0
+
+    metadata = [{"name": "thread_name", "ph": "M", "pid": 0, "tid": core, "args": {"name": "Core %d" % core}}
+                for core in sorted({record[3] for record in records})]
+    events = [to_event(record, frequency, base) for record in records]
+
+    output = open(arguments.output, "w") if arguments.output else sys.stdout
+    json.dump({"traceEvents": metadata + events, "displayTimeUnit": "ns"}, output)
+
+
+if __name__ == "__main__":
+    main()